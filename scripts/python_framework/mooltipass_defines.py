@@ -22,6 +22,10 @@ LOGIN_INDEX             = 37
 
 # Sizes
 NODE_SIZE					= 132
+PARENT_NODE_SIZE			= 264
+CHILD_NODE_SIZE				= 528
+HID_MAX_PAYLOAD_SIZE		= 548
+NODES_BATCH_MAX_NB_NODES	= 16
 DEVICE_PASSWORD_SIZE		= 62
 MINI_DEVICE_PASSWORD_SIZE	= 16
 UID_REQUEST_KEY_SIZE		= 16
@@ -37,6 +41,12 @@ CMD_HID_NACK				= 0x00
 CMD_PING                	= 0x0001
 CMD_ID_RETRY				= 0x0002
 CMD_GET_DEVICE_STATUS		= 0x0011
+CMD_START_MMM				= 0x0009
+CMD_GET_START_PARENTS		= 0x0100
+CMD_END_MMM					= 0x0101
+CMD_SET_START_PARENTS		= 0x0107
+CMD_READ_NODES				= 0x0111
+CMD_WRITE_NODES				= 0x0112
 
 # New Debug Command IDs
 CMD_DBG_MESSAGE					= 0x8000
@@ -55,6 +65,11 @@ HID_CMD_ID_SET_OLED_PARAMS      = 0x800C
 HID_CMD_ID_GET_BATTERY_STATUS   = 0x800D
 HID_CMD_ID_FLASH_AUX_AND_MAIN   = 0x800E
 HID_CMD_ID_GET_PLAT_TIME        = 0x800F
+HID_CMD_ID_GET_FLASH_STATS      = 0x8010
+HID_CMD_ID_DATAFLASH_STREAM_START = 0x8011
+HID_CMD_ID_DATAFLASH_STREAM_WRITE = 0x8012
+HID_CMD_ID_DATAFLASH_STREAM_SYNC  = 0x8013
+HID_CMD_ID_DATAFLASH_SECTOR_CRCS  = 0x8014
 
 # OLD Command IDs
 CMD_EXPORT_FLASH_START  = 0x8A
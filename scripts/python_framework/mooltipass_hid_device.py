@@ -9,7 +9,9 @@ from array import array
 from PIL import Image
 import struct
 import random
+import json
 import glob
+import zlib
 import math
 import os
 
@@ -236,6 +238,127 @@ class mooltipass_hid_device:
 		print("Sending done!")
 		
 	
+	# Ask the device for the next address it expects in a streamed upload, None on timeout
+	def syncDataflashStream(self):
+		self.device.sendHidMessage(self.getPacketForCommand(HID_CMD_ID_DATAFLASH_STREAM_SYNC, None))
+		while True:
+			answer = self.device.receiveHidMessage(False)
+			if answer is None:
+				return None
+			# Drop cumulative acks sent before our sync request
+			if answer["cmd"] == HID_CMD_ID_DATAFLASH_STREAM_SYNC:
+				return struct.unpack('<I', answer["data"][0:4])[0]
+		
+	# Stream data to the dataflash, with up to window_chunks 256B chunks in flight, acked every ack_interval chunks
+	def streamToDataflash(self, start_address, data, erase_sectors, window_chunks=16, ack_interval=8):
+		end_address = start_address + len(data)
+		
+		# Setup stream
+		answer = self.device.sendHidMessageWaitForAck(self.getPacketForCommand(HID_CMD_ID_DATAFLASH_STREAM_START, array('B', struct.pack('<IHH', start_address, ack_interval, erase_sectors))))
+		if answer["data"][0] != CMD_HID_ACK:
+			print("Device refused streamed upload")
+			return False
+		
+		# Addresses of the next chunk to send & of the first byte not acknowledged yet
+		send_address = start_address
+		acked_address = start_address
+		while True:
+			# Fill the window
+			while send_address < end_address and send_address - acked_address < window_chunks*256:
+				chunk = data[send_address-start_address:send_address-start_address+256]
+				self.device.sendHidMessage(self.getPacketForCommand(HID_CMD_ID_DATAFLASH_STREAM_WRITE, array('B', struct.pack('<I', send_address) + chunk)))
+				send_address += len(chunk)
+				
+			# Everything sent: make sure it all arrived
+			if send_address >= end_address:
+				next_address = self.syncDataflashStream()
+				if next_address == end_address:
+					return True
+				elif next_address is not None:
+					send_address = acked_address = next_address
+				continue
+			
+			# Wait for a cumulative ack, sync on timeout (lost chunk or ack)
+			answer = self.device.receiveHidMessage(False)
+			if answer is None or answer["cmd"] != HID_CMD_ID_DATAFLASH_STREAM_WRITE:
+				next_address = self.syncDataflashStream()
+				if next_address is not None:
+					send_address = acked_address = next_address
+			elif answer["data"][4] != 0:
+				acked_address = max(acked_address, struct.unpack('<I', answer["data"][0:4])[0])
+			else:
+				# Device saw an out of sequence chunk: resume from where it is
+				send_address = acked_address = struct.unpack('<I', answer["data"][0:4])[0]
+		
+	# Streamed bundle upload, delta_upload only sends the 4kB sectors whose crc32 differ from the device ones
+	def uploadDebugBundleStreamed(self, filename, delta_upload):
+		# Check for file
+		if not isfile(filename):
+			print("File \"" + filename + "\" does not exist")
+			return
+			
+		# Read file
+		bundlefile = open(filename, 'rb')
+		bundle_data = bundlefile.read()
+		bundlefile.close()
+		start_time = time.time()
+		ack_flag_in_comms = self.device.ack_flag_in_comms
+		self.device.ack_flag_in_comms = False
+		self.device.setReadTimeout(1000)
+		
+		if delta_upload:
+			# Pad to complete sectors, as erased flash would read
+			nb_sectors = int((len(bundle_data) + 4095) / 4096)
+			bundle_data += b'\xff' * (nb_sectors*4096 - len(bundle_data))
+			
+			# Fetch the device sector crcs
+			print("Fetching device sector crcs...")
+			device_crcs = []
+			while len(device_crcs) < nb_sectors:
+				nb_crcs = min(64, nb_sectors - len(device_crcs))
+				answer = self.device.sendHidMessageWaitForAck(self.getPacketForCommand(HID_CMD_ID_DATAFLASH_SECTOR_CRCS, array('B', struct.pack('<IH', len(device_crcs)*4096, nb_crcs))))
+				device_crcs.extend(struct.unpack('<' + 'I'*nb_crcs, answer["data"][0:nb_crcs*4]))
+				
+			# List runs of changed sectors
+			runs = []
+			for i in range(0, nb_sectors):
+				if zlib.crc32(bundle_data[i*4096:(i+1)*4096]) & 0xFFFFFFFF != device_crcs[i]:
+					if len(runs) > 0 and runs[-1][1] == i:
+						runs[-1][1] = i + 1
+					else:
+						runs.append([i, i + 1])
+			print(str(sum(run[1] - run[0] for run in runs)) + " out of " + str(nb_sectors) + " sectors changed")
+			if len(runs) == 0:
+				self.device.ack_flag_in_comms = ack_flag_in_comms
+				self.device.setReadTimeout(USB_READ_TIMEOUT)
+				return
+				
+			# Send changed runs, erasing sectors as we go
+			for run in runs:
+				if not self.streamToDataflash(run[0]*4096, bundle_data[run[0]*4096:run[1]*4096], 1):
+					break
+		else:
+			# Erase the complete dataflash
+			print("Sending erase dataflash command..")
+			self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_DBG_ERASE_DATA_FLASH, None))
+			print("Waiting for erase done...")
+			while True:
+				time.sleep(.1)
+				if self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_DBG_IS_DATA_FLASH_READY, None))["data"][0] == CMD_HID_ACK:
+					break;
+			print("Erase done in " + str(int((time.time()-start_time)*1000)) + "ms")
+			
+			# Send everything
+			print("Streaming bundle data...")
+			self.streamToDataflash(0, bundle_data, 0)
+		
+		# Let the device know to reindex bundle
+		print("Letting the device know to reindex bundle...")
+		self.device.setReadTimeout(USB_READ_TIMEOUT)
+		self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_DBG_REINDEX_BUNDLE, None))
+		self.device.ack_flag_in_comms = ack_flag_in_comms
+		print("Sending done in " + str(int((time.time()-start_time)*1000)) + "ms")
+		
 	# Reboot to bootloader, no answer from device.
 	def rebootToBootloader(self):
 		self.device.sendHidMessage(self.getPacketForCommand(CMD_DBG_REBOOT_TO_BOOTLOADER, None))	
@@ -320,6 +443,157 @@ class mooltipass_hid_device:
 		print("Main MCU major:", struct.unpack('H', packet["data"][64:66])[0])
 		print("Main MCU minor:", struct.unpack('H', packet["data"][66:68])[0])
 
+	def getFlashStats(self, reset):
+		# Ask for the counters, optionally resetting them
+		packet = self.device.sendHidMessageWaitForAck(self.getPacketForCommand(HID_CMD_ID_GET_FLASH_STATS, [1 if reset else 0]))
+		if packet["cmd"] != HID_CMD_ID_GET_FLASH_STATS:
+			print("Flash stats not available")
+			return
+		
+		# One 5 x uint32 record per category
+		print("")
+		print("category      reads   bytes read   writes   bytes written     time (ms)")
+		for i, category in enumerate(["nodemgmt", "gui", "fonts", "bitmaps", "settings"]):
+			nb_reads, nb_bytes_read, nb_writes, nb_bytes_written, time_us = struct.unpack('IIIII', packet["data"][i*20:i*20+20])
+			print("{:<10} {:>8} {:>12} {:>8} {:>15} {:>13.1f}".format(category, nb_reads, nb_bytes_read, nb_writes, nb_bytes_written, time_us/1000))
+
+
+	# Read several nodes in one message, following the next node pointers or from an address list
+	def readNodesBulk(self, addresses, follow_next_pointers):
+		payload = array('B')
+		payload.extend(struct.pack('H', 1 if follow_next_pointers else 0))
+		for address in addresses:
+			payload.extend(struct.pack('H', address))
+		packet = self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_READ_NODES, payload))
+		
+		# Nack
+		if packet["cmd"] != CMD_READ_NODES or packet["len"] < 4:
+			return None
+		
+		# Split answer into nodes, sent without their trailing zeros: node type is in the 2 MSBs of the flags, child nodes are twice as big
+		nb_nodes_processed = struct.unpack('H', packet["data"][0:2])[0]
+		failed_nodes_bitmask = struct.unpack('H', packet["data"][2:4])[0]
+		nodes = []
+		offset = 4
+		for i in range(0, nb_nodes_processed):
+			if failed_nodes_bitmask & (1 << i):
+				nodes.append(None)
+				continue
+			node_data_length = struct.unpack('H', packet["data"][offset:offset+2])[0]
+			node = array('B', packet["data"][offset+2:offset+2+node_data_length])
+			flags = struct.unpack('H', node[0:2])[0] if node_data_length >= 2 else 0
+			if (flags & 0x2000) == 0 and ((flags >> 14) == 1 or (flags >> 14) == 3):
+				node_size = CHILD_NODE_SIZE
+			else:
+				node_size = PARENT_NODE_SIZE
+			node.extend([0] * (node_size - node_data_length))
+			nodes.append(node)
+			offset += 2 + node_data_length
+		return nodes
+		
+	# Node data without its trailing zeros, length kept even so that the next node stays aligned
+	def getNodeDataWithoutTrailingZeros(self, node):
+		node_data = bytes(node).rstrip(b'\x00')
+		return node_data + b'\x00' * (len(node_data) % 2)
+		
+	# Write several nodes in one message, returns the bitmask of nodes that couldn't be written
+	def writeNodesBulk(self, nodes):
+		payload = array('B')
+		for address, node in nodes:
+			# Sent without trailing zeros, the device pads the node back to its size
+			node_data = self.getNodeDataWithoutTrailingZeros(node)
+			payload.extend(struct.pack('HHH', address, len(node), len(node_data)))
+			payload.extend(node_data)
+		packet = self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_WRITE_NODES, payload))
+		
+		# Nack
+		if packet["cmd"] != CMD_WRITE_NODES or packet["len"] < 4:
+			return None
+		return struct.unpack('H', packet["data"][2:4])[0]
+		
+	# Follow a linked list of nodes, storing them in the nodes dictionary
+	def readNodeListBulk(self, start_address, nodes):
+		next_address = start_address
+		while next_address != 0:
+			read_nodes = self.readNodesBulk([next_address], True)
+			if read_nodes is None or len(read_nodes) == 0 or read_nodes[-1] is None:
+				print("Couldn't read node at address " + hex(next_address))
+				return False
+			for node in read_nodes:
+				nodes[next_address] = node
+				# Data child nodes store their next address right after the flags
+				if len(node) == CHILD_NODE_SIZE and (struct.unpack('H', node[0:2])[0] >> 14) == 3:
+					next_address = struct.unpack('H', node[2:4])[0]
+				else:
+					next_address = struct.unpack('H', node[4:6])[0]
+		return True
+		
+	# Backup the current user database to a json file, in memory management mode
+	def backupDatabaseBulk(self, filename):
+		if self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_START_MMM, None))["data"][0] != CMD_HID_ACK:
+			print("Couldn't enter memory management mode")
+			return
+		
+		# Get start parents
+		packet = self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_GET_START_PARENTS, None))
+		start_parents = [struct.unpack('H', packet["data"][i:i+2])[0] for i in range(0, packet["len"], 2)]
+		
+		# Read all parents, then the children of each parent
+		parent_nodes = {}
+		child_nodes = {}
+		for start_parent in start_parents:
+			self.readNodeListBulk(start_parent, parent_nodes)
+		for address in list(parent_nodes.keys()):
+			self.readNodeListBulk(struct.unpack('H', parent_nodes[address][6:8])[0], child_nodes)
+		
+		# Leave MMM
+		self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_END_MMM, None))
+		
+		# Store backup
+		backup = {"start_parents": start_parents, "nodes": {}}
+		for address, node in list(parent_nodes.items()) + list(child_nodes.items()):
+			backup["nodes"][str(address)] = ''.join('{:02x}'.format(x) for x in node)
+		with open(filename, "w") as f:
+			json.dump(backup, f)
+		print("Backed up " + str(len(parent_nodes)) + " parent nodes and " + str(len(child_nodes)) + " child nodes")
+		
+	# Restore a database backup made by backupDatabaseBulk, in memory management mode
+	def restoreDatabaseBulk(self, filename):
+		with open(filename, "r") as f:
+			backup = json.load(f)
+		
+		if self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_START_MMM, None))["data"][0] != CMD_HID_ACK:
+			print("Couldn't enter memory management mode")
+			return
+		
+		# Pack as many nodes as possible in each message
+		batch = []
+		batch_size = 0
+		nb_failed_nodes = 0
+		node_list = [(int(address), array('B', bytearray.fromhex(node))) for address, node in backup["nodes"].items()]
+		for address, node in node_list + [(None, None)]:
+			if address is None or batch_size + 6 + len(self.getNodeDataWithoutTrailingZeros(node)) > HID_MAX_PAYLOAD_SIZE or len(batch) == NODES_BATCH_MAX_NB_NODES:
+				if len(batch) > 0:
+					failed_nodes_bitmask = self.writeNodesBulk(batch)
+					if failed_nodes_bitmask is None:
+						nb_failed_nodes += len(batch)
+					else:
+						nb_failed_nodes += bin(failed_nodes_bitmask).count("1")
+				batch = []
+				batch_size = 0
+			if address is not None:
+				batch.append((address, node))
+				batch_size += 6 + len(self.getNodeDataWithoutTrailingZeros(node))
+		
+		# Restore start parents
+		payload = array('B')
+		for start_parent in backup["start_parents"]:
+			payload.extend(struct.pack('H', start_parent))
+		self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_SET_START_PARENTS, payload))
+		
+		# Leave MMM
+		self.device.sendHidMessageWaitForAck(self.getPacketForCommand(CMD_END_MMM, None))
+		print("Restored " + str(len(node_list) - nb_failed_nodes) + " nodes, " + str(nb_failed_nodes) + " failed")
 		
 	# Get accelerometer data
 	def getAccData(self):
@@ -666,6 +940,16 @@ class mooltipass_hid_device:
 				else:
 					bundlefile = open(file_list[int(picked_file)], 'rb')
 		
+		# Mini BLE bundles: check the crc32 the device will check after upload (same parameters as zlib and EMU/emu_crc32.c)
+		bundle_data = bundlefile.read()
+		bundlefile.seek(0)
+		if len(bundle_data) >= 12 and struct.unpack('<I', bundle_data[0:4])[0] == 0x12345678:
+			total_size, header_crc32 = struct.unpack('<II', bundle_data[4:12])
+			if zlib.crc32(bundle_data[12:total_size]) & 0xFFFFFFFF != header_crc32:
+				print("Bundle crc32 mismatch, not uploading")
+				bundlefile.close()
+				return False
+		
 		# Ask for Mooltipass password
 		if password is None:
 			mp_password = raw_input("Enter Mooltipass Password, press enter if None: ")
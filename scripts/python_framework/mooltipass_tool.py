@@ -63,6 +63,14 @@ def main():
 			else:
 				print("Please specify bundle filename")
 		
+		elif sys.argv[1] == "uploadDebugBundleStreamed":
+			# mooltipass_tool.py uploadDebugBundleStreamed filename [delta]
+			if len(sys.argv) > 2:
+				filename = sys.argv[2]
+				mooltipass_device.uploadDebugBundleStreamed(filename, len(sys.argv) > 3 and sys.argv[3] == "delta")
+			else:
+				print("Please specify bundle filename")
+		
 		elif sys.argv[1] == "rebootToBootloader":
 			mooltipass_device.rebootToBootloader()
 			
@@ -72,12 +80,29 @@ def main():
 		elif sys.argv[1] == "platInfo":
 			mooltipass_device.getPlatInfo()
 			
+		elif sys.argv[1] == "flashStats":
+			mooltipass_device.getFlashStats(len(sys.argv) > 2 and sys.argv[2] == "reset")
+			
 		elif sys.argv[1] == "accGet":
 			mooltipass_device.getAccData()
 			
 		elif sys.argv[1] == "timediff":
 			mooltipass_device.timeDiff()
 			
+		elif sys.argv[1] == "backupDb":
+			# mooltipass_tool.py backupDb filename
+			if len(sys.argv) > 2:
+				mooltipass_device.backupDatabaseBulk(sys.argv[2])
+			else:
+				print("Please specify backup filename")
+			
+		elif sys.argv[1] == "restoreDb":
+			# mooltipass_tool.py restoreDb filename
+			if len(sys.argv) > 2:
+				mooltipass_device.restoreDatabaseBulk(sys.argv[2])
+			else:
+				print("Please specify backup filename")
+			
 		elif sys.argv[1] == "debugListen":
 			while True:
 				try:
@@ -0,0 +1,215 @@
+/*!  \file     comms_hid_framing.c
+*    \brief    Moolticute HID packets <-> messages, shared with the emulator
+*    \note     Packet format: byte0 is payload length (6 bits), ack flag & flip bit, byte1 is packet id (4 MSBs) & total number of packets - 1 (4 LSBs).
+*              The flip bit toggles for each new message, a 0xFF 0xFF packet resets it to 0 for the next message.
+*              A message with the previous message flip bit is either sent again by the host, or follows a message we completely lost:
+*              it is only dropped if it also has the same contents as the previous message.
+*              No dependency on the platform so that it can be linked by the aux MCU firmware, the emulator and host benchmarks.
+*/
+#include <string.h>
+#include "comms_hid_framing.h"
+
+
+/*! \fn     comms_hid_framing_reset_reassembly(hid_framing_reassembly_t* reassembly)
+*   \brief  Reset reassembly state: discard message being received, next message should have its flip bit cleared
+*   \param  reassembly  Reassembly state
+*/
+void comms_hid_framing_reset_reassembly(hid_framing_reassembly_t* reassembly)
+{
+    reassembly->fill_index = 0;
+    reassembly->message_length = 0;
+    reassembly->last_message_length = 0;
+    reassembly->last_message_hash = 0;
+    reassembly->expected_packet_id = 0;
+    reassembly->total_packets = 0;
+    reassembly->message_flip_bit = 0;
+    reassembly->next_message_flip_bit = 0;
+    reassembly->message_in_progress = FALSE;
+    reassembly->possible_duplicate = FALSE;
+    reassembly->ack_requested = FALSE;
+}
+
+/*! \fn     comms_hid_framing_init_reassembly(hid_framing_reassembly_t* reassembly, uint8_t* message_buffer, uint16_t message_buffer_length)
+*   \brief  Initialize a reassembly state
+*   \param  reassembly              Reassembly state
+*   \param  message_buffer          Buffer in which messages are reassembled
+*   \param  message_buffer_length   Buffer length
+*/
+void comms_hid_framing_init_reassembly(hid_framing_reassembly_t* reassembly, uint8_t* message_buffer, uint16_t message_buffer_length)
+{
+    reassembly->message_buffer = message_buffer;
+    reassembly->message_buffer_length = message_buffer_length;
+    comms_hid_framing_reset_reassembly(reassembly);
+}
+
+/*! \fn     comms_hid_framing_drop_message(hid_framing_reassembly_t* reassembly, uint8_t flip_bit)
+*   \brief  Drop the message being received after an invalid packet
+*   \param  reassembly  Reassembly state
+*   \param  flip_bit    Flip bit of the invalid packet
+*   \note   The message the packet belongs to is considered consumed, so that the next one (other flip bit) is accepted
+*/
+static void comms_hid_framing_drop_message(hid_framing_reassembly_t* reassembly, uint8_t flip_bit)
+{
+    reassembly->fill_index = 0;
+    reassembly->message_in_progress = FALSE;
+    reassembly->next_message_flip_bit = flip_bit ^ 0x01;
+}
+
+/*! \fn     comms_hid_framing_hash_message(uint8_t const* message, uint16_t message_length)
+*   \brief  Hash a message to detect messages sent twice (FNV-1a)
+*   \param  message         The message
+*   \param  message_length  Message length
+*   \return The hash
+*/
+static uint32_t comms_hid_framing_hash_message(uint8_t const* message, uint16_t message_length)
+{
+    uint32_t hash = 0x811C9DC5;
+    
+    for (uint16_t i = 0; i < message_length; i++)
+    {
+        hash = (hash ^ message[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+/*! \fn     comms_hid_framing_process_packet(hid_framing_reassembly_t* reassembly, uint8_t const* packet, uint16_t packet_length)
+*   \brief  Process a received HID packet
+*   \param  reassembly      Reassembly state
+*   \param  packet          Received packet
+*   \param  packet_length   Number of received bytes
+*   \return HID_FRAMING_MESSAGE_COMPLETE when message_length bytes are ready in the message buffer
+*/
+hid_framing_ret_te comms_hid_framing_process_packet(hid_framing_reassembly_t* reassembly, uint8_t const* packet, uint16_t packet_length)
+{
+    /* Not even a header */
+    if (packet_length < 2)
+    {
+        return HID_FRAMING_PACKET_DROPPED;
+    }
+    
+    /* Special case: first two bytes set to 0xFF 0xFF, reset flip bit */
+    if ((packet[0] == 0xFF) && (packet[1] == 0xFF))
+    {
+        comms_hid_framing_reset_reassembly(reassembly);
+        return HID_FRAMING_FLIP_BIT_RESET;
+    }
+    
+    /* Decode header */
+    uint8_t payload_length = packet[0] & HID_FRAMING_BYTE0_PAYLOAD_LEN_MASK;
+    uint8_t flip_bit = ((packet[0] & HID_FRAMING_BYTE0_FLIP_BIT_MASK) != 0)? 0x01 : 0x00;
+    uint8_t total_packets = packet[1] & 0x0F;
+    uint8_t packet_id = packet[1] >> 4;
+    
+    /* Malformed packet */
+    if ((payload_length > HID_FRAMING_PACKET_PAYLOAD_LENGTH) || (payload_length + 2U > packet_length) || (packet_id > total_packets))
+    {
+        comms_hid_framing_drop_message(reassembly, flip_bit);
+        return HID_FRAMING_PACKET_DROPPED;
+    }
+    
+    if (packet_id == 0)
+    {
+        /* New message, discards a possible incomplete one. Same flip bit as the previous message: checked once complete */
+        memset(reassembly->message_buffer, 0, reassembly->message_buffer_length);
+        reassembly->possible_duplicate = (flip_bit != reassembly->next_message_flip_bit)? TRUE : FALSE;
+        reassembly->message_in_progress = TRUE;
+        reassembly->message_flip_bit = flip_bit;
+        reassembly->total_packets = total_packets;
+        reassembly->expected_packet_id = 0;
+        reassembly->fill_index = 0;
+    }
+    else if ((reassembly->message_in_progress == FALSE) || (flip_bit != reassembly->message_flip_bit) || (packet_id != reassembly->expected_packet_id) || (total_packets != reassembly->total_packets))
+    {
+        /* Lost or unexpected packet */
+        comms_hid_framing_drop_message(reassembly, flip_bit);
+        return HID_FRAMING_PACKET_DROPPED;
+    }
+    
+    /* Check for overflow tentative */
+    if (reassembly->fill_index + payload_length > reassembly->message_buffer_length)
+    {
+        comms_hid_framing_drop_message(reassembly, flip_bit);
+        return HID_FRAMING_PACKET_DROPPED;
+    }
+    
+    /* Store payload */
+    memcpy(&reassembly->message_buffer[reassembly->fill_index], &packet[2], payload_length);
+    reassembly->fill_index += payload_length;
+    reassembly->expected_packet_id++;
+    
+    /* Check for last packet */
+    if (packet_id == total_packets)
+    {
+        uint32_t message_hash = comms_hid_framing_hash_message(reassembly->message_buffer, reassembly->fill_index);
+        
+        /* Message sent twice by the host */
+        if ((reassembly->possible_duplicate != FALSE) && (reassembly->fill_index == reassembly->last_message_length) && (message_hash == reassembly->last_message_hash))
+        {
+            comms_hid_framing_drop_message(reassembly, flip_bit);
+            return HID_FRAMING_PACKET_DROPPED;
+        }
+        
+        reassembly->ack_requested = ((packet[0] & HID_FRAMING_BYTE0_ACK_FLAG_MASK) != 0)? TRUE : FALSE;
+        reassembly->message_length = reassembly->fill_index;
+        reassembly->last_message_length = reassembly->fill_index;
+        reassembly->last_message_hash = message_hash;
+        reassembly->message_in_progress = FALSE;
+        reassembly->next_message_flip_bit = flip_bit ^ 0x01;
+        reassembly->fill_index = 0;
+        return HID_FRAMING_MESSAGE_COMPLETE;
+    }
+    
+    return HID_FRAMING_PACKET_STORED;
+}
+
+/*! \fn     comms_hid_framing_start_fragmentation(hid_framing_fragmentation_t* fragmentation, uint8_t const* message, uint16_t message_length)
+*   \brief  Start splitting a message into HID packets
+*   \param  fragmentation   Fragmentation state
+*   \param  message         Message to send, should stay valid until all packets are generated
+*   \param  message_length  Message length
+*/
+void comms_hid_framing_start_fragmentation(hid_framing_fragmentation_t* fragmentation, uint8_t const* message, uint16_t message_length)
+{
+    fragmentation->message = message;
+    fragmentation->message_length = message_length;
+    fragmentation->message_offset = 0;
+    fragmentation->packet_id = 0;
+    fragmentation->total_packets = 0;
+    if (message_length > HID_FRAMING_PACKET_PAYLOAD_LENGTH)
+    {
+        fragmentation->total_packets = (uint8_t)((message_length + HID_FRAMING_PACKET_PAYLOAD_LENGTH - 1) / HID_FRAMING_PACKET_PAYLOAD_LENGTH - 1);
+    }
+}
+
+/*! \fn     comms_hid_framing_get_next_packet(hid_framing_fragmentation_t* fragmentation, uint8_t* packet)
+*   \brief  Generate the next HID packet for a message
+*   \param  fragmentation   Fragmentation state
+*   \param  packet          HID_FRAMING_PACKET_LENGTH bytes buffer, 0 padded
+*   \return Number of meaningful bytes in the packet, 0 once the complete message was sent
+*   \note   We do not care about the flip bit
+*/
+uint16_t comms_hid_framing_get_next_packet(hid_framing_fragmentation_t* fragmentation, uint8_t* packet)
+{
+    uint16_t payload_length = fragmentation->message_length - fragmentation->message_offset;
+    
+    /* Done? */
+    if (fragmentation->message_offset >= fragmentation->message_length)
+    {
+        return 0;
+    }
+    
+    /* Fill packet */
+    if (payload_length > HID_FRAMING_PACKET_PAYLOAD_LENGTH)
+    {
+        payload_length = HID_FRAMING_PACKET_PAYLOAD_LENGTH;
+    }
+    packet[0] = (uint8_t)payload_length;
+    packet[1] = (uint8_t)((fragmentation->packet_id << 4) | fragmentation->total_packets);
+    memcpy(&packet[2], &fragmentation->message[fragmentation->message_offset], payload_length);
+    memset(&packet[2 + payload_length], 0, HID_FRAMING_PACKET_PAYLOAD_LENGTH - payload_length);
+    
+    /* Update state */
+    fragmentation->message_offset += payload_length;
+    fragmentation->packet_id++;
+    return payload_length + 2;
+}
@@ -0,0 +1,58 @@
+/*!  \file     comms_hid_framing.h
+*    \brief    Moolticute HID packets <-> messages, shared with the emulator
+*/
+
+
+#ifndef COMMS_HID_FRAMING_H_
+#define COMMS_HID_FRAMING_H_
+
+#include <stdint.h>
+#include "defines.h"
+
+/* Defines */
+#define HID_FRAMING_PACKET_LENGTH           64
+#define HID_FRAMING_PACKET_PAYLOAD_LENGTH   62
+#define HID_FRAMING_MAX_NB_PACKETS          16
+#define HID_FRAMING_BYTE0_PAYLOAD_LEN_MASK  0x3F
+#define HID_FRAMING_BYTE0_ACK_FLAG_MASK     0x40
+#define HID_FRAMING_BYTE0_FLIP_BIT_MASK     0x80
+
+/* Enums */
+typedef enum    {HID_FRAMING_PACKET_STORED = 0, HID_FRAMING_MESSAGE_COMPLETE, HID_FRAMING_FLIP_BIT_RESET, HID_FRAMING_PACKET_DROPPED} hid_framing_ret_te;
+
+/* Typedefs */
+typedef struct
+{
+    uint8_t* message_buffer;
+    uint16_t message_buffer_length;
+    uint16_t fill_index;
+    uint16_t message_length;
+    uint16_t last_message_length;
+    uint32_t last_message_hash;
+    uint8_t expected_packet_id;
+    uint8_t total_packets;
+    uint8_t message_flip_bit;
+    uint8_t next_message_flip_bit;
+    BOOL message_in_progress;
+    BOOL possible_duplicate;
+    BOOL ack_requested;
+} hid_framing_reassembly_t;
+
+typedef struct
+{
+    uint8_t const* message;
+    uint16_t message_length;
+    uint16_t message_offset;
+    uint8_t total_packets;
+    uint8_t packet_id;
+} hid_framing_fragmentation_t;
+
+/* Prototypes */
+hid_framing_ret_te comms_hid_framing_process_packet(hid_framing_reassembly_t* reassembly, uint8_t const* packet, uint16_t packet_length);
+void comms_hid_framing_start_fragmentation(hid_framing_fragmentation_t* fragmentation, uint8_t const* message, uint16_t message_length);
+void comms_hid_framing_init_reassembly(hid_framing_reassembly_t* reassembly, uint8_t* message_buffer, uint16_t message_buffer_length);
+uint16_t comms_hid_framing_get_next_packet(hid_framing_fragmentation_t* fragmentation, uint8_t* packet);
+void comms_hid_framing_reset_reassembly(hid_framing_reassembly_t* reassembly);
+
+
+#endif /* COMMS_HID_FRAMING_H_ */
@@ -32,8 +32,10 @@
 aux_mcu_message_t main_mcu_send_message;
 /* Temporary message, used when dealing with message shorter than max size */
 volatile aux_mcu_message_t comms_main_mcu_temp_message;
-/* Message dedicated to sending answers to non USB & non BLE messages to main MCU */
-volatile aux_mcu_message_t comms_main_mcu_message_for_main_replies;
+/* Pool of messages to be sent to main MCU: owned by their producer while being filled, then by the DMA until sent */
+aux_mcu_message_t comms_main_mcu_tx_slots[COMMS_MAIN_MCU_NB_TX_SLOTS];
+/* Set when a pool message is owned by its producer */
+BOOL comms_main_mcu_tx_slot_owned[COMMS_MAIN_MCU_NB_TX_SLOTS];
 /* Flag set if we have treated a message by only looking at its first bytes */
 volatile BOOL comms_main_mcu_usb_msg_answered_using_first_bytes = FALSE;
 volatile BOOL comms_main_mcu_ble_msg_answered_using_first_bytes = FALSE;
@@ -69,6 +71,7 @@ aux_mcu_message_t* comms_main_mcu_get_temp_rx_message_object_pt(void)
 *   \brief  Get an empty message ready to be sent
 *   \param  message_pt_pt           Pointer to where to store message pointer
 *   \param  message_type            Message type
+*   \note   Single buffer, left untouched by other messages so that it can be sent again when the main MCU asks for a retry
 */
 void comms_main_mcu_get_empty_packet_ready_to_be_sent(aux_mcu_message_t** message_pt_pt, uint16_t message_type)
 {
@@ -88,32 +91,60 @@ void comms_main_mcu_get_empty_packet_ready_to_be_sent(aux_mcu_message_t** messag
     *message_pt_pt = temp_tx_message_pt;
 }
 
-/*! \fn     comms_main_mcu_send_simple_event(uint16_t event_id)
-*   \brief  Send a simple event to main MCU
-*   \param  event_id    The event ID
+/*! \fn     comms_main_mcu_get_empty_tx_slot(aux_mcu_message_t** message_pt_pt, uint16_t message_type)
+*   \brief  Take ownership of an empty message from the tx pool
+*   \param  message_pt_pt           Pointer to where to store message pointer
+*   \param  message_type            Message type
+*   \note   Ownership goes back to the pool when the message is given to comms_main_mcu_send_message or released
+*   \note   Only waits for the DMA when the only non owned message is being sent
 */
-void comms_main_mcu_send_simple_event(uint16_t event_id)
+void comms_main_mcu_get_empty_tx_slot(aux_mcu_message_t** message_pt_pt, uint16_t message_type)
 {
-    dma_wait_for_main_mcu_packet_sent();
-    main_mcu_send_message.aux_mcu_event_message.event_id = event_id;
-    main_mcu_send_message.message_type = AUX_MCU_MSG_TYPE_AUX_MCU_EVENT;
-    main_mcu_send_message.payload_length1 = sizeof(main_mcu_send_message.aux_mcu_event_message.event_id);
-    comms_main_mcu_send_message((void*)&main_mcu_send_message, (uint16_t)sizeof(aux_mcu_message_t));
+    while (TRUE)
+    {
+        for (uint16_t i = 0; i < COMMS_MAIN_MCU_NB_TX_SLOTS; i++)
+        {
+            if ((comms_main_mcu_tx_slot_owned[i] == FALSE) && (dma_is_message_being_sent_to_main_mcu((void*)&comms_main_mcu_tx_slots[i]) == FALSE))
+            {
+                comms_main_mcu_tx_slot_owned[i] = TRUE;
+                memset((void*)&comms_main_mcu_tx_slots[i], 0, sizeof(comms_main_mcu_tx_slots[0]));
+                comms_main_mcu_tx_slots[i].message_type = message_type;
+                *message_pt_pt = &comms_main_mcu_tx_slots[i];
+                return;
+            }
+        }
+        
+        /* All non owned messages are being sent */
+        dma_wait_for_main_mcu_packet_sent();
+    }
 }
 
-/*! \fn     comms_main_mcu_send_simple_event_alt_buffer(uint16_t event_id, aux_mcu_message_t* buffer)
-*   \brief  Send a simple event to main MCU, specifying the buffer
+/*! \fn     comms_main_mcu_release_tx_slot(aux_mcu_message_t* message)
+*   \brief  Give back a message to the tx pool without sending it
+*   \param  message     The message, ignored if not part of the pool
+*/
+void comms_main_mcu_release_tx_slot(aux_mcu_message_t* message)
+{
+    for (uint16_t i = 0; i < COMMS_MAIN_MCU_NB_TX_SLOTS; i++)
+    {
+        if (message == &comms_main_mcu_tx_slots[i])
+        {
+            comms_main_mcu_tx_slot_owned[i] = FALSE;
+        }
+    }
+}
+
+/*! \fn     comms_main_mcu_send_simple_event(uint16_t event_id)
+*   \brief  Send a simple event to main MCU
 *   \param  event_id    The event ID
-*   \param  buffer      The buffer to use to send the event
 */
-void comms_main_mcu_send_simple_event_alt_buffer(uint16_t event_id, aux_mcu_message_t* buffer)
+void comms_main_mcu_send_simple_event(uint16_t event_id)
 {
-    dma_wait_for_main_mcu_packet_sent();
-    memset(buffer, 0, sizeof(*buffer));
-    buffer->aux_mcu_event_message.event_id = event_id;
-    buffer->message_type = AUX_MCU_MSG_TYPE_AUX_MCU_EVENT;
-    buffer->payload_length1 = sizeof(buffer->aux_mcu_event_message.event_id);
-    comms_main_mcu_send_message((void*)buffer, (uint16_t)sizeof(aux_mcu_message_t));
+    aux_mcu_message_t* temp_tx_message_pt;
+    comms_main_mcu_get_empty_tx_slot(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
+    temp_tx_message_pt->aux_mcu_event_message.event_id = event_id;
+    temp_tx_message_pt->payload_length1 = sizeof(temp_tx_message_pt->aux_mcu_event_message.event_id);
+    comms_main_mcu_send_message(temp_tx_message_pt, (uint16_t)sizeof(aux_mcu_message_t));
 }
 
 /*! \fn     comms_main_mcu_send_message(aux_mcu_message_t* message, uint16_t message_length)
@@ -121,6 +152,7 @@ void comms_main_mcu_send_simple_event_alt_buffer(uint16_t event_id, aux_mcu_mess
 *   \param  message         Pointer to the message to send
 *   \param  message_length  Message length
 *   \note   Transfer is done through DMA so data will be accessed after this function returns
+*   \note   A tx pool message is given back to the pool, it will be reused once sent
 */
 void comms_main_mcu_send_message(aux_mcu_message_t* message, uint16_t message_length)
 {
@@ -138,6 +170,9 @@ void comms_main_mcu_send_message(aux_mcu_message_t* message, uint16_t message_le
     
     /* The function below does wait for a previous transfer to finish and does check for no comms */
     dma_main_mcu_init_tx_transfer((void*)&AUXMCU_SERCOM->USART.DATA.reg, (void*)message, sizeof(aux_mcu_message_t));    
+    
+    /* Pool message: now owned by the DMA */
+    comms_main_mcu_release_tx_slot(message);
 }
 
 /*! \fn     comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message)
@@ -146,6 +181,8 @@ void comms_main_mcu_send_message(aux_mcu_message_t* message, uint16_t message_le
 */
 void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message)
 {
+    aux_mcu_message_t* reply_pt;
+    
     #ifdef MAIN_MCU_MSG_DBG_PRINT
     comms_usb_debug_printf("Received main MCU other message: %i, %i", message->message_type, message->payload_as_uint16[0]);
     #endif
@@ -169,74 +206,65 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
         NVIC_SystemReset();        
     }
     
-    /* If the message being sent to the main MCU is from the same buffer we're planning to use, wait for it to be sent */
-    if (dma_get_pointer_to_message_being_sent_to_main_mcu() == &comms_main_mcu_message_for_main_replies)
-    {
-        dma_wait_for_main_mcu_packet_sent();
-    }
-    
-    /* Clear message */
-    memset((void*)&comms_main_mcu_message_for_main_replies, 0x00, sizeof(comms_main_mcu_message_for_main_replies));
-    
     if (message->message_type == AUX_MCU_MSG_TYPE_PLAT_DETAILS)
     {
         /* Status request */
-        comms_main_mcu_message_for_main_replies.message_type = AUX_MCU_MSG_TYPE_PLAT_DETAILS;
-        comms_main_mcu_message_for_main_replies.payload_length1 = sizeof(aux_plat_details_message_t);
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_fw_ver_major = FW_MAJOR;
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_fw_ver_minor = FW_MINOR;
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_did_register = DSU->DID.reg;
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_uid_registers[0] = *(uint32_t*)0x0080A00C;
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_uid_registers[1] = *(uint32_t*)0x0080A040;
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_uid_registers[2] = *(uint32_t*)0x0080A044;
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_uid_registers[3] = *(uint32_t*)0x0080A048;
-        comms_main_mcu_message_for_main_replies.aux_details_message.aux_stack_low_watermark = main_check_stack_usage();
+        comms_main_mcu_get_empty_tx_slot(&reply_pt, AUX_MCU_MSG_TYPE_PLAT_DETAILS);
+        reply_pt->payload_length1 = sizeof(aux_plat_details_message_t);
+        reply_pt->aux_details_message.aux_fw_ver_major = FW_MAJOR;
+        reply_pt->aux_details_message.aux_fw_ver_minor = FW_MINOR;
+        reply_pt->aux_details_message.aux_did_register = DSU->DID.reg;
+        reply_pt->aux_details_message.aux_uid_registers[0] = *(uint32_t*)0x0080A00C;
+        reply_pt->aux_details_message.aux_uid_registers[1] = *(uint32_t*)0x0080A040;
+        reply_pt->aux_details_message.aux_uid_registers[2] = *(uint32_t*)0x0080A044;
+        reply_pt->aux_details_message.aux_uid_registers[3] = *(uint32_t*)0x0080A048;
+        reply_pt->aux_details_message.aux_stack_low_watermark = main_check_stack_usage();
         
         /* Check if BLE is enabled */
         if (logic_is_ble_enabled() != FALSE)
         {
             /* Blusdk lib version */
-            comms_main_mcu_message_for_main_replies.aux_details_message.blusdk_lib_maj = BLE_SDK_MAJOR_NO(BLE_SDK_VERSION);
-            comms_main_mcu_message_for_main_replies.aux_details_message.blusdk_lib_min = BLE_SDK_MINOR_NO(BLE_SDK_VERSION);
+            reply_pt->aux_details_message.blusdk_lib_maj = BLE_SDK_MAJOR_NO(BLE_SDK_VERSION);
+            reply_pt->aux_details_message.blusdk_lib_min = BLE_SDK_MINOR_NO(BLE_SDK_VERSION);
             
             /* Try to get fw version */
             uint32_t blusdk_fw_ver;
             if(at_ble_firmware_version_get(&blusdk_fw_ver) == AT_BLE_SUCCESS)
             {
-                comms_main_mcu_message_for_main_replies.aux_details_message.blusdk_fw_maj = BLE_SDK_MAJOR_NO(blusdk_fw_ver);
-                comms_main_mcu_message_for_main_replies.aux_details_message.blusdk_fw_min = BLE_SDK_MINOR_NO(blusdk_fw_ver);
-                comms_main_mcu_message_for_main_replies.aux_details_message.blusdk_fw_build = BLE_SDK_BUILD_NO(blusdk_fw_ver);
+                reply_pt->aux_details_message.blusdk_fw_maj = BLE_SDK_MAJOR_NO(blusdk_fw_ver);
+                reply_pt->aux_details_message.blusdk_fw_min = BLE_SDK_MINOR_NO(blusdk_fw_ver);
+                reply_pt->aux_details_message.blusdk_fw_build = BLE_SDK_BUILD_NO(blusdk_fw_ver);
                 
                 /* Getting RF version */
-                at_ble_rf_version_get((uint32_t*)&comms_main_mcu_message_for_main_replies.aux_details_message.atbtlc_rf_ver);
+                at_ble_rf_version_get((uint32_t*)&reply_pt->aux_details_message.atbtlc_rf_ver);
                 
                 /* ATBTLC1000 chip ID */
-                at_ble_chip_id_get((uint32_t*)&comms_main_mcu_message_for_main_replies.aux_details_message.atbtlc_chip_id);
+                at_ble_chip_id_get((uint32_t*)&reply_pt->aux_details_message.atbtlc_chip_id);
                 
                 /* ATBTLC address */
                 at_ble_addr_t atbtlc_address;
                 atbtlc_address.type = AT_BLE_ADDRESS_PUBLIC;
                 at_ble_addr_get(&atbtlc_address);
-                memcpy((void*)comms_main_mcu_message_for_main_replies.aux_details_message.atbtlc_address, (void*)atbtlc_address.addr, sizeof(atbtlc_address.addr));
+                memcpy((void*)reply_pt->aux_details_message.atbtlc_address, (void*)atbtlc_address.addr, sizeof(atbtlc_address.addr));
             }
         }
         
         /* Send message */
-        comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));
+        comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));
     }
     else if (message->message_type == AUX_MCU_MSG_TYPE_NIMH_CHARGE)
     {
         /* Return charging status */
-        comms_main_mcu_message_for_main_replies.message_type = AUX_MCU_MSG_TYPE_NIMH_CHARGE;
-        comms_main_mcu_message_for_main_replies.payload_length1 = sizeof(nimh_charge_message_t);
-        comms_main_mcu_message_for_main_replies.nimh_charge_message.charge_status = logic_battery_get_charging_status();
-        comms_main_mcu_message_for_main_replies.nimh_charge_message.battery_voltage = logic_battery_get_vbat();
-        comms_main_mcu_message_for_main_replies.nimh_charge_message.charge_current = logic_battery_get_charging_current();
-        comms_main_mcu_message_for_main_replies.nimh_charge_message.dac_data_reg = platform_io_get_dac_data_register_set();
-        comms_main_mcu_message_for_main_replies.nimh_charge_message.stepdown_voltage = logic_battery_get_stepdown_voltage();
+        comms_main_mcu_get_empty_tx_slot(&reply_pt, AUX_MCU_MSG_TYPE_NIMH_CHARGE);
+        reply_pt->payload_length1 = sizeof(nimh_charge_message_t);
+        reply_pt->nimh_charge_message.charge_status = logic_battery_get_charging_status();
+        reply_pt->nimh_charge_message.battery_voltage = logic_battery_get_vbat();
+        reply_pt->nimh_charge_message.charge_current = logic_battery_get_charging_current();
+        reply_pt->nimh_charge_message.dac_data_reg = platform_io_get_dac_data_register_set();
+        reply_pt->nimh_charge_message.stepdown_voltage = logic_battery_get_stepdown_voltage();
         
         /* Send message */
-        comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));
+        comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));
     }
     else if (message->message_type == AUX_MCU_MSG_TYPE_BOOTLOADER)
     {
@@ -249,67 +277,19 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
     }
     else if (message->message_type == AUX_MCU_MSG_TYPE_PING_WITH_INFO)
     {
-        comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_IM_HERE, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+        comms_main_mcu_send_simple_event(AUX_MCU_EVENT_IM_HERE);
     }    
     else if (message->message_type == AUX_MCU_MSG_TYPE_KEYBOARD_TYPE)
     {
-        BOOL typing_success_bool = TRUE;
-        
-        /* This command may take a while... let's use our other buffer to prevent corruptions */
-        memcpy((void*)&comms_main_mcu_message_for_main_replies, message, sizeof(comms_main_mcu_message_for_main_replies));
-        
-        /* Iterate over symbols */
-        uint16_t counter = 0;
-        while(comms_main_mcu_message_for_main_replies.keyboard_type_message.keyboard_symbols[counter] != 0)
+        /* Queue typing job: typing is done by our main loop, typing status sent once done */
+        if (logic_keyboard_start_typing_job(&message->keyboard_type_message) != RETURN_OK)
         {
-            uint16_t symbol = comms_main_mcu_message_for_main_replies.keyboard_type_message.keyboard_symbols[counter];
-            
-            if (symbol == 0xFFFF)
-            {
-                /* Original unicode point can't be typed */
-            }            
-            else if ((symbol & 0x7F00) == 0)
-            {
-                BOOL is_dead_key = FALSE;
-                
-                /* Check for dead key */
-                if ((symbol & 0x8000) != 0)
-                {
-                    is_dead_key = TRUE;
-                }                    
-                
-                /* One key to be typed */
-                if (logic_keyboard_type_symbol((hid_interface_te)comms_main_mcu_message_for_main_replies.keyboard_type_message.interface_identifier, (uint8_t)symbol, is_dead_key, comms_main_mcu_message_for_main_replies.keyboard_type_message.delay_between_types) != RETURN_OK)
-                {
-                    typing_success_bool = FALSE;
-                    break;
-                }
-            }
-            else
-            {
-                /* Two keys to be typed */
-                if (logic_keyboard_type_symbol((hid_interface_te)comms_main_mcu_message_for_main_replies.keyboard_type_message.interface_identifier, (uint8_t)(symbol >> 8), FALSE, comms_main_mcu_message_for_main_replies.keyboard_type_message.delay_between_types) != RETURN_OK)
-                {
-                    typing_success_bool = FALSE;
-                    break;
-                }
-                if (logic_keyboard_type_symbol((hid_interface_te)comms_main_mcu_message_for_main_replies.keyboard_type_message.interface_identifier, (uint8_t)symbol, FALSE, comms_main_mcu_message_for_main_replies.keyboard_type_message.delay_between_types) != RETURN_OK)
-                {
-                    typing_success_bool = FALSE;
-                    break;
-                }
-            }
-            
-            /* Move on to the next symbol */
-            counter++;
+            /* Typing job already in progress */
+            comms_main_mcu_get_empty_tx_slot(&reply_pt, AUX_MCU_MSG_TYPE_KEYBOARD_TYPE);
+            reply_pt->payload_as_uint16[0] = (uint16_t)FALSE;
+            reply_pt->payload_length1 = sizeof(uint16_t);
+            comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));
         }
-            
-        /* Send success status */
-        memset((void*)&comms_main_mcu_message_for_main_replies, 0x00, sizeof(comms_main_mcu_message_for_main_replies));
-        comms_main_mcu_message_for_main_replies.message_type = AUX_MCU_MSG_TYPE_KEYBOARD_TYPE;
-        comms_main_mcu_message_for_main_replies.payload_as_uint16[0] = (uint16_t)typing_success_bool;
-        comms_main_mcu_message_for_main_replies.payload_length1 = sizeof(uint16_t);
-        comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));
     }
     else if (message->message_type == AUX_MCU_MSG_TYPE_BLE_CMD)
     {
@@ -323,7 +303,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                     logic_bluetooth_start_bluetooth(message->ble_message.payload);
                     logic_set_ble_enabled();
                 }
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_BLE_ENABLED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_BLE_ENABLED);
                 break;
             }
             case BLE_MESSAGE_CMD_DISABLE:
@@ -334,7 +314,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                     logic_bluetooth_stop_bluetooth();
                     logic_set_ble_disabled();
                 }
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_BLE_DISABLED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_BLE_DISABLED);
                 break;
             }
             case BLE_MESSAGE_CLEAR_BOND_INFO:
@@ -358,7 +338,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 if (logic_bluetooth_temporarily_ban_connected_device() == RETURN_OK)
                 {
                     /* No status messsage, only a notification of disconnection */
-                    comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_BLE_DISCONNECTED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);                    
+                    comms_main_mcu_send_simple_event(AUX_MCU_EVENT_BLE_DISCONNECTED);                    
                 }
                 break;
             }
@@ -379,7 +359,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 while (comms_main_mcu_other_msg_answered_using_first_bytes != FALSE);   
                 
                 /* Send ACK */
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_SLEEP_RECEIVED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_SLEEP_RECEIVED);
                 dma_wait_for_main_mcu_packet_sent();
                 
                 /* Set main mcu wake up timer */
@@ -418,7 +398,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 udc_attach();
                 
                 /* Inform main MCU */
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_ATTACH_CMD_RCVD, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);                
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_ATTACH_CMD_RCVD);                
                 break;
             }
             case MAIN_MCU_COMMAND_DETACH_USB:
@@ -434,82 +414,82 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 logic_battery_stop_using_adc();
 
                 /* Inform main MCU */
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_USB_DETACHED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_USB_DETACHED);
                 break;
             }
             case MAIN_MCU_COMMAND_NIMH_CHG_SLW_STRT:
             {
                 /* Charge NiMH battery */
                 logic_battery_start_charging(NIMH_SLOWSTART_45C_CHARGING);
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_CHARGE_STARTED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_CHARGE_STARTED);
                 break;                
             }
             case MAIN_MCU_COMMAND_NIMH_RECOVERY_CHG:
             {
                 /* Charge NiMH battery */
                 logic_battery_start_charging(NIMH_RECOVERY_45C_CHARGING);
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_CHARGE_STARTED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_CHARGE_STARTED);
                 break;                
             }
             case MAIN_MCU_COMMAND_NIMH_CHARGE:
             {
                 /* Charge NiMH battery */
                 logic_battery_start_charging(NIMH_45C_CHARGING);
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_CHARGE_STARTED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_CHARGE_STARTED);
                 break;
             }
             case MAIN_MCU_COMMAND_NIMH_DANGER_CHARGE:
             {
                 /* Charge NiMH battery */
                 logic_battery_start_charging(NIMH_DANGEROUS_FORCED_CHARGE);
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_CHARGE_STARTED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_CHARGE_STARTED);
                 break;
             }
             case MAIN_MCU_COMMAND_STOP_CHARGE:
             {
                 /* Stop charging battery */
                 logic_battery_stop_charging();
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_CHARGE_STOPPED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_CHARGE_STOPPED);
                 break;
             }
             case MAIN_MCU_COMMAND_SET_BATTERYLVL:
             {
                 /* Set battery level on bluetooth service */
                 logic_bluetooth_set_battery_level(message->main_mcu_command_message.payload[0]);
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_NEW_BATTERY_LVL_RCVD, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_NEW_BATTERY_LVL_RCVD);
                 break;
             }
             case MAIN_MCU_COMMAND_GET_STATUS:
             {
                 /* Status request */
-                comms_main_mcu_message_for_main_replies.message_type = AUX_MCU_MSG_TYPE_AUX_MCU_EVENT;
-                comms_main_mcu_message_for_main_replies.aux_mcu_event_message.event_id = AUX_MCU_EVEN_HERES_MY_STATUS;
-                comms_main_mcu_message_for_main_replies.payload_length1 = sizeof(comms_main_mcu_message_for_main_replies.aux_mcu_event_message.event_id) + sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint8_t);
+                comms_main_mcu_get_empty_tx_slot(&reply_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
+                reply_pt->aux_mcu_event_message.event_id = AUX_MCU_EVEN_HERES_MY_STATUS;
+                reply_pt->payload_length1 = sizeof(reply_pt->aux_mcu_event_message.event_id) + sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint8_t);
                 
                 /* Update BLE status payload */
                 if (logic_is_ble_enabled() != FALSE)
                 {
                     /* Inform BLE is enabled */
-                    comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[0] = TRUE;
+                    reply_pt->aux_mcu_event_message.payload[0] = TRUE;
                     
                     /* Try to get fw version */
                     uint32_t blusdk_fw_ver;
                     if(at_ble_firmware_version_get(&blusdk_fw_ver) == AT_BLE_SUCCESS)
                     {
                         /* Inform BLE seems to be operational */
-                        comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[1] = TRUE;
+                        reply_pt->aux_mcu_event_message.payload[1] = TRUE;
                     }
                 }
                 
                 /* Incorrect message received flag */
-                comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[2] = comms_main_mcu_invalid_message_received_from_main;
+                reply_pt->aux_mcu_event_message.payload[2] = comms_main_mcu_invalid_message_received_from_main;
                 comms_main_mcu_invalid_message_received_from_main = FALSE;
                 
                 /* Too many cb timers requested flag */
-                comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[3] = timer_get_and_clear_too_many_cb_timers_requested_flag();
+                reply_pt->aux_mcu_event_message.payload[3] = timer_get_and_clear_too_many_cb_timers_requested_flag();
                 
                 /* Send message */
-                comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));
+                comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));
                 break;
             }
             case MAIN_MCU_COMMAND_NO_COMMS_UNAV:
@@ -517,7 +497,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 /* No comms signal unavailable */
                 platform_io_disable_no_comms_signal();
                 logic_set_nocomms_unavailable();
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_NO_COMMS_INFO_RCVD, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_NO_COMMS_INFO_RCVD);
                 break;
             }
             case MAIN_MCU_COMMAND_TX_SWEEP_SGL:
@@ -550,10 +530,10 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
             case MAIN_MCU_COMMAND_FUNC_TEST:
             {
                 /* Functional test: prepare answer message */
-                comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[0] = 0;
-                comms_main_mcu_message_for_main_replies.message_type = AUX_MCU_MSG_TYPE_AUX_MCU_EVENT;
-                comms_main_mcu_message_for_main_replies.aux_mcu_event_message.event_id = AUX_MCU_EVENT_FUNC_TEST_DONE;
-                comms_main_mcu_message_for_main_replies.payload_length1 = sizeof(comms_main_mcu_message_for_main_replies.aux_mcu_event_message.event_id) + sizeof(uint8_t);
+                comms_main_mcu_get_empty_tx_slot(&reply_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
+                reply_pt->aux_mcu_event_message.payload[0] = 0;
+                reply_pt->aux_mcu_event_message.event_id = AUX_MCU_EVENT_FUNC_TEST_DONE;
+                reply_pt->payload_length1 = sizeof(reply_pt->aux_mcu_event_message.event_id) + sizeof(uint8_t);
                 
                 /* Use the bluetooth start time to discharge the ldo step down output capacitor */
                 platform_io_set_high_cur_sense_as_pull_down();
@@ -563,8 +543,8 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 logic_bluetooth_start_bluetooth(temp_mac_address);
                 if (ble_sdk_version() == 0)
                 {
-                    comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[0] = 1;
-                    comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));
+                    reply_pt->aux_mcu_event_message.payload[0] = 1;
+                    comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));
                     break;
                 }
                 
@@ -584,8 +564,8 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 if (high_voltage > 123)
                 {
                     platform_io_disable_step_down();
-                    comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[0] = 3;
-                    comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));
+                    reply_pt->aux_mcu_event_message.payload[0] = 3;
+                    comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));
                     break;
                 }
                 
@@ -606,8 +586,8 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 if ((high_voltage - low_voltage) > 100)
                 {
                     platform_io_disable_step_down();
-                    comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[0] = 3;
-                    comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));
+                    reply_pt->aux_mcu_event_message.payload[0] = 3;
+                    comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));
                     break;                    
                 }    
                 
@@ -645,7 +625,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                         /* Check for over voltage - may be caused by disconnected charge path */
                         if ((low_voltage >= LOGIC_BATTERY_MAX_V_FOR_ST_RAMP) || (current_charge_voltage > 1650))
                         {
-                            comms_main_mcu_message_for_main_replies.aux_mcu_event_message.payload[0] = 2;
+                            reply_pt->aux_mcu_event_message.payload[0] = 2;
                             break;
                         }
                         else
@@ -663,14 +643,14 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 platform_io_disable_step_down();
                 
                 /* Send functional test result */
-                comms_main_mcu_send_message((void*)&comms_main_mcu_message_for_main_replies, (uint16_t)sizeof(comms_main_mcu_message_for_main_replies));      
+                comms_main_mcu_send_message(reply_pt, (uint16_t)sizeof(aux_mcu_message_t));      
                 break;          
             }
             case MAIN_MCU_COMMAND_UPDT_DEV_STAT:
             {
                 /* Update device status buffer */
                 comms_raw_hid_update_device_status_cache(message->main_mcu_command_message.payload);
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_NEW_STATUS_RCVD, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_NEW_STATUS_RCVD);
                 break;
             }
             case MAIN_MCU_COMMAND_TYPE_SHORTCUT:
@@ -691,7 +671,7 @@ void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message
                 {
                     logic_keyboard_type_lock_shortcut((hid_interface_te)interface_id, (uint8_t)(message->main_mcu_command_message.payload_as_uint16[1]));
                 }
-                comms_main_mcu_send_simple_event_alt_buffer(AUX_MCU_EVENT_SHORTCUT_TYPED, (aux_mcu_message_t*)&comms_main_mcu_message_for_main_replies);
+                comms_main_mcu_send_simple_event(AUX_MCU_EVENT_SHORTCUT_TYPED);
                 break;
             }
             default:
@@ -22,6 +22,9 @@ extern volatile BOOL comms_main_mcu_other_msg_answered_using_first_bytes;
 /* Timeout when waiting for something from main MCU */
 #define MAIN_MCU_COMMS_WAIT_TIMEOUT     5000
 
+/* Number of messages in the tx pool: USB & BLE reassembly, reply being built, message being sent */
+#define COMMS_MAIN_MCU_NB_TX_SLOTS      4
+
 /* Defines */
 #define AUX_MCU_MSG_TYPE_USB            0x0000
 #define AUX_MCU_MSG_TYPE_BLE            0x0001
@@ -82,6 +85,7 @@ extern volatile BOOL comms_main_mcu_other_msg_answered_using_first_bytes;
 #define AUX_MCU_EVENT_NEW_STATUS_RCVD       0x0014
 #define AUX_MCU_EVENT_CHARGE_STOPPED        0x0015
 #define AUX_MCU_EVENT_NEW_BATTERY_LVL_RCVD  0x0016
+#define AUX_MCU_EVENT_TYPING_PROGRESS       0x0017
 
 // BLE commands
 #define BLE_MESSAGE_CMD_ENABLE              0x0001
@@ -327,7 +331,7 @@ ret_type_te comms_main_mcu_routine(BOOL filter_and_force_use_of_temp_receive_buf
 ret_type_te comms_main_mcu_fetch_bonding_info_for_mac(uint8_t address_resolv_type, uint8_t* mac_addr, nodemgmt_bluetooth_bonding_information_t* bonding_info);
 ret_type_te comms_main_mcu_fetch_bonding_info_for_irk(uint8_t* irk_key, nodemgmt_bluetooth_bonding_information_t* bonding_info);
 void comms_main_mcu_get_empty_packet_ready_to_be_sent(aux_mcu_message_t** message_pt_pt, uint16_t message_type);
-void comms_main_mcu_send_simple_event_alt_buffer(uint16_t event_id, aux_mcu_message_t* buffer);
+void comms_main_mcu_get_empty_tx_slot(aux_mcu_message_t** message_pt_pt, uint16_t message_type);
 void comms_main_mcu_send_message(aux_mcu_message_t* message, uint16_t message_length);
 BOOL comms_aux_mcu_get_received_packet(aux_mcu_message_t** message, BOOL arm_new_rx);
 void comms_main_mcu_deal_with_non_usb_non_ble_message(aux_mcu_message_t* message);
@@ -335,6 +339,7 @@ uint16_t comms_main_mcu_get_bonding_info_irks(uint8_t** irk_keys_buffer);
 aux_mcu_message_t* comms_main_mcu_get_temp_tx_message_object_pt(void);
 aux_mcu_message_t* comms_main_mcu_get_temp_rx_message_object_pt(void);
 void comms_main_mcu_get_32_rng_bytes_from_main_mcu(uint8_t* buffer);
+void comms_main_mcu_release_tx_slot(aux_mcu_message_t* message);
 void comms_main_mcu_fetch_6_digits_pin(uint8_t* pin_array);
 void comms_main_mcu_send_simple_event(uint16_t event_id);
 void comms_main_init_rx(void);
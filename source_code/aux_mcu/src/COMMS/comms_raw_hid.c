@@ -7,6 +7,7 @@
 #include <string.h>
 #include "platform_defines.h"
 #include "logic_bluetooth.h"
+#include "comms_hid_framing.h"
 #include "comms_main_mcu.h"
 #include "comms_raw_hid.h"
 #include "driver_timer.h"
@@ -20,16 +21,10 @@
 /* USB comms buffers */
 static hid_packet_t raw_hid_recv_buffer[NB_HID_INTERFACES];
 static hid_packet_t raw_hid_send_buffer[NB_HID_INTERFACES];
-/* Future message to be sent to MCU */
-aux_mcu_message_t comms_raw_hid_temp_mcu_message_to_send[NB_HID_INTERFACES];
-/* Packet number we're expecting to receive */
-uint16_t comms_raw_hid_expected_packet_number[NB_HID_INTERFACES] = {0,0,0};
-/* Total number of packets for current message */
-uint16_t comms_raw_hid_total_expected_packets[NB_HID_INTERFACES];
-/* Index in our temp mcu message to send at which to fill data */
-uint16_t comms_raw_hid_temp_mcu_message_fill_index[NB_HID_INTERFACES] = {0,0,0};
-/* Expected flip bit state */
-BOOL comms_raw_hid_expect_flip_bit_state_set[NB_HID_INTERFACES] = {FALSE, FALSE, FALSE};
+/* Future messages to be sent to main MCU, taken from its tx pool when a packet is received */
+aux_mcu_message_t* comms_raw_hid_mcu_message_to_send[NB_HID_INTERFACES] = {NULL, NULL, NULL};
+/* Packets reassembly states, reassembling into the messages above */
+hid_framing_reassembly_t comms_raw_hid_reassembly[NB_HID_INTERFACES];
 /* Set when we received/send a USB message */
 volatile BOOL comms_raw_hid_packet_being_sent[NB_HID_INTERFACES] = {FALSE, FALSE, FALSE};
 volatile BOOL comms_raw_hid_packet_received[NB_HID_INTERFACES] = {FALSE, FALSE, FALSE};
@@ -262,13 +257,11 @@ void comms_raw_hid_send_packet(hid_interface_te hid_interface, hid_packet_t* pac
 */
 void comms_raw_hid_send_hid_message(hid_interface_te hid_interface, aux_mcu_message_t* message)
 {
-    uint8_t total_number_of_packets = ((message->payload_length1 + sizeof(raw_hid_send_buffer[0].mtc_hid_packet.payload) - 1)/sizeof(raw_hid_send_buffer[0].mtc_hid_packet.payload))-1;
-    uint16_t remaining_payload_to_send = message->payload_length1;
-    uint16_t payload_offset = 0;
-    uint8_t packet_id = 0;
+    hid_framing_fragmentation_t fragmentation;
     
     /* Generate and send packets */
-    while(remaining_payload_to_send > 0)
+    comms_hid_framing_start_fragmentation(&fragmentation, message->payload, message->payload_length1);
+    while(fragmentation.message_offset < fragmentation.message_length)
     {
         timer_start_timer(TIMER_USB_SEND_TIMEOUT, 1000);
         /* Wait for a possible previous packet to be sent as we do buffer re-use */
@@ -289,37 +282,9 @@ void comms_raw_hid_send_hid_message(hid_interface_te hid_interface, aux_mcu_mess
         }
         
         /* Generate packet */
-        memset((void*)&raw_hid_send_buffer[hid_interface], 0, sizeof(raw_hid_send_buffer[0]));
-        raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte1.total_packets = total_number_of_packets;
-        raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte1.packet_id = packet_id;
-        
-        /* We do not care about the flip bit */
-        if (remaining_payload_to_send > sizeof(raw_hid_send_buffer[0].mtc_hid_packet.payload))
-        {
-            raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len = sizeof(raw_hid_send_buffer[0].mtc_hid_packet.payload);
-        }
-        else
-        {
-            raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len = remaining_payload_to_send;            
-        }
-        
-        /* Copy payload */
-        memcpy(raw_hid_send_buffer[hid_interface].mtc_hid_packet.payload, &(message->payload[payload_offset]), raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len);
-        
-        /* 0-fill padding */
-        uint16_t padding_length = sizeof(raw_hid_send_buffer[0].mtc_hid_packet.payload) - raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len;
-        if (padding_length != 0)
-        {
-            memset((void*)(&raw_hid_send_buffer[hid_interface].mtc_hid_packet.payload[raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len]), 0x00, padding_length);
-        }
-        
-        /* update local vars */
-        remaining_payload_to_send -= raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len;
-        payload_offset += raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len;
-        packet_id += 1;
+        comms_hid_framing_get_next_packet(&fragmentation, raw_hid_send_buffer[hid_interface].raw_packet);
         
         /* Send packet: always send 64B due to some strange windows receive trigger thingy */
-        //comms_raw_hid_send_packet(&raw_hid_send_buffer, TRUE, sizeof(raw_hid_send_buffer.byte0) + sizeof(raw_hid_send_buffer.byte1) + raw_hid_send_buffer.byte0.payload_len);
         comms_raw_hid_send_packet(hid_interface, &raw_hid_send_buffer[hid_interface], TRUE, USB_RAWHID_RX_SIZE);
     }
 }
@@ -360,9 +325,7 @@ void comms_raw_hid_connection_set_callback(hid_interface_te hid_interface)
     }    
     
     /* Reset global vars */
-    comms_raw_hid_expect_flip_bit_state_set[hid_interface] = FALSE;
-    comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
-    comms_raw_hid_expected_packet_number[hid_interface] = 0;
+    comms_hid_framing_reset_reassembly(&comms_raw_hid_reassembly[hid_interface]);
     comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
 } 
 
@@ -438,78 +401,24 @@ comms_usb_ret_te comms_usb_communication_routine(void)
                 comms_raw_hid_at_least_one_msg_rcvd_from_prop_hid = TRUE;
             }
 
-            /* Special case: first two bytes set to 0xFF 0xFF, reset flip bit */
-            uint8_t* usb_recast = (uint8_t*)&raw_hid_recv_buffer[hid_interface];
-            if ((usb_recast[0] == 0xFF) && (usb_recast[1] == 0xFF))
-            {
-                comms_raw_hid_expect_flip_bit_state_set[hid_interface] = FALSE;
-                comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
-                comms_raw_hid_expected_packet_number[hid_interface] = 0;
-                comms_raw_hid_arm_packet_receive(hid_interface);
-                return ret_val;
-            }
-            
-            /* Check for bit flip state: if it doesn't match, reset fill indexes */
-            if (((comms_raw_hid_expect_flip_bit_state_set[hid_interface] != FALSE) && (raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte0.flip_bit == 0)) || ((comms_raw_hid_expect_flip_bit_state_set[hid_interface] == FALSE) && (raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte0.flip_bit != 0)))
-            {
-                comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
-                comms_raw_hid_expected_packet_number[hid_interface] = 0;
-                comms_raw_hid_arm_packet_receive(hid_interface);
-                return ret_val;
-            }
-            
-            /* Check for expected packet number */
-            if ((comms_raw_hid_expected_packet_number[hid_interface] != 0) && (raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte1.packet_id != comms_raw_hid_expected_packet_number[hid_interface]))
-            {
-                comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
-                comms_raw_hid_expected_packet_number[hid_interface] = 0;
-                comms_raw_hid_arm_packet_receive(hid_interface);
-                return ret_val;
-            }
-            
-            /* If first packet, store total number of packets for this hid message */
-            if (raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte1.packet_id == 0)
-            {
-                comms_raw_hid_total_expected_packets[hid_interface] = raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte1.total_packets;
-                
-                /* Reset index to fill temp message payload */
-                comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
-                
-                /* Prepare future packet to send to main MCU */
-                memset((void*)&comms_raw_hid_temp_mcu_message_to_send[hid_interface], 0, sizeof(comms_raw_hid_temp_mcu_message_to_send[0]));
-                uint16_t msg_type_lut[NB_HID_INTERFACES] = {AUX_MCU_MSG_TYPE_USB, AUX_MCU_MSG_TYPE_BLE};
-                comms_raw_hid_temp_mcu_message_to_send[hid_interface].message_type = msg_type_lut[hid_interface];
-            }
-            
-            /* Check for overflow tentative */
-            if ((size_t)(comms_raw_hid_temp_mcu_message_fill_index[hid_interface] + raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte0.payload_len) > sizeof(comms_raw_hid_temp_mcu_message_to_send[0].payload))
+            /* Reassemble directly in a message from the main MCU tx pool, sent as is once complete */
+            uint16_t msg_type_lut[NB_HID_INTERFACES] = {AUX_MCU_MSG_TYPE_USB, AUX_MCU_MSG_TYPE_BLE};
+            if (comms_raw_hid_mcu_message_to_send[hid_interface] == NULL)
             {
-                comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
-                comms_raw_hid_expected_packet_number[hid_interface] = 0;
-                comms_raw_hid_arm_packet_receive(hid_interface);
-                return ret_val;
+                comms_main_mcu_get_empty_tx_slot(&comms_raw_hid_mcu_message_to_send[hid_interface], msg_type_lut[hid_interface]);
+                comms_raw_hid_reassembly[hid_interface].message_buffer = comms_raw_hid_mcu_message_to_send[hid_interface]->payload;
+                comms_raw_hid_reassembly[hid_interface].message_buffer_length = sizeof(comms_raw_hid_mcu_message_to_send[hid_interface]->payload);
             }
+            aux_mcu_message_t* temp_message_pt = comms_raw_hid_mcu_message_to_send[hid_interface];
             
-            /* Fill temp mcu message payload */
-            memcpy((void*)&comms_raw_hid_temp_mcu_message_to_send[hid_interface].payload[comms_raw_hid_temp_mcu_message_fill_index[hid_interface]], (void*)raw_hid_recv_buffer[hid_interface].mtc_hid_packet.payload, raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte0.payload_len);
-            comms_raw_hid_temp_mcu_message_fill_index[hid_interface] += raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte0.payload_len;
-            comms_raw_hid_expected_packet_number[hid_interface]++;
+            /* Reassemble: the framing module deals with flip bit, packet ids and resynchronization after a lost packet */
+            hid_framing_ret_te framing_ret = comms_hid_framing_process_packet(&comms_raw_hid_reassembly[hid_interface], raw_hid_recv_buffer[hid_interface].raw_packet, sizeof(raw_hid_recv_buffer[0]));
             
-            /* Check for last message */
-            if (raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte1.packet_id == comms_raw_hid_total_expected_packets[hid_interface])
+            /* Message complete? */
+            if (framing_ret == HID_FRAMING_MESSAGE_COMPLETE)
             {
-                /* Switch flip bit */
-                if (comms_raw_hid_expect_flip_bit_state_set[hid_interface] == FALSE)
-                {
-                    comms_raw_hid_expect_flip_bit_state_set[hid_interface] = TRUE;
-                }
-                else
-                {
-                    comms_raw_hid_expect_flip_bit_state_set[hid_interface] = FALSE;
-                }
-                
                 /* If ack is requested from host */
-                if (raw_hid_recv_buffer[hid_interface].mtc_hid_packet.byte0.ack_flag_or_req != 0)
+                if (comms_raw_hid_reassembly[hid_interface].ack_requested != FALSE)
                 {
                     /* Send the same message */
                     memcpy((void*)&raw_hid_send_buffer[hid_interface], (void*)&raw_hid_recv_buffer[hid_interface], sizeof(raw_hid_send_buffer[0]));
@@ -517,33 +426,26 @@ comms_usb_ret_te comms_usb_communication_routine(void)
                 }
                 
                 /* Prepare and send message to main MCU */
-                comms_raw_hid_temp_mcu_message_to_send[hid_interface].payload_length1 = comms_raw_hid_temp_mcu_message_fill_index[hid_interface];
+                temp_message_pt->payload_length1 = comms_raw_hid_reassembly[hid_interface].message_length;
                 
                 /* Check for special case were the device status is requested: send local cache instead */
-                if (comms_raw_hid_temp_mcu_message_to_send[hid_interface].hid_message.message_type == HID_CMD_GET_DEVICE_STATUS)
+                if (temp_message_pt->hid_message.message_type == HID_CMD_GET_DEVICE_STATUS)
                 {
-                    comms_raw_hid_temp_mcu_message_to_send[hid_interface].hid_message.payload_length = sizeof(comms_hid_device_status_cache);
-                    memcpy(comms_raw_hid_temp_mcu_message_to_send[hid_interface].hid_message.payload, comms_hid_device_status_cache, sizeof(comms_hid_device_status_cache));
-                    comms_raw_hid_temp_mcu_message_to_send[hid_interface].payload_length1 = sizeof(comms_raw_hid_temp_mcu_message_to_send[hid_interface].hid_message.message_type) + sizeof(comms_raw_hid_temp_mcu_message_to_send[hid_interface].hid_message.payload_length) + comms_raw_hid_temp_mcu_message_to_send[hid_interface].hid_message.payload_length;
-                    comms_raw_hid_send_hid_message(hid_interface, &comms_raw_hid_temp_mcu_message_to_send[hid_interface]);
+                    temp_message_pt->hid_message.payload_length = sizeof(comms_hid_device_status_cache);
+                    memcpy(temp_message_pt->hid_message.payload, comms_hid_device_status_cache, sizeof(comms_hid_device_status_cache));
+                    temp_message_pt->payload_length1 = sizeof(temp_message_pt->hid_message.message_type) + sizeof(temp_message_pt->hid_message.payload_length) + temp_message_pt->hid_message.payload_length;
+                    comms_raw_hid_send_hid_message(hid_interface, temp_message_pt);
                 } 
                 else
                 {
-                    comms_main_mcu_send_message(&comms_raw_hid_temp_mcu_message_to_send[hid_interface], (uint16_t)sizeof(comms_raw_hid_temp_mcu_message_to_send[0]));
-                }                
-                
-                /* Rearm hid interface */
-                comms_raw_hid_arm_packet_receive(hid_interface);
-                
-                /* Reset vars */
-                comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
-                comms_raw_hid_expected_packet_number[hid_interface] = 0;
-            }
-            else
-            {
-                /* here we should implement in the future transfers in multiple chunks */
-                comms_raw_hid_arm_packet_receive(hid_interface);
+                    /* Message now belongs to the DMA, next message reassembled in another one */
+                    comms_main_mcu_send_message(temp_message_pt, (uint16_t)sizeof(aux_mcu_message_t));
+                    comms_raw_hid_mcu_message_to_send[hid_interface] = NULL;
+                }
             }
+            
+            /* Rearm hid interface */
+            comms_raw_hid_arm_packet_receive(hid_interface);
         }
     }
     
@@ -570,21 +472,22 @@ void comms_usb_debug_printf(const char *fmt, ...)
         /* Compute number of chars printed to our buffer */
         uint16_t actual_printed_chars = (uint16_t)hypothetical_nb_chars < sizeof(buf)-1? (uint16_t)hypothetical_nb_chars : sizeof(buf)-1;
         
-        /* Use message to send to aux mcu as temporary buffer */
-        dma_wait_for_main_mcu_packet_sent();
-        memset((void*)&comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE], 0, sizeof(comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE]));
-        comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE].hid_message.message_type = HID_CMD_ID_DEBUG_MSG;
-        comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE].hid_message.payload_length = actual_printed_chars*2 + 2;
-        comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE].payload_length1 = comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE].hid_message.payload_length + sizeof(comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE].hid_message.payload_length) + sizeof(comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE].hid_message.message_type);
+        /* Use a message from the main MCU tx pool as temporary buffer */
+        aux_mcu_message_t* temp_message_pt;
+        comms_main_mcu_get_empty_tx_slot(&temp_message_pt, AUX_MCU_MSG_TYPE_USB);
+        temp_message_pt->hid_message.message_type = HID_CMD_ID_DEBUG_MSG;
+        temp_message_pt->hid_message.payload_length = actual_printed_chars*2 + 2;
+        temp_message_pt->payload_length1 = temp_message_pt->hid_message.payload_length + sizeof(temp_message_pt->hid_message.payload_length) + sizeof(temp_message_pt->hid_message.message_type);
         
         /* Copy to message payload */
         for (uint16_t i = 0; i < actual_printed_chars; i++)
         {
-            comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE].hid_message.payload_as_uint16[i] = buf[i];
+            temp_message_pt->hid_message.payload_as_uint16[i] = buf[i];
         }
         
         /* Send message */
-        comms_raw_hid_send_hid_message(USB_INTERFACE, &comms_raw_hid_temp_mcu_message_to_send[USB_INTERFACE]);
+        comms_raw_hid_send_hid_message(USB_INTERFACE, temp_message_pt);
+        comms_main_mcu_release_tx_slot(temp_message_pt);
     }
     va_end(ap);
 }
@@ -273,6 +273,23 @@ void* dma_get_pointer_to_message_being_sent_to_main_mcu(void)
     return dma_pt_to_message_being_sent_to_main_mcu;
 }
 
+/*! \fn     dma_is_message_being_sent_to_main_mcu(void* message)
+*   \brief  Check if a given message is still being read by the DMA
+*   \param  message     Pointer to the message
+*   \return TRUE if the message is being sent to main MCU
+*/
+BOOL dma_is_message_being_sent_to_main_mcu(void* message)
+{
+    if ((dma_main_mcu_packet_sent == FALSE) && (dma_pt_to_message_being_sent_to_main_mcu == message))
+    {
+        return TRUE;
+    }
+    else
+    {
+        return FALSE;
+    }
+}
+
 /*! \fn     dma_main_mcu_disable_transfer(void)
 *   \brief  Disable the DMA transfer for the main MCU comms
 */
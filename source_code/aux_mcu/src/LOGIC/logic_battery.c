@@ -581,7 +581,7 @@ battery_action_te logic_battery_task(void)
                         aux_mcu_message_t* temp_tx_message_pt;
 
                         /* Update main MCU with new battery level */
-                        comms_main_mcu_get_empty_packet_ready_to_be_sent(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
+                        comms_main_mcu_get_empty_tx_slot(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
                         temp_tx_message_pt->aux_mcu_event_message.event_id = AUX_MCU_EVENT_CHARGE_LVL_UPDATE;
                         temp_tx_message_pt->aux_mcu_event_message.payload[0] = possible_new_battery_level;
                         temp_tx_message_pt->payload_length1 = sizeof(temp_tx_message_pt->aux_mcu_event_message.event_id) + sizeof(uint8_t);
@@ -622,7 +622,7 @@ battery_action_te logic_battery_task(void)
 void logic_battery_inform_main_of_charge_done(uint16_t peak_voltage_level)
 {
     aux_mcu_message_t* temp_tx_message_pt;
-    comms_main_mcu_get_empty_packet_ready_to_be_sent(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
+    comms_main_mcu_get_empty_tx_slot(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
     temp_tx_message_pt->aux_mcu_event_message.event_id = AUX_MCU_EVENT_CHARGE_DONE;
     temp_tx_message_pt->aux_mcu_event_message.payload_as_uint16[0] = peak_voltage_level;
     temp_tx_message_pt->payload_length1 = sizeof(temp_tx_message_pt->aux_mcu_event_message.event_id) + sizeof(uint16_t);
@@ -246,7 +246,7 @@ void logic_bluetooth_successfull_pairing_call(ble_connected_dev_info_t* dev_info
     }
         
     /* Inform main MCU */
-    comms_main_mcu_get_empty_packet_ready_to_be_sent(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_BLE_CMD);
+    comms_main_mcu_get_empty_tx_slot(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_BLE_CMD);
         
     /* Set payload size */
     temp_tx_message_pt->payload_length1 = sizeof(temp_tx_message_pt->ble_message.message_id) + sizeof(temp_tx_message_pt->ble_message.bonding_information_to_store_message);
@@ -1791,13 +1791,63 @@ ret_type_te logic_bluetooth_send_modifier_and_key(uint8_t modifier, uint8_t key,
     }
 }
 
+/*! \fn     logic_bluetooth_send_keyboard_report(uint8_t modifier, uint8_t* keys, uint16_t nb_keys)
+*   \brief  Queue a full keyboard report for sending through keyboard link
+*   \param  modifier    HID modifier
+*   \param  keys        HID keys, in the order they should be processed by the host
+*   \param  nb_keys     Number of keys, up to 6
+*   \return If we were able to queue the report
+*   \note   Doesn't wait for the report to be sent, use logic_bluetooth_is_keyboard_report_sent()
+*/
+ret_type_te logic_bluetooth_send_keyboard_report(uint8_t modifier, uint8_t* keys, uint16_t nb_keys)
+{
+    if ((logic_bluetooth_can_communicate_with_host == FALSE) || (nb_keys > sizeof(logic_bluetooth_keyboard_in_report) - 2))
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Fill report: modifier, reserved byte, key slots */
+    memset(logic_bluetooth_keyboard_in_report, 0, sizeof(logic_bluetooth_keyboard_in_report));
+    logic_bluetooth_keyboard_in_report[0] = modifier;
+    memcpy(&logic_bluetooth_keyboard_in_report[2], keys, nb_keys);
+    logic_bluetooth_notif_being_sent = KEYBOARD_NOTIF_SENDING;
+    logic_bluetooth_typed_report_sent = FALSE;
+    logic_bluetooth_update_report(logic_bluetooth_ble_connection_handle, BLE_KEYBOARD_HID_SERVICE_INSTANCE, BLE_KEYBOARD_HID_IN_REPORT_NB, logic_bluetooth_keyboard_in_report, sizeof(logic_bluetooth_keyboard_in_report), TRUE);
+    return RETURN_OK;
+}
+
+/*! \fn     logic_bluetooth_is_keyboard_report_sent(void)
+*   \brief  Know if the last queued keyboard report was sent
+*   \return TRUE if the notification was confirmed
+*/
+BOOL logic_bluetooth_is_keyboard_report_sent(void)
+{
+    return logic_bluetooth_typed_report_sent;
+}
+
+/*! \fn     logic_bluetooth_is_notification_being_sent(void)
+*   \brief  Know if a notification is currently being sent
+*   \return TRUE if a notification wasn't confirmed yet
+*/
+BOOL logic_bluetooth_is_notification_being_sent(void)
+{
+    if (logic_bluetooth_notif_being_sent == NONE_NOTIF_SENDING)
+    {
+        return FALSE;
+    }
+    else
+    {
+        return TRUE;
+    }
+}
+
 /*! \fn     logic_bluetooth_routine(void)
 *   \brief  Our bluetooth routine
 */
 void logic_bluetooth_routine(void)
 {
-    /* Update battery pct if needed */
-    if (logic_bluetooth_pending_battery_level != UINT8_MAX)
+    /* Update battery pct if needed, when no other notification is being sent */
+    if ((logic_bluetooth_pending_battery_level != UINT8_MAX) && (logic_bluetooth_notif_being_sent == NONE_NOTIF_SENDING))
     {
         logic_bluetooth_ble_battery_level = logic_bluetooth_pending_battery_level;
         logic_bluetooth_pending_battery_level = UINT8_MAX;
@@ -276,6 +276,7 @@ void logic_bluetooth_update_report(uint16_t conn_handle, uint8_t serv_inst, uint
 void logic_bluetooth_boot_key_report_update(at_ble_handle_t conn_handle, uint8_t serv_inst, uint8_t* bootreport, uint16_t len);
 void logic_bluetooth_successfull_pairing_call(ble_connected_dev_info_t* dev_info, at_ble_connected_t* connected_info);
 ret_type_te logic_bluetooth_send_modifier_and_key(uint8_t modifier, uint8_t key, uint8_t second_key);
+ret_type_te logic_bluetooth_send_keyboard_report(uint8_t modifier, uint8_t* keys, uint16_t nb_keys);
 uint8_t logic_bluetooth_get_report_characteristic(uint16_t handle, uint8_t serv, uint8_t reportid);
 uint8_t logic_bluetooth_get_notif_instance(uint8_t serv_num, uint16_t char_handle);
 void logic_bluetooth_gpio_set(at_ble_gpio_pin_t pin, at_ble_gpio_status_t status);
@@ -290,9 +291,11 @@ uint8_t logic_bluetooth_get_hid_serv_instance(uint16_t handle);
 void logic_bluetooth_encryption_changed_success(uint8_t* mac);
 BOOL logic_bluetooth_is_device_temp_banned(uint8_t* mac);
 at_ble_status_t ble_char_changed_app_event(void* param);
+BOOL logic_bluetooth_is_notification_being_sent(void);
 void logic_bluetooth_clear_bonding_information(void);
 void logic_bluetooth_set_battery_level(uint8_t pct);
 ret_type_te logic_bluetooth_stop_advertising(void);
+BOOL logic_bluetooth_is_keyboard_report_sent(void);
 BOOL logic_bluetooth_get_open_to_pairing(void);
 void logic_bluetooth_start_advertising(void);
 BOOL logic_bluetooth_can_talk_to_host(void);
@@ -13,15 +13,26 @@
 #include "udc.h"
 /* Buffer containing the keys to be sent through USB */
 uint8_t logic_keyboard_usb_hid_keys_buffer[8];
+/* Set while a keyboard report is being sent through USB */
+volatile BOOL logic_keyboard_usb_report_being_sent = FALSE;
+/* Current typing job */
+logic_keyboard_typing_job_t logic_keyboard_typing_job;
 
 
 /*! \fn     logic_keyboard_type_lock_shortcut(hid_interface_te interface_id, uint8_t l_symbol)
 *   \brief  Type the lock shortcut
 *   \param  interface           HID interface on which to type the symbol
 *   \param  symbol              The l symbol
+*   \note   Not typed while a typing job is in progress, as our reports would interleave with the job's
 */
 void logic_keyboard_type_lock_shortcut(hid_interface_te interface_id, uint8_t l_symbol)
 {
+    /* Typing job in progress */
+    if (logic_keyboard_typing_job.state != TYPING_JOB_IDLE)
+    {
+        return;
+    }
+    
     /* Check for enumeration */
     if ((interface_id == USB_INTERFACE) && ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100)))
     {
@@ -56,9 +67,16 @@ void logic_keyboard_type_lock_shortcut(hid_interface_te interface_id, uint8_t l_
 *   \param  modifier            Modifier (alt, shift...)
 *   \param  delay_between_types Delay between types in ms
 *   \return If we were able to type the key
+*   \note   Refused while a typing job is in progress, as our reports would interleave with the job's
 */
 ret_type_te logic_keyboard_type_key_with_modifier(hid_interface_te interface, uint8_t key, uint8_t modifier, uint16_t delay_between_types)
 {
+    /* Typing job in progress */
+    if (logic_keyboard_typing_job.state != TYPING_JOB_IDLE)
+    {
+        return RETURN_NOK;
+    }
+    
     /* Check for enumeration */
     if ((interface == USB_INTERFACE) && ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100)))
     {
@@ -127,54 +145,218 @@ ret_type_te logic_keyboard_type_key_with_modifier(hid_interface_te interface, ui
 */
 ret_type_te logic_keyboard_type_symbol(hid_interface_te interface, uint8_t symbol, BOOL is_dead_key, uint16_t delay_between_types)
 {
-    uint8_t masked_key = symbol & (SHIFT_MASK|ALTGR_MASK);
+    logic_keyboard_keystroke_t keystroke;
     ret_type_te return_val;
-        
-    if ((symbol & 0x3F) == KEY_EUROPE_2)
+    
+    /* Get key & modifier, type them */
+    logic_keyboard_symbol_to_keystroke(symbol, &keystroke);
+    return_val = logic_keyboard_type_key_with_modifier(interface, keystroke.key, keystroke.modifier, delay_between_types);
+    
+    /* Add space if typed character is a dead key */
+    if ((is_dead_key != FALSE) && (return_val == RETURN_OK))
     {
-        // Because of a redefine of KEY_EUROPE_2 for storage purposes we need to do that
-        uint8_t mod_tbs = 0;
-            
-        if (masked_key == (SHIFT_MASK|ALTGR_MASK))
-        {
-            mod_tbs = KEY_SHIFT|KEY_RIGHT_ALT;
-        }
-        else if (masked_key == SHIFT_MASK)
-        {
-            mod_tbs = KEY_SHIFT;
-        }
-        else if (masked_key == ALTGR_MASK)
+        return_val = logic_keyboard_type_key_with_modifier(interface, KEY_SPACE, 0, delay_between_types);        
+    }
+    
+    return return_val;
+}
+
+/*! \fn     logic_keyboard_start_report_send(hid_interface_te interface, uint8_t modifier, uint8_t* keys, uint16_t nb_keys)
+*   \brief  Start sending a keyboard report
+*   \param  interface   HID interface on which to send the report
+*   \param  modifier    Modifier (alt, shift...)
+*   \param  keys        Keys to send
+*   \param  nb_keys     Number of keys
+*   \return If we were able to start sending the report
+*/
+static ret_type_te logic_keyboard_start_report_send(hid_interface_te interface, uint8_t modifier, uint8_t* keys, uint16_t nb_keys)
+{
+    if (interface == USB_INTERFACE)
+    {
+        /* Check for enumeration */
+        if ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100))
         {
-            mod_tbs = KEY_RIGHT_ALT;
+            return RETURN_NOK;
         }
-            
-        // Send the correct KEY_EUROPE_2 with the correct modifier
-        return_val = logic_keyboard_type_key_with_modifier(interface, KEY_EUROPE_2_REAL, mod_tbs, delay_between_types);
+        
+        /* Fill report, send it */
+        memset(logic_keyboard_usb_hid_keys_buffer, 0, sizeof(logic_keyboard_usb_hid_keys_buffer));
+        logic_keyboard_usb_hid_keys_buffer[0] = modifier;
+        memcpy(&logic_keyboard_usb_hid_keys_buffer[2], keys, nb_keys);
+        logic_keyboard_usb_report_being_sent = TRUE;
+        usb_send(USB_KEYBOARD_ENDPOINT, (uint8_t*)logic_keyboard_usb_hid_keys_buffer, sizeof(logic_keyboard_usb_hid_keys_buffer));
+        return RETURN_OK;
     }
-    else if (masked_key == (SHIFT_MASK|ALTGR_MASK))
+    else
     {
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol & ~(SHIFT_MASK|ALTGR_MASK), KEY_SHIFT|KEY_RIGHT_ALT, delay_between_types);
+        return logic_bluetooth_send_keyboard_report(modifier, keys, nb_keys);
     }
-    else if (masked_key == SHIFT_MASK)
+}
+
+/*! \fn     logic_keyboard_end_typing_job(BOOL typing_success)
+*   \brief  End the current typing job and send the typing status to the main MCU
+*   \param  typing_success  If all symbols could be typed
+*/
+static void logic_keyboard_end_typing_job(BOOL typing_success)
+{
+    aux_mcu_message_t* temp_tx_message_pt;
+    
+    /* Job done */
+    logic_keyboard_typing_job.state = TYPING_JOB_IDLE;
+    
+    /* Send typing status */
+    comms_main_mcu_get_empty_tx_slot(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_KEYBOARD_TYPE);
+    temp_tx_message_pt->payload_as_uint16[0] = (uint16_t)typing_success;
+    temp_tx_message_pt->payload_length1 = sizeof(uint16_t);
+    comms_main_mcu_send_message((void*)temp_tx_message_pt, (uint16_t)sizeof(aux_mcu_message_t));
+}
+
+/*! \fn     logic_keyboard_send_next_job_report(void)
+*   \brief  Send the next report of the current typing job: modifier, keys or keys release
+*/
+static void logic_keyboard_send_next_job_report(void)
+{
+    logic_keyboard_typing_job_t* job_pt = &logic_keyboard_typing_job;
+    hid_interface_te interface = (hid_interface_te)job_pt->message.interface_identifier;
+    logic_keyboard_report_t report;
+    
+    /* Only one notification can be in flight over BLE */
+    if ((interface == BLE_INTERFACE) && (logic_bluetooth_is_notification_being_sent() != FALSE))
     {
-        // If we need shift
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol & ~SHIFT_MASK, KEY_SHIFT, delay_between_types);
+        return;
     }
-    else if (masked_key == ALTGR_MASK)
+    
+    /* Refill keystrokes buffer */
+    while ((job_pt->symbol_index < ARRAY_SIZE(job_pt->message.keyboard_symbols)) && (job_pt->message.keyboard_symbols[job_pt->symbol_index] != 0) && (logic_keyboard_sequencer_add_symbol(&job_pt->sequencer, job_pt->message.keyboard_symbols[job_pt->symbol_index]) != FALSE))
     {
-        // We need altgr for the numbered keys, only possible because we don't use the numerical keypad
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol & ~ALTGR_MASK, KEY_RIGHT_ALT, delay_between_types);
+        job_pt->symbol_index++;
     }
-    else
+    
+    /* All done? */
+    if (logic_keyboard_sequencer_get_next_report(&job_pt->sequencer, &report) == FALSE)
     {
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol, 0, delay_between_types);
+        logic_keyboard_end_typing_job(TRUE);
+        return;
     }
     
-    /* Add space if typed character is a dead key */
-    if ((is_dead_key != FALSE) && (return_val == RETURN_OK))
+    /* Start sending report */
+    if (logic_keyboard_start_report_send(interface, report.modifier, report.keys, report.nb_keys) != RETURN_OK)
     {
-        return_val = logic_keyboard_type_key_with_modifier(interface, KEY_SPACE, 0, delay_between_types);        
+        logic_keyboard_end_typing_job(FALSE);
+        return;
+    }
+    timer_start_timer(TIMER_KEYBOARD_TYPING, LOGIC_KEYBOARD_REPORT_SENT_TIMEOUT);
+    job_pt->state = TYPING_JOB_WAIT_REPORT_SENT;
+}
+
+/*! \fn     logic_keyboard_start_typing_job(keyboard_type_message_t* message)
+*   \brief  Queue a keyboard type message for typing by logic_keyboard_typing_routine()
+*   \param  message     The keyboard type message, copied
+*   \return RETURN_NOK if a typing job is already in progress
+*   \note   The typing status is sent to the main MCU once the job is done
+*/
+ret_type_te logic_keyboard_start_typing_job(keyboard_type_message_t* message)
+{
+    if (logic_keyboard_typing_job.state != TYPING_JOB_IDLE)
+    {
+        return RETURN_NOK;
     }
     
-    return return_val;
+    memset(&logic_keyboard_typing_job, 0, sizeof(logic_keyboard_typing_job));
+    memcpy(&logic_keyboard_typing_job.message, message, sizeof(logic_keyboard_typing_job.message));
+    logic_keyboard_typing_job.state = TYPING_JOB_SEND_REPORT;
+    return RETURN_OK;
+}
+
+/*! \fn     logic_keyboard_typing_routine(void)
+*   \brief  Typing routine, to be called from the main loop: sends at most one report per call and never waits
+*/
+void logic_keyboard_typing_routine(void)
+{
+    logic_keyboard_typing_job_t* job_pt = &logic_keyboard_typing_job;
+    
+    switch (job_pt->state)
+    {
+        case TYPING_JOB_SEND_REPORT:
+        {
+            logic_keyboard_send_next_job_report();
+            break;
+        }
+        case TYPING_JOB_WAIT_REPORT_SENT:
+        {
+            BOOL report_sent;
+            
+            /* Check for report sent or link lost */
+            if ((hid_interface_te)job_pt->message.interface_identifier == USB_INTERFACE)
+            {
+                if ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100))
+                {
+                    logic_keyboard_usb_report_being_sent = FALSE;
+                    logic_keyboard_end_typing_job(FALSE);
+                    break;
+                }
+                report_sent = (logic_keyboard_usb_report_being_sent == FALSE)? TRUE : FALSE;
+            }
+            else
+            {
+                if (logic_bluetooth_can_talk_to_host() == FALSE)
+                {
+                    logic_keyboard_end_typing_job(FALSE);
+                    break;
+                }
+                report_sent = logic_bluetooth_is_keyboard_report_sent();
+            }
+            
+            if (report_sent == FALSE)
+            {
+                /* Timeout? */
+                if (timer_has_timer_expired(TIMER_KEYBOARD_TYPING, FALSE) == TIMER_EXPIRED)
+                {
+                    logic_keyboard_usb_report_being_sent = FALSE;
+                    logic_keyboard_end_typing_job(FALSE);
+                }
+                break;
+            }
+            
+            /* Let the main MCU know we're still typing */
+            if ((++job_pt->nb_reports_sent % LOGIC_KEYBOARD_PROGRESS_NB_REPORTS) == 0)
+            {
+                aux_mcu_message_t* temp_tx_message_pt;
+                comms_main_mcu_get_empty_tx_slot(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT);
+                temp_tx_message_pt->aux_mcu_event_message.event_id = AUX_MCU_EVENT_TYPING_PROGRESS;
+                temp_tx_message_pt->aux_mcu_event_message.payload_as_uint16[0] = job_pt->symbol_index;
+                temp_tx_message_pt->payload_length1 = sizeof(temp_tx_message_pt->aux_mcu_event_message.event_id) + sizeof(uint16_t);
+                comms_main_mcu_send_message((void*)temp_tx_message_pt, (uint16_t)sizeof(aux_mcu_message_t));
+            }
+            
+            /* Delay before next report */
+            if (job_pt->message.delay_between_types == 0)
+            {
+                job_pt->state = TYPING_JOB_SEND_REPORT;
+            }
+            else
+            {
+                timer_start_timer(TIMER_KEYBOARD_TYPING, job_pt->message.delay_between_types);
+                job_pt->state = TYPING_JOB_WAIT_DELAY;
+            }
+            break;
+        }
+        case TYPING_JOB_WAIT_DELAY:
+        {
+            if (timer_has_timer_expired(TIMER_KEYBOARD_TYPING, FALSE) == TIMER_EXPIRED)
+            {
+                job_pt->state = TYPING_JOB_SEND_REPORT;
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+/*! \fn     logic_keyboard_usb_report_sent_callback(void)
+*   \brief  Function called when a keyboard report was fetched by the USB host
+*/
+void logic_keyboard_usb_report_sent_callback(void)
+{
+    logic_keyboard_usb_report_being_sent = FALSE;
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+/*!  \file     logic_keyboard_sequencer.c
+*    \brief    Keyboard symbols -> keyboard reports, shared with host tests
+*    \note     Hosts type the keys appearing in a report in key slot order: keys typed in a row with the same modifier are
+*              pressed together in one report, in typing order, then released together by the next one.
+*              No dependency on the platform so that it can be linked by host tests.
+*/
+#include <string.h>
+#include "logic_keyboard_sequencer.h"
+
+
+/*! \fn     logic_keyboard_symbol_to_keystroke(uint8_t symbol, logic_keyboard_keystroke_t* keystroke)
+*   \brief  Convert an encoded symbol into a HID key and modifier
+*   \param  symbol      The symbol
+*   \param  keystroke   Where to store the key and modifier
+*   \note   Doesn't access any peripheral
+*/
+void logic_keyboard_symbol_to_keystroke(uint8_t symbol, logic_keyboard_keystroke_t* keystroke)
+{
+    uint8_t masked_key = symbol & (SHIFT_MASK|ALTGR_MASK);
+    
+    keystroke->is_dead_key = FALSE;
+    if ((symbol & 0x3F) == KEY_EUROPE_2)
+    {
+        // Because of a redefine of KEY_EUROPE_2 for storage purposes we need to do that
+        keystroke->key = KEY_EUROPE_2_REAL;
+        keystroke->modifier = 0;
+        
+        if (masked_key == (SHIFT_MASK|ALTGR_MASK))
+        {
+            keystroke->modifier = KEY_SHIFT|KEY_RIGHT_ALT;
+        }
+        else if (masked_key == SHIFT_MASK)
+        {
+            keystroke->modifier = KEY_SHIFT;
+        }
+        else if (masked_key == ALTGR_MASK)
+        {
+            keystroke->modifier = KEY_RIGHT_ALT;
+        }
+    }
+    else if (masked_key == (SHIFT_MASK|ALTGR_MASK))
+    {
+        keystroke->key = symbol & ~(SHIFT_MASK|ALTGR_MASK);
+        keystroke->modifier = KEY_SHIFT|KEY_RIGHT_ALT;
+    }
+    else if (masked_key == SHIFT_MASK)
+    {
+        // If we need shift
+        keystroke->key = symbol & ~SHIFT_MASK;
+        keystroke->modifier = KEY_SHIFT;
+    }
+    else if (masked_key == ALTGR_MASK)
+    {
+        // We need altgr for the numbered keys, only possible because we don't use the numerical keypad
+        keystroke->key = symbol & ~ALTGR_MASK;
+        keystroke->modifier = KEY_RIGHT_ALT;
+    }
+    else
+    {
+        keystroke->key = symbol;
+        keystroke->modifier = 0;
+    }
+}
+
+/*! \fn     logic_keyboard_symbol_to_keystrokes(uint16_t symbol, logic_keyboard_keystroke_t* keystrokes)
+*   \brief  Convert a symbol sent by the main MCU into the keystrokes required to type it
+*   \param  symbol      The symbol, as sent in a keyboard type message
+*   \param  keystrokes  Where to store the keystrokes, 2 entries needed
+*   \return Number of keystrokes (0 to 2)
+*   \note   Doesn't access any peripheral
+*/
+uint16_t logic_keyboard_symbol_to_keystrokes(uint16_t symbol, logic_keyboard_keystroke_t* keystrokes)
+{
+    if (symbol == 0xFFFF)
+    {
+        /* Original unicode point can't be typed */
+        return 0;
+    }
+    else if ((symbol & 0x7F00) == 0)
+    {
+        /* One key to be typed */
+        logic_keyboard_symbol_to_keystroke((uint8_t)symbol, &keystrokes[0]);
+        
+        /* Dead key: add space */
+        if ((symbol & 0x8000) != 0)
+        {
+            keystrokes[0].is_dead_key = TRUE;
+            logic_keyboard_symbol_to_keystroke(KEY_SPACE, &keystrokes[1]);
+            return 2;
+        }
+        return 1;
+    }
+    else
+    {
+        /* Two keys to be typed */
+        logic_keyboard_symbol_to_keystroke((uint8_t)(symbol >> 8), &keystrokes[0]);
+        logic_keyboard_symbol_to_keystroke((uint8_t)symbol, &keystrokes[1]);
+        return 2;
+    }
+}
+
+/*! \fn     logic_keyboard_plan_report(logic_keyboard_keystroke_t* keystrokes, uint16_t nb_keystrokes, logic_keyboard_report_t* report)
+*   \brief  Plan a group of consecutive keystrokes whose keys can be held down together
+*   \param  keystrokes      Keystrokes to type
+*   \param  nb_keystrokes   Number of keystrokes
+*   \param  report          Where to store the group: common modifier and keys, in typing order
+*   \return Number of keystrokes in the group
+*   \note   Keys of a group use the same modifier and are different. A dead key gets its own group
+*/
+uint16_t logic_keyboard_plan_report(logic_keyboard_keystroke_t* keystrokes, uint16_t nb_keystrokes, logic_keyboard_report_t* report)
+{
+    uint16_t nb_packed = 0;
+    
+    memset(report, 0, sizeof(logic_keyboard_report_t));
+    while ((nb_packed < nb_keystrokes) && (report->nb_keys < LOGIC_KEYBOARD_NB_KEY_SLOTS))
+    {
+        logic_keyboard_keystroke_t* keystroke_pt = &keystrokes[nb_packed];
+        
+        if (nb_packed == 0)
+        {
+            report->modifier = keystroke_pt->modifier;
+        }
+        else
+        {
+            /* Different modifier or dead key: next group */
+            if ((keystroke_pt->modifier != report->modifier) || (keystroke_pt->is_dead_key != FALSE))
+            {
+                break;
+            }
+            
+            /* Same key twice: needs a release in between */
+            if (memchr(report->keys, keystroke_pt->key, report->nb_keys) != NULL)
+            {
+                break;
+            }
+        }
+        
+        /* Add key */
+        report->keys[report->nb_keys++] = keystroke_pt->key;
+        nb_packed++;
+        
+        /* Dead key: the host combines it with the next key, keep it alone */
+        if (keystroke_pt->is_dead_key != FALSE)
+        {
+            break;
+        }
+    }
+    
+    return nb_packed;
+}
+
+/*! \fn     logic_keyboard_sequencer_add_symbol(logic_keyboard_sequencer_t* sequencer, uint16_t symbol)
+*   \brief  Add a symbol to be typed
+*   \param  sequencer   Sequencer, zeroed before the first symbol is added
+*   \param  symbol      The symbol, as sent in a keyboard type message
+*   \return FALSE if there's no room for the symbol keystrokes, to be tried again later
+*/
+BOOL logic_keyboard_sequencer_add_symbol(logic_keyboard_sequencer_t* sequencer, uint16_t symbol)
+{
+    /* A symbol takes up to 2 keystrokes */
+    if (sequencer->nb_keystrokes + 2 > LOGIC_KEYBOARD_KEYSTROKES_BUF_SIZE)
+    {
+        return FALSE;
+    }
+    
+    sequencer->nb_keystrokes += logic_keyboard_symbol_to_keystrokes(symbol, &sequencer->keystrokes[sequencer->nb_keystrokes]);
+    return TRUE;
+}
+
+/*! \fn     logic_keyboard_sequencer_get_next_report(logic_keyboard_sequencer_t* sequencer, logic_keyboard_report_t* report)
+*   \brief  Get the next keyboard report to send: modifier alone, keys of a group pressed or keys release
+*   \param  sequencer       Sequencer
+*   \param  report          Where to store the report
+*   \return FALSE once all the added keystrokes were typed and released
+*   \note   Keys are always released by the report following their press, so they are held for a single report period
+*/
+BOOL logic_keyboard_sequencer_get_next_report(logic_keyboard_sequencer_t* sequencer, logic_keyboard_report_t* report)
+{
+    memset(report, 0, sizeof(logic_keyboard_report_t));
+    
+    if (sequencer->keys_release_pending != FALSE)
+    {
+        /* Release keys, keeping the modifier if the next group uses it */
+        if ((sequencer->nb_keystrokes == 0) || (sequencer->keystrokes[0].modifier != sequencer->held_modifier))
+        {
+            sequencer->held_modifier = 0;
+        }
+        report->modifier = sequencer->held_modifier;
+        sequencer->keys_release_pending = FALSE;
+        return TRUE;
+    }
+    
+    /* All done */
+    if (sequencer->nb_keystrokes == 0)
+    {
+        return FALSE;
+    }
+    
+    /* Plan next group */
+    if (sequencer->group_planned == FALSE)
+    {
+        logic_keyboard_plan_report(sequencer->keystrokes, sequencer->nb_keystrokes, &sequencer->group);
+        sequencer->group_planned = TRUE;
+    }
+    
+    /* Modifier isn't held yet: send it on its own */
+    report->modifier = sequencer->group.modifier;
+    if ((sequencer->group.modifier != 0) && (sequencer->group.modifier != sequencer->held_modifier))
+    {
+        sequencer->held_modifier = sequencer->group.modifier;
+        return TRUE;
+    }
+    
+    /* Press all the keys of the group, in typing order */
+    memcpy(report->keys, sequencer->group.keys, sequencer->group.nb_keys);
+    report->nb_keys = sequencer->group.nb_keys;
+    
+    /* Remove their keystrokes, keys are released next */
+    sequencer->nb_keystrokes -= sequencer->group.nb_keys;
+    memmove(sequencer->keystrokes, &sequencer->keystrokes[sequencer->group.nb_keys], sequencer->nb_keystrokes*sizeof(logic_keyboard_keystroke_t));
+    sequencer->keys_release_pending = TRUE;
+    sequencer->group_planned = FALSE;
+    return TRUE;
+}
@@ -35,6 +35,7 @@
 #include "usb_utils.h"
 #include "platform_io.h"
 #include "comms_raw_hid.h"
+#include "logic_keyboard.h"
 #include "usb_descriptors.h"
 #include "platform_defines.h"
 
@@ -461,6 +462,10 @@ void USB_Handler(void)
           comms_raw_hid_send_callback(CTAP_INTERFACE);
           //comms_usb_debug_printf("CTAP Packet Sent\n");
       }
+      else if (i == USB_KEYBOARD_ENDPOINT)
+      {
+          logic_keyboard_usb_report_sent_callback();
+      }
       //udc_send_callback(i);
     }
   }
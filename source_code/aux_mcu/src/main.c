@@ -2,6 +2,7 @@
 #include "platform_defines.h"
 #include "logic_bluetooth.h"
 #include "comms_main_mcu.h"
+#include "logic_keyboard.h"
 #include "logic_battery.h"
 #include "driver_clocks.h"
 #include "comms_raw_hid.h"
@@ -186,6 +187,9 @@ int main(void)
         {
            logic_bluetooth_routine();
         }
+        
+        /* Ongoing typing job */
+        logic_keyboard_typing_routine();
     }
     #endif
     
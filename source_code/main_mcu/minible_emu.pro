@@ -27,7 +27,8 @@ INCLUDEPATH += src/EMU \
     src/NODEMGMT \
     src/RNG \
     src/BearSSL/src \
-    src/BearSSL/inc
+    src/BearSSL/inc \
+    ../aux_mcu/src/COMMS
 
 SOURCES += src/EMU/lis2hh12.c \
     src/BearSSL/src/symcipher/aes_ct.c \
@@ -64,6 +65,7 @@ SOURCES += src/EMU/lis2hh12.c \
     src/BearSSL/src/codec/dec32be.c \
     src/BearSSL/src/codec/enc32be.c \
     src/COMMS/comms_aux_mcu.c \
+    ../aux_mcu/src/COMMS/comms_hid_framing.c \
     src/COMMS/comms_hid_msgs.c \
     src/COMMS/comms_hid_msgs_debug.c \
     src/EMU/dma.c \
@@ -71,7 +73,9 @@ SOURCES += src/EMU/lis2hh12.c \
     src/FILESYSTEM/custom_fs.c \
     src/FILESYSTEM/custom_fs_emergency_font.c \
     src/EMU/dataflash.c \
+    src/EMU/emu_crc32.c \
     src/EMU/dbflash.c \
+    src/FLASH/flash_stats.c \
     src/GUI/gui_carousel.c \
     src/GUI/gui_dispatcher.c \
     src/GUI/gui_menu.c \
@@ -106,6 +110,7 @@ SOURCES += src/EMU/lis2hh12.c \
     src/EMU/emu_oled.cpp \
     src/EMU/emu_smartcard.cpp \
     src/EMU/emu_storage.cpp \
+    src/EMU/emu_script.cpp \
     src/EMU/emulator_ui.cpp
 
 QMAKE_CXXFLAGS += -fdata-sections \
@@ -154,13 +159,16 @@ HEADERS  += src/MainWindow.h \ \
     src/COMMS/comms_aux_mcu.h \
     src/COMMS/comms_aux_mcu_defines.h \
     src/COMMS/comms_bootloader_msg.h \
+    ../aux_mcu/src/COMMS/comms_hid_framing.h \
     src/COMMS/comms_hid_msgs.h \
     src/COMMS/comms_hid_msgs_debug.h \
     src/EMU/asf.h \
     src/EMU/emu_aux_mcu.h \
+    src/EMU/emu_crc32.h \
     src/EMU/emu_oled.h \
     src/EMU/emu_smartcard.h \
     src/EMU/emu_storage.h \
+    src/EMU/emu_script.h \
     src/EMU/emulator.h \
     src/EMU/emulator_ui.h \
     src/EMU/qt_metacall_helper.h \
@@ -580,6 +580,11 @@ void comms_aux_mcu_deal_with_received_event(aux_mcu_message_t* received_message)
             logic_device_set_usb_timeout_detected();
             break;
         }
+        case AUX_MCU_EVENT_TYPING_PROGRESS:
+        {
+            /* Aux MCU is still typing, typing status comes with the keyboard type answer */
+            break;
+        }
         default: 
         {
             /* Flag invalid message */
@@ -751,7 +756,7 @@ void comms_aux_mcu_prepare_for_active_rx_packet_receive(void)
 comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_type)
 {    
 #ifdef EMULATOR_BUILD
-    DELAYMS(1);
+    emu_idle_wait();
 #endif
 
     /* Comms disabled? */
@@ -91,6 +91,7 @@
 #define AUX_MCU_EVENT_NEW_STATUS_RCVD       0x0014
 #define AUX_MCU_EVENT_CHARGE_STOPPED        0x0015
 #define AUX_MCU_EVENT_NEW_BATTERY_LVL_RCVD  0x0016
+#define AUX_MCU_EVENT_TYPING_PROGRESS       0x0017
 
 // BLE commands
 #define BLE_MESSAGE_CMD_ENABLE              0x0001
@@ -97,10 +97,15 @@
 #define HID_CMD_GET_CPZ_LUT_ENTRY   0x010E
 #define HID_CMD_GET_FAVORITES       0x010F
 #define HID_CMD_CHANGE_NODE_PWD     0x0110
+#define HID_CMD_READ_NODES          0x0111
+#define HID_CMD_WRITE_NODES         0x0112
 // Define used to identify commands
 #define HID_FIRST_CMD_FOR_MMM       HID_CMD_GET_START_PARENTS
 #define HID_LAST_CMD_FOR_MMM        0x0200
 
+// Max number of nodes processed by a single read / write nodes command (one bit each in the failed nodes bitmask)
+#define HID_NODES_BATCH_MAX_NB_NODES    16
+
 /* Typedefs */
 typedef struct
 {
@@ -204,6 +209,33 @@ typedef struct
     uint16_t last_chunk_flag;
 } hid_message_store_data_into_file_t;
 
+typedef struct
+{
+    uint16_t follow_next_pointers;
+    uint16_t node_addresses[0];
+} hid_message_read_nodes_req_t;
+
+typedef struct
+{
+    uint16_t node_address;
+    uint16_t node_size;
+    uint16_t node_data_length;
+    uint8_t node_data[0];
+} hid_message_write_nodes_entry_t;
+
+typedef struct
+{
+    uint16_t node_data_length;
+    uint8_t node_data[0];
+} hid_message_nodes_batch_answer_entry_t;
+
+typedef struct
+{
+    uint16_t nb_nodes_processed;
+    uint16_t failed_nodes_bitmask;
+    uint8_t nodes_data[0];
+} hid_message_nodes_batch_answer_t;
+
 typedef struct
 {
     uint16_t message_type;
@@ -220,6 +252,8 @@ typedef struct
         hid_message_store_TOTP_cred_t store_TOTP_credential;
         hid_message_check_cred_req_t check_credential;
         hid_message_get_battery_status_t battery_status;
+        hid_message_read_nodes_req_t read_nodes_request;
+        hid_message_nodes_batch_answer_t nodes_batch_answer;
         hid_message_get_cred_req_t get_credential_request;
         hid_message_change_node_pwd_t change_node_password;
         hid_message_get_cred_answer_t get_credential_answer;
@@ -21,6 +21,7 @@
 */
 #include <asf.h>
 #include <string.h>
+#include <stddef.h>
 #include "smartcard_highlevel.h"
 #include "logic_encryption.h"
 #include "logic_smartcard.h"
@@ -577,6 +578,7 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             {
                 /* Store new address */
                 nodemgmt_set_cred_start_address(rcv_msg->payload_as_uint16[1], rcv_msg->payload_as_uint16[0]);
+                nodemgmt_service_index_invalidate();
 
                 /* Set success byte */
                 comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, TRUE);
@@ -597,6 +599,7 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             {
                 /* Store new address */
                 nodemgmt_set_data_start_address(rcv_msg->payload_as_uint16[1], rcv_msg->payload_as_uint16[0]);
+                nodemgmt_service_index_invalidate();
 
                 /* Set success byte */
                 comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, TRUE);
@@ -617,6 +620,7 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             {
                 /* Store new addresses */
                 nodemgmt_set_start_addresses(rcv_msg->payload_as_uint16);
+                nodemgmt_service_index_invalidate();
 
                 /* Set success byte */
                 comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, TRUE);
@@ -795,6 +799,7 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             {
                 /* big node */
                 nodemgmt_write_child_node_block_to_flash(rcv_msg->payload_as_uint16[0], (child_node_t*)&(rcv_msg->payload_as_uint16[1]), FALSE);
+                nodemgmt_service_index_invalidate();
 
                 /* Set success byte */
                 comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, TRUE);
@@ -805,6 +810,7 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             {
                 /* small node */
                 nodemgmt_write_parent_node_data_block_to_flash(rcv_msg->payload_as_uint16[0], (parent_node_t*)&(rcv_msg->payload_as_uint16[1]));
+                nodemgmt_service_index_invalidate();
 
                 /* Set success byte */
                 comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, TRUE);
@@ -818,6 +824,157 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             }
         }
 
+        case HID_CMD_READ_NODES:
+        {
+            uint16_t nb_addresses = (rcv_msg->payload_length - sizeof(uint16_t)) / sizeof(uint16_t);
+            
+            /* Check for at least one address, only one when following next pointers */
+            if ((rcv_msg->payload_length < 2*sizeof(uint16_t)) || ((rcv_msg->payload_length % sizeof(uint16_t)) != 0) || ((rcv_msg->read_nodes_request.follow_next_pointers != FALSE) && (nb_addresses != 1)))
+            {
+                /* Set nack, leave same command id */
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            /* Prepare answer */
+            aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, 0);
+            hid_message_nodes_batch_answer_t* answer_pt = &(temp_tx_message_pt->hid_message.nodes_batch_answer);
+            uint16_t next_node_addr = rcv_msg->read_nodes_request.node_addresses[0];
+            uint16_t answer_length = sizeof(hid_message_nodes_batch_answer_t);
+            answer_pt->failed_nodes_bitmask = 0;
+            answer_pt->nb_nodes_processed = 0;
+            
+            /* Pack as many nodes as we can */
+            while ((next_node_addr != NODE_ADDR_NULL) && (answer_pt->nb_nodes_processed < HID_NODES_BATCH_MAX_NB_NODES))
+            {
+                uint16_t node_addr = next_node_addr;
+                node_type_te temp_node_type;
+                next_node_addr = NODE_ADDR_NULL;
+                
+                /* Check address & user permission */
+                if ((nodemgmt_check_address_validity(node_addr) == RETURN_OK) && (nodemgmt_check_user_permission(node_addr, &temp_node_type) == RETURN_OK))
+                {
+                    hid_message_nodes_batch_answer_entry_t* entry_pt = (hid_message_nodes_batch_answer_entry_t*)&(temp_tx_message_pt->hid_message.payload[answer_length]);
+                    BOOL is_child_node = ((temp_node_type == NODE_TYPE_PARENT) || (temp_node_type == NODE_TYPE_PARENT_DATA) || (temp_node_type == NODE_TYPE_NULL)) ? FALSE : TRUE;
+                    
+                    /* Enough space left for the entry header? */
+                    if (answer_length + sizeof(hid_message_nodes_batch_answer_entry_t) > max_payload_size)
+                    {
+                        break;
+                    }
+                    
+                    /* Read node without its trailing zeros: most parent nodes only take a few tens of bytes */
+                    uint16_t space_left = max_payload_size - answer_length - sizeof(hid_message_nodes_batch_answer_entry_t);
+                    entry_pt->node_data_length = nodemgmt_read_node_data_block_without_trailing_zeros(node_addr, is_child_node, entry_pt->node_data, space_left);
+                    if (entry_pt->node_data_length > space_left)
+                    {
+                        break;
+                    }
+                    answer_length += sizeof(hid_message_nodes_batch_answer_entry_t) + entry_pt->node_data_length;
+                    
+                    /* Only follow valid nodes, a trimmed next address field is NODE_ADDR_NULL */
+                    uint16_t next_addr_offset = (temp_node_type == NODE_TYPE_DATA) ? offsetof(child_data_node_t, nextDataAddress) : offsetof(parent_cred_node_t, nextParentAddress);
+                    if ((temp_node_type != NODE_TYPE_NULL) && (entry_pt->node_data_length >= next_addr_offset + sizeof(uint16_t)))
+                    {
+                        next_node_addr = *(uint16_t*)&(entry_pt->node_data[next_addr_offset]);
+                    }
+                }
+                else
+                {
+                    /* Flag failure, no node data */
+                    answer_pt->failed_nodes_bitmask |= (1 << answer_pt->nb_nodes_processed);
+                }
+                
+                /* Move on to the next provided address if we're not following pointers */
+                answer_pt->nb_nodes_processed++;
+                if (rcv_msg->read_nodes_request.follow_next_pointers == FALSE)
+                {
+                    next_node_addr = (answer_pt->nb_nodes_processed < nb_addresses) ? rcv_msg->read_nodes_request.node_addresses[answer_pt->nb_nodes_processed] : NODE_ADDR_NULL;
+                }
+            }
+            
+            /* Send answer */
+            comms_hid_msgs_update_message_payload_length_fields(temp_tx_message_pt, answer_length);
+            comms_aux_mcu_send_message(temp_tx_message_pt);
+            return;
+        }
+
+        case HID_CMD_WRITE_NODES:
+        {
+            uint16_t nb_nodes_in_payload = 0;
+            uint16_t payload_offset = 0;
+            
+            /* First pass: check the layout of the whole payload before writing anything */
+            while ((payload_offset < rcv_msg->payload_length) && (nb_nodes_in_payload < HID_NODES_BATCH_MAX_NB_NODES))
+            {
+                hid_message_write_nodes_entry_t* entry_pt = (hid_message_write_nodes_entry_t*)&(rcv_msg->payload[payload_offset]);
+                
+                /* Entry header and data must fit in the payload, node data is sent without its trailing zeros and keeps the next entry aligned */
+                if ((payload_offset + sizeof(hid_message_write_nodes_entry_t) > rcv_msg->payload_length) || ((entry_pt->node_size != sizeof(parent_node_t)) && (entry_pt->node_size != sizeof(child_node_t))) || (entry_pt->node_data_length > entry_pt->node_size) || ((entry_pt->node_data_length % sizeof(uint16_t)) != 0) || (payload_offset + sizeof(hid_message_write_nodes_entry_t) + entry_pt->node_data_length > rcv_msg->payload_length))
+                {
+                    break;
+                }
+                
+                payload_offset += sizeof(hid_message_write_nodes_entry_t) + entry_pt->node_data_length;
+                nb_nodes_in_payload++;
+            }
+            
+            /* Malformed or empty payload */
+            if ((nb_nodes_in_payload == 0) || (payload_offset != rcv_msg->payload_length))
+            {
+                /* Set failure byte */
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            /* Second pass: check permissions & write nodes */
+            uint16_t failed_nodes_bitmask = 0;
+            payload_offset = 0;
+            for (uint16_t i = 0; i < nb_nodes_in_payload; i++)
+            {
+                hid_message_write_nodes_entry_t* entry_pt = (hid_message_write_nodes_entry_t*)&(rcv_msg->payload[payload_offset]);
+                node_type_te temp_node_type_te;
+                
+                if (entry_pt->node_size == sizeof(child_node_t))
+                {
+                    /* Big node */
+                    if ((nodemgmt_check_address_validity(entry_pt->node_address) == RETURN_OK) \
+                        && (nodemgmt_check_address_validity(nodemgmt_get_incremented_address(entry_pt->node_address)) == RETURN_OK) \
+                        && (nodemgmt_check_user_permission(entry_pt->node_address, &temp_node_type_te) == RETURN_OK) \
+                        && (nodemgmt_check_user_permission(nodemgmt_get_incremented_address(entry_pt->node_address), &temp_node_type_te) == RETURN_OK))
+                    {
+                        nodemgmt_write_node_data_block_with_trailing_zeros(entry_pt->node_address, TRUE, entry_pt->node_data, entry_pt->node_data_length);
+                    }
+                    else
+                    {
+                        failed_nodes_bitmask |= (1 << i);
+                    }
+                }
+                else
+                {
+                    /* Small node */
+                    if ((nodemgmt_check_address_validity(entry_pt->node_address) == RETURN_OK) && (nodemgmt_check_user_permission(entry_pt->node_address, &temp_node_type_te) == RETURN_OK))
+                    {
+                        nodemgmt_write_node_data_block_with_trailing_zeros(entry_pt->node_address, FALSE, entry_pt->node_data, entry_pt->node_data_length);
+                    }
+                    else
+                    {
+                        failed_nodes_bitmask |= (1 << i);
+                    }
+                }
+                
+                payload_offset += sizeof(hid_message_write_nodes_entry_t) + entry_pt->node_data_length;
+            }
+            nodemgmt_service_index_invalidate();
+            
+            /* Report per node status */
+            aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, sizeof(hid_message_nodes_batch_answer_t));
+            temp_tx_message_pt->hid_message.nodes_batch_answer.nb_nodes_processed = nb_nodes_in_payload;
+            temp_tx_message_pt->hid_message.nodes_batch_answer.failed_nodes_bitmask = failed_nodes_bitmask;
+            comms_aux_mcu_send_message(temp_tx_message_pt);
+            return;
+        }
+
         case HID_CMD_GET_USER_CHANGE_NB :
         {
             /* Smartcard unlocked? */
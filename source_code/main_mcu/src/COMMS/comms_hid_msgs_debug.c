@@ -33,12 +33,16 @@
 #include "driver_timer.h"
 #include "platform_io.h"
 #include "logic_power.h"
+#include "flash_stats.h"
 #include "dataflash.h"
+#include "utils.h"
 #include "sh1122.h"
 #include "main.h"
 #include "dma.h"
 /* Variable to know if we're allowing bundle upload */
 BOOL comms_hid_msgs_debug_upload_allowed = FALSE;
+/* Streamed dataflash upload state */
+comms_hid_msgs_debug_stream_t comms_hid_msgs_debug_stream;
 
 
 #ifdef DEBUG_USB_PRINTF_ENABLED
@@ -84,6 +88,21 @@ void comms_hid_msgs_debug_printf(const char *fmt, ...)
 #pragma GCC diagnostic pop
 #endif
 
+/*! \fn     comms_hid_msgs_debug_send_stream_status(BOOL is_message_from_usb, uint16_t message_type, BOOL in_sync)
+*   \brief  Send the streamed upload status: next expected address and whether we're still in sync
+*   \param  is_message_from_usb     TRUE if message is from USB
+*   \param  message_type            Message type to use for the answer
+*   \param  in_sync                 FALSE to ask the host to resume from the next expected address
+*/
+static void comms_hid_msgs_debug_send_stream_status(BOOL is_message_from_usb, uint16_t message_type, BOOL in_sync)
+{
+    aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, message_type, sizeof(uint32_t) + sizeof(uint16_t));
+    temp_tx_message_pt->hid_message.payload_as_uint32[0] = comms_hid_msgs_debug_stream.next_address;
+    temp_tx_message_pt->hid_message.payload_as_uint16[2] = (uint16_t)in_sync;
+    comms_aux_mcu_send_message(temp_tx_message_pt);
+    comms_hid_msgs_debug_stream.nb_chunks_since_ack = 0;
+}
+
 /*! \fn     comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payload_length, msg_restrict_type_te answer_restrict_type, BOOL is_message_from_usb)
 *   \brief  Parse an incoming message from USB or BLE
 *   \param  rcv_msg                 Received message
@@ -219,6 +238,9 @@ void comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payloa
         {        
             if (comms_hid_msgs_debug_upload_allowed != FALSE)
             {
+                /* Last streamed page may still be programming */
+                dataflash_wait_for_not_busy(&dataflash_descriptor);
+                
                 /* Do required actions */
                 logic_device_bundle_update_end(TRUE);
                 
@@ -239,6 +261,130 @@ void comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payloa
                 return;
             }                
         }
+        case HID_CMD_ID_DATAFLASH_STREAM_START:
+        {
+            /* Payload: start address, ack interval in chunks, erase 4kB sectors as we go */
+            uint32_t start_address = rcv_msg->payload_as_uint32[0];
+            uint16_t ack_interval = rcv_msg->payload_as_uint16[2];
+            uint16_t erase_sectors = rcv_msg->payload_as_uint16[3];
+            
+            /* Sanity checks */
+            if ((rcv_msg->payload_length != sizeof(uint32_t) + 2*sizeof(uint16_t)) || (start_address >= W25Q16_FLASH_SIZE) || ((start_address & (W25Q16_PAGE_SIZE-1)) != 0) || ((erase_sectors != 0) && ((start_address & (W25Q16_SECTOR_SIZE-1)) != 0)))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            /* Required actions when we start dealing with graphics memory, only done once per upload */
+            if ((comms_hid_msgs_debug_upload_allowed == FALSE) && (logic_device_bundle_update_start(TRUE) != RETURN_OK))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            comms_hid_msgs_debug_upload_allowed = TRUE;
+            
+            /* Setup stream state */
+            comms_hid_msgs_debug_stream.next_address = start_address;
+            comms_hid_msgs_debug_stream.ack_interval = (ack_interval == 0)? 1 : ack_interval;
+            comms_hid_msgs_debug_stream.erase_sectors = (erase_sectors != 0)? TRUE : FALSE;
+            comms_hid_msgs_debug_stream.nb_chunks_since_ack = 0;
+            comms_hid_msgs_debug_stream.resync_requested = FALSE;
+            
+            /* Set ack, leave same command id */
+            comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, TRUE);
+            return;
+        }
+        case HID_CMD_ID_DATAFLASH_STREAM_WRITE:
+        {
+            /* First 4 bytes is the write address, then up to 256 bytes that must stay within a page */
+            uint32_t write_address = rcv_msg->payload_as_uint32[0];
+            uint16_t nb_bytes = rcv_msg->payload_length - sizeof(uint32_t);
+            
+            /* Sanity checks */
+            if ((comms_hid_msgs_debug_upload_allowed == FALSE) || (rcv_msg->payload_length <= sizeof(uint32_t)) || (nb_bytes > W25Q16_PAGE_SIZE) || (write_address >= W25Q16_FLASH_SIZE) || ((write_address & (W25Q16_PAGE_SIZE-1)) + nb_bytes > W25Q16_PAGE_SIZE))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            /* Out of sequence chunk (previous one lost): ask the host to resume once, then drop chunks until the expected one arrives */
+            if (write_address != comms_hid_msgs_debug_stream.next_address)
+            {
+                if (comms_hid_msgs_debug_stream.resync_requested == FALSE)
+                {
+                    comms_hid_msgs_debug_stream.resync_requested = TRUE;
+                    comms_hid_msgs_debug_send_stream_status(is_message_from_usb, rcv_message_type, FALSE);
+                }
+                return;
+            }
+            comms_hid_msgs_debug_stream.resync_requested = FALSE;
+            
+            /* Previous page program should be done by now, as it overlapped with this chunk reception */
+            dataflash_wait_for_not_busy(&dataflash_descriptor);
+            
+            /* Erase sectors as we enter them */
+            if ((comms_hid_msgs_debug_stream.erase_sectors != FALSE) && ((write_address & (W25Q16_SECTOR_SIZE-1)) == 0))
+            {
+                dataflash_erase_4kb_sector(&dataflash_descriptor, write_address);
+                dataflash_wait_for_not_busy(&dataflash_descriptor);
+            }
+            
+            /* Start programming, don't wait for completion */
+            dataflash_write_page_without_wait(&dataflash_descriptor, write_address, &rcv_msg->payload[sizeof(uint32_t)], nb_bytes);
+            comms_hid_msgs_debug_stream.next_address += nb_bytes;
+            
+            /* Cumulative ack */
+            if (++comms_hid_msgs_debug_stream.nb_chunks_since_ack >= comms_hid_msgs_debug_stream.ack_interval)
+            {
+                comms_hid_msgs_debug_send_stream_status(is_message_from_usb, rcv_message_type, TRUE);
+            }
+            return;
+        }
+        case HID_CMD_ID_DATAFLASH_STREAM_SYNC:
+        {
+            if (comms_hid_msgs_debug_upload_allowed == FALSE)
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            /* Everything received so far is programmed once we answer */
+            dataflash_wait_for_not_busy(&dataflash_descriptor);
+            comms_hid_msgs_debug_stream.resync_requested = FALSE;
+            comms_hid_msgs_debug_send_stream_status(is_message_from_usb, rcv_message_type, TRUE);
+            return;
+        }
+        case HID_CMD_ID_DATAFLASH_SECTOR_CRCS:
+        {
+            /* Payload: first sector address, number of sectors */
+            uint32_t sector_address = rcv_msg->payload_as_uint32[0];
+            uint16_t nb_sectors = rcv_msg->payload_as_uint16[2];
+            uint8_t read_buffer[W25Q16_PAGE_SIZE];
+            
+            /* Sanity checks */
+            if ((rcv_msg->payload_length != sizeof(uint32_t) + sizeof(uint16_t)) || ((sector_address & (W25Q16_SECTOR_SIZE-1)) != 0) || (nb_sectors == 0) || (nb_sectors > DATAFLASH_STREAM_MAX_CRCS_PER_MSG) || (sector_address + (uint32_t)nb_sectors*W25Q16_SECTOR_SIZE > W25Q16_FLASH_SIZE))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            /* Software CRC: the DMA CRC engine requires a DMA controller reset */
+            dataflash_wait_for_not_busy(&dataflash_descriptor);
+            aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, nb_sectors*sizeof(uint32_t));
+            for (uint16_t i = 0; i < nb_sectors; i++)
+            {
+                uint32_t sector_crc = 0;
+                for (uint32_t j = 0; j < W25Q16_SECTOR_SIZE; j += sizeof(read_buffer))
+                {
+                    dataflash_read_data_array(&dataflash_descriptor, sector_address + j, read_buffer, sizeof(read_buffer));
+                    sector_crc = utils_crc32_update(sector_crc, read_buffer, sizeof(read_buffer));
+                }
+                temp_tx_message_pt->hid_message.payload_as_uint32[i] = sector_crc;
+                sector_address += W25Q16_SECTOR_SIZE;
+            }
+            comms_aux_mcu_send_message(temp_tx_message_pt);
+            return;
+        }
         case HID_CMD_ID_SET_OLED_PARAMS:
         {
             /* vcomh change requires oled on / off */
@@ -344,6 +490,24 @@ void comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payloa
             comms_aux_mcu_send_message(temp_tx_message_pt);
             return;          
         }
+#ifdef FLASH_STATS_ENABLED
+        case HID_CMD_ID_GET_FLASH_STATS:
+        {
+            aux_mcu_message_t* temp_tx_message_pt;
+            
+            /* Send the counters for all categories */
+            temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, FLASH_STATS_NB_CATEGORIES*sizeof(flash_stats_counters_t));
+            memcpy((void*)temp_tx_message_pt->hid_message.payload, (void*)flash_stats_get_counters(), FLASH_STATS_NB_CATEGORIES*sizeof(flash_stats_counters_t));
+            comms_aux_mcu_send_message(temp_tx_message_pt);
+            
+            /* Reset them if asked to */
+            if ((rcv_msg->payload_length > 0) && (rcv_msg->payload[0] != 0))
+            {
+                flash_stats_reset();
+            }
+            return;
+        }
+#endif
         case HID_CMD_ID_GET_BATTERY_STATUS:
         {
             aux_mcu_message_t* temp_tx_message_pt;
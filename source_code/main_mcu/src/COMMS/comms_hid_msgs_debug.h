@@ -27,6 +27,16 @@
 #include "comms_hid_defines.h"
 #include "defines.h"
 
+/* Typedefs */
+typedef struct
+{
+    uint32_t next_address;
+    uint16_t ack_interval;
+    uint16_t nb_chunks_since_ack;
+    BOOL erase_sectors;
+    BOOL resync_requested;
+} comms_hid_msgs_debug_stream_t;
+
 /* Prototypes */
 void comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payload_length, msg_restrict_type_te answer_restrict_type, BOOL is_message_from_usb);
 #ifdef DEBUG_USB_PRINTF_ENABLED
@@ -42,5 +42,13 @@
 #define HID_CMD_ID_GET_BATTERY_STATUS       0x800D
 #define HID_CMD_ID_FLASH_AUX_AND_MAIN       0x800E
 #define HID_CMD_ID_GET_TIMESTAMP            0x800F
+#define HID_CMD_ID_GET_FLASH_STATS          0x8010
+#define HID_CMD_ID_DATAFLASH_STREAM_START   0x8011
+#define HID_CMD_ID_DATAFLASH_STREAM_WRITE   0x8012
+#define HID_CMD_ID_DATAFLASH_STREAM_SYNC    0x8013
+#define HID_CMD_ID_DATAFLASH_SECTOR_CRCS    0x8014
+
+// Streamed dataflash upload
+#define DATAFLASH_STREAM_MAX_CRCS_PER_MSG   64
 
 #endif /* COMMS_HID_MSGS_DEBUG_DEFINES_H_ */
\ No newline at end of file
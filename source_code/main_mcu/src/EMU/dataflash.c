@@ -1,12 +1,65 @@
 #include "dataflash.h"
 #include "emu_dataflash.h"
+#include "emu_crc32.h"
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 
 static int bundle_fd = -1;
+/* Copy of the bundle file taken when opening it, NULL when using file accesses.
+ * The file isn't mapped: it may be truncated or rewritten on the host while the emulator runs.
+ */
+static uint8_t* bundle_copy = NULL;
+static uint32_t bundle_copy_size = 0;
+static uint32_t bundle_copy_cursor = 0;
 
-void emu_dataflash_init(const char *path)
+static void emu_dataflash_copy_bundle(void)
+{
+    struct stat bundle_stat;
+    uint32_t copied = 0;
+
+    if((fstat(bundle_fd, &bundle_stat) != 0) || (bundle_stat.st_size == 0))
+        return;
+
+    uint8_t* copy = malloc(bundle_stat.st_size);
+    if(copy == NULL) {
+        fprintf(stderr, "Failed to allocate bundle copy, using file accesses\n");
+        return;
+    }
+
+    lseek(bundle_fd, 0, SEEK_SET);
+    while(copied < (uint32_t)bundle_stat.st_size) {
+        int nb = read(bundle_fd, copy + copied, bundle_stat.st_size - copied);
+        if(nb <= 0)
+            break;
+        copied += nb;
+    }
+
+    if(copied == 0) {
+        free(copy);
+        return;
+    }
+
+    bundle_copy = copy;
+    bundle_copy_size = copied;
+}
+
+/* Copy bundle bytes from the in memory copy, bytes past the end of the bundle are left untouched like a short read() */
+static void emu_dataflash_read_from_copy(uint32_t address, uint8_t* data, uint32_t length)
+{
+    if(address >= bundle_copy_size)
+        return;
+
+    if(length > bundle_copy_size - address)
+        length = bundle_copy_size - address;
+
+    memcpy(data, bundle_copy + address, length);
+}
+
+void emu_dataflash_init(const char *path, BOOL in_memory)
 {
     int i;
     const char *bundle_paths[] = {
@@ -31,8 +84,11 @@ void emu_dataflash_init(const char *path)
 #else
         bundle_fd = open(bundle_paths[i], O_RDONLY);
 #endif
-        if(bundle_fd >= 0)
+        if(bundle_fd >= 0) {
+            if(in_memory)
+                emu_dataflash_copy_bundle();
             return;
+        }
     }
 
     fprintf(stderr, "Failed to open bundle file, tried:\n");
@@ -42,23 +98,65 @@ void emu_dataflash_init(const char *path)
 }
 
 void dataflash_write_array_to_memory(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length){}
+void dataflash_write_page_without_wait(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length){}
 void dataflash_read_data_array(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length) 
 {
+    if(bundle_copy) {
+        emu_dataflash_read_from_copy(address, data, length);
+        return;
+    }
+
     lseek(bundle_fd, address, SEEK_SET);
     read(bundle_fd, data, length);
 }
 
 void dataflash_read_bytes_from_opened_transfer(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length) {
+    if(bundle_copy) {
+        emu_dataflash_read_from_copy(bundle_copy_cursor, data, length);
+        bundle_copy_cursor += length;
+        return;
+    }
+
     read(bundle_fd, data, length);
 }
 
+/* Emulates the DMAC crc32 computed over bytes read from an opened transfer, bytes past the end of the bundle read as erased flash */
+uint32_t emu_dataflash_crc32_from_opened_transfer(uint32_t length)
+{
+    uint8_t buf[4096];
+    uint32_t crc = 0;
+
+    if(bundle_copy && (bundle_copy_cursor < bundle_copy_size)) {
+        uint32_t copied_length = bundle_copy_size - bundle_copy_cursor;
+        if(copied_length > length)
+            copied_length = length;
+
+        crc = emu_crc32_update(crc, bundle_copy + bundle_copy_cursor, copied_length);
+        bundle_copy_cursor += copied_length;
+        length -= copied_length;
+    }
+
+    while(length > 0) {
+        uint32_t chunk = length < sizeof(buf) ? length : sizeof(buf);
+
+        memset(buf, 0xff, chunk);
+        dataflash_read_bytes_from_opened_transfer(NULL, buf, chunk);
+        crc = emu_crc32_update(crc, buf, chunk);
+        length -= chunk;
+    }
+
+    return crc;
+}
+
 void dataflash_send_command(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length){}
 void dataflash_send_single_byte_command(spi_flash_descriptor_t* descriptor_pt, uint8_t command){}
 void dataflash_read_data_array_start(spi_flash_descriptor_t* descriptor_pt, uint32_t address) {
+    bundle_copy_cursor = address;
     lseek(bundle_fd, address, SEEK_SET);
 }
 
 void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t address){}
+void dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address){}
 void dataflash_bulk_erase_without_wait(spi_flash_descriptor_t* descriptor_pt){}
 uint8_t dataflash_read_status_register(spi_flash_descriptor_t* descriptor_pt){return 0;}
 void dataflash_stop_ongoing_transfer(spi_flash_descriptor_t* descriptor_pt){}
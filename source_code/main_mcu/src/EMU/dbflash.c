@@ -1,3 +1,4 @@
+#include "flash_stats.h"
 #include "dbflash.h"
 #include "emu_storage.h"
 
@@ -14,12 +15,16 @@ void dbflash_write_data_pattern_to_flash(spi_flash_descriptor_t* descriptor_pt,
 
 void dbflash_read_data_from_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, void *data)
 {
+    FLASH_STATS_ACCESS_START();
     emu_dbflash_read(pageNumber * BYTES_PER_PAGE + offset, data, dataSize);
+    FLASH_STATS_ACCESS_END(FLASH_STATS_CAT_NODEMGMT, FALSE, dataSize);
 }
 
 void dbflash_write_data_to_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, void *data)
 {
+    FLASH_STATS_ACCESS_START();
     emu_dbflash_write(pageNumber * BYTES_PER_PAGE + offset, data, dataSize);
+    FLASH_STATS_ACCESS_END(FLASH_STATS_CAT_NODEMGMT, TRUE, dataSize);
 }
 
 void dbflash_page_erase(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber)
@@ -36,7 +41,7 @@ RET_TYPE dbflash_check_presence(spi_flash_descriptor_t* descriptor_pt)
 {   
     if(!initialized) {
         initialized = TRUE;
-        emu_dbflash_open();
+        emu_dbflash_open(PAGE_COUNT * BYTES_PER_PAGE);
     }
 
     return RETURN_OK;
@@ -1,9 +1,10 @@
 #include "dma.h"
 #include "emu_aux_mcu.h"
+#include "emu_dataflash.h"
 
 void dma_oled_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint16_t dma_trigger){}
 void dma_acc_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint8_t* read_cmd){}
-uint32_t dma_compute_crc32_from_spi(Sercom* sercom, uint32_t size){return 0;}
+uint32_t dma_compute_crc32_from_spi(Sercom* sercom, uint32_t size){return emu_dataflash_crc32_from_opened_transfer(size);}
 
 void dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size)
 {
@@ -1,5 +1,6 @@
 #include "emu_aux_mcu.h"
 #include "comms_aux_mcu.h"
+#include "comms_hid_framing.h"
 #include "emulator.h"
 
 #include <assert.h>
@@ -267,116 +268,49 @@ int emu_rcv_aux(char *data, int size)
 
 static void send_hid_message(aux_mcu_message_t *msg)
 {
-    uint8_t *payload = msg->payload;
-    int payload_length = msg->payload_length1;
+    hid_framing_fragmentation_t fragmentation;
+    uint8_t hidPacket[HID_FRAMING_PACKET_LENGTH];
+    uint16_t packetLength;
 
-    int n_hid_packets = (payload_length+61) / 62;
-    int p;
-
-    for(p=0;p < n_hid_packets;p++) {
-        char hidPacket[64];
-        int bytesRemain = payload_length - p * 62;
-        if(bytesRemain > 62)
-            bytesRemain = 62;
-
-        hidPacket[0] = bytesRemain;
-        hidPacket[1] = (p<<4) | (n_hid_packets-1);
-        memcpy(hidPacket+2, payload + p * 62, bytesRemain);
-
-        emu_send_hid(hidPacket, bytesRemain+2);
+    comms_hid_framing_start_fragmentation(&fragmentation, msg->payload, msg->payload_length1);
+    while((packetLength = comms_hid_framing_get_next_packet(&fragmentation, hidPacket)) != 0) {
+        emu_send_hid((char*)hidPacket, packetLength);
     }
 }
 
 
 /* Low-level hid packets from moolticute are received into this buffer */
 static uint8_t incomingHidPacket[64];
-
-/* State related to reassembling hid packets into MP messages */
 static int incomingHidFill;
-static BOOL expectFlipBit;
-static uint8_t expectByte1;
 
-/* Mooltipass protocol messages are assembled inside this structure */
-#define INVALID_LENGTH (-1)
+/* Mooltipass protocol messages are reassembled inside this structure, see comms_hid_framing.c (shared with the aux mcu) */
 static aux_mcu_message_t hid_response;
-static int hid_response_fill;
+static hid_framing_reassembly_t hid_reassembly = {.message_buffer = hid_response.payload, .message_buffer_length = AUX_MCU_MSG_PAYLOAD_LENGTH};
 
 static void reset_hid_processing(void) 
 {
     incomingHidFill = 0;
-    hid_response_fill = INVALID_LENGTH;
-    expectFlipBit = FALSE;
-    expectByte1 = 0;
+    comms_hid_framing_reset_reassembly(&hid_reassembly);
 }
 
-/*! \fn     process_hid_packet(void)
-*   \brief  Reassemble HID packets coming from moolticute into Mooltipass protocol messages
-*   \param  packet  pointer to packet bytes
-*   \param  payloadLength  number of *payload* bytes, the packet is two bytes longer than this
-*   \note   This copies the packet data into hid_response
-*   \return TRUE if a message is ready
+/*! \fn     emu_aux_has_pending_rx(void)
+*   \brief  Check if emu_rcv_aux() has something to return without new hid data
+*   \return TRUE if a response or a complete hid packet is waiting
 */
-static BOOL process_hid_packet(uint8_t *packet, int payloadLength)
+BOOL emu_aux_has_pending_rx(void)
 {
-    uint8_t byte0 = packet[0], byte1 = packet[1];
-
-    if(byte0 == 0xff && byte1 == 0xff) {
-        /* To reset the flip bit state machine, the computer may simply send a packet with the first two bytes set to 0xFF.
-         * The device will then expect the next packet to have the flip bit set to 0. */
-        expectFlipBit = FALSE;
-        hid_response_fill = INVALID_LENGTH;
-        return FALSE;
-    }
+    if(response_valid)
+        return TRUE;
 
-    if(((byte0 >> 7) & 1) == expectFlipBit) {
-        /* Prepare to receive a new packet. If there was anything in the buffer, flush it */
-        hid_response_fill = INVALID_LENGTH;
-        expectFlipBit = !expectFlipBit;
+    if((emu_charger_status == LB_CHARGE_START_RAMPING) && (emu_get_battery_level() == 100))
+        return TRUE;
 
-    } else if(hid_response_fill == INVALID_LENGTH) {
-        /* The flip bit hasn't changed, AND incoming buffer is empty. This means that a new
-         * message was sent without changing the flip bit. Not ok */
-        fprintf(stderr, "Incoming HID packet with invalid flip bit\n");
+    if(incomingHidFill < 2)
         return FALSE;
 
-    } else if(expectByte1 != byte1) {
-        /* Byte1 can only have one valid value for packets which don't start a message */
-        fprintf(stderr, "Incoming HID packet with invalid byte1: %x != %x\n", byte1, expectByte1);
-        hid_response_fill = INVALID_LENGTH;
-        return FALSE;
-    }
-
-    if(hid_response_fill == INVALID_LENGTH) {
-        /* Initial packet */
-        memset(&hid_response, 0, sizeof(hid_response));
-
-        /* These are already zero, but let's make it clear what is happening */
-        hid_response.message_type = AUX_MCU_MSG_TYPE_USB;
-        hid_response_fill = 0;
-
-        expectByte1 = byte1;
-    }
-
-    if(payloadLength + hid_response_fill > AUX_MCU_MSG_PAYLOAD_LENGTH) {
-        fprintf(stderr, "Incoming HID packets overflow buffer\n");
-        hid_response_fill = INVALID_LENGTH;
-
-    } else {
-        memcpy(hid_response.payload + hid_response_fill, packet+2, payloadLength);
-        hid_response_fill += payloadLength;
-
-        if(((byte1 & 0xf0) >> 4) == (byte1 & 0x0f)) {
-            /* This was the final packet, the message is ready */
-            hid_response.payload_length1 = hid_response_fill;
-            hid_response_fill = INVALID_LENGTH;
-            return TRUE;
-
-        } else {
-            expectByte1 += 0x10;
-        }
-    }
-
-    return FALSE;
+    /* 0xff 0xff special case and invalid lengths are dealt with right away too */
+    int hidPayloadLength = incomingHidPacket[0] & 63;
+    return ((hidPayloadLength > 62) || (incomingHidFill >= hidPayloadLength+2)) ? TRUE : FALSE;
 }
 
 /*! \fn     rcv_hid_messages(void)
@@ -407,9 +341,14 @@ static int emu_rcv_aux_hid(aux_mcu_message_t *msg)
             return 0;
 
         } else if(incomingHidFill >= hidPayloadLength+2) {
-            hid_response_valid = process_hid_packet(incomingHidPacket, hidPayloadLength);
+            hid_framing_ret_te framing_ret = comms_hid_framing_process_packet(&hid_reassembly, incomingHidPacket, 2 + hidPayloadLength);
+            hid_response_valid = (framing_ret == HID_FRAMING_MESSAGE_COMPLETE);
+
+            if(framing_ret == HID_FRAMING_PACKET_DROPPED) {
+                fprintf(stderr, "Incoming HID packet dropped: %x %x\n", incomingHidPacket[0], incomingHidPacket[1]);
+            }
         
-            if(hid_response_valid && (incomingHidPacket[0] & 0x40)) {
+            if(hid_response_valid && hid_reassembly.ack_requested) {
                 /* send acknowledgement */
                 emu_send_hid((char*)incomingHidPacket, 2 + hidPayloadLength);
             }
@@ -421,6 +360,8 @@ static int emu_rcv_aux_hid(aux_mcu_message_t *msg)
     }
 
     if(hid_response_valid) {
+        hid_response.message_type = AUX_MCU_MSG_TYPE_USB;
+        hid_response.payload_length1 = hid_reassembly.message_length;
         memcpy(msg, &hid_response, sizeof(hid_response));
         hid_response_valid = FALSE;
         return sizeof(hid_response);
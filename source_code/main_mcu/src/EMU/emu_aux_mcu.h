@@ -1,7 +1,9 @@
 #ifndef EMU_AUX_MCU_H
 #define EMU_AUX_MCU_H
+#include "defines.h"
 
 void emu_send_aux(char *data, int size);
 int emu_rcv_aux(char *data, int size);
+BOOL emu_aux_has_pending_rx(void);
 
 #endif
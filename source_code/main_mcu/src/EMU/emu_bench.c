@@ -0,0 +1,636 @@
+/* Host side benchmark of the database code (nodemgmt / logic_database)
+ * Links the firmware database sources against a RAM backed dbflash so that runs are
+ * reproducible, and reports time + dbflash accesses per operation as JSON lines:
+ *   make -f Makefile.bench && build/minible_bench [-o results.json] [-i iterations] [-c creds_per_service] [nb_credentials ...]
+ * Sizes that don't fit in the flash are skipped, build with DBFLASH_CHIP=16M or 32M to go past the device 8M flash.
+ */
+#include "logic_database.h"
+#include "logic_encryption.h"
+#include "emu_storage.h"
+#include "emulator.h"
+#include "driver_timer.h"
+#include "custom_fs.h"
+#include "nodemgmt.h"
+#include "dbflash.h"
+#include "utils.h"
+#include "main.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* default logins stored for each service, categories are assigned round robin (1 to NODEMGMT_NB_MAX_CATEGORIES-1) */
+#define BENCH_CREDS_PER_SERVICE     4
+#define BENCH_DEFAULT_ITERATIONS    200
+#define BENCH_USER_ID               0
+
+/* what the firmware globals would be */
+spi_flash_descriptor_t dbflash_descriptor;
+
+/* free slot pointers of the node management context, looked at by the regression check */
+extern nodemgmtHandle_t nodemgmt_current_handle;
+
+/* RAM backed dbflash and its access counters */
+static uint8_t* bench_flash;
+static int bench_flash_size;
+static uint32_t bench_nb_reads;
+static uint32_t bench_nb_writes;
+static uint64_t bench_bytes_read;
+static uint64_t bench_bytes_written;
+
+/* results output */
+static FILE* bench_out;
+
+/* database being benchmarked */
+static uint32_t bench_rng_state;
+static uint32_t bench_creds_per_service = BENCH_CREDS_PER_SERVICE;
+static uint16_t bench_nb_services;
+static uint16_t* bench_service_addrs;
+static cust_char_t (*bench_service_names)[SERVICE_NAME_MAX_LEN];
+
+struct bench_sample_t {
+    uint64_t start_ns;
+    uint32_t start_reads;
+    uint32_t start_writes;
+    uint64_t start_bytes_read;
+};
+
+/* emu_storage replacement */
+BOOL emu_dbflash_open(int size)
+{
+    if(!bench_flash) {
+        bench_flash = malloc(size);
+        bench_flash_size = size;
+        if(!bench_flash) {
+            fprintf(stderr, "bench: can't allocate %d bytes of dbflash\n", size);
+            exit(1);
+        }
+    }
+    memset(bench_flash, 0xff, bench_flash_size);
+    return FALSE;
+}
+
+void emu_dbflash_read(int offset, uint8_t *buf, int length)
+{
+    if(offset < 0 || offset + length > bench_flash_size) {
+        memset(buf, 0xff, length);
+    } else {
+        memcpy(buf, bench_flash + offset, length);
+    }
+    bench_nb_reads++;
+    bench_bytes_read += length;
+}
+
+void emu_dbflash_write(int offset, uint8_t *buf, int length)
+{
+    if(offset >= 0 && offset + length <= bench_flash_size) {
+        memcpy(bench_flash + offset, buf, length);
+    }
+    bench_nb_writes++;
+    bench_bytes_written += length;
+}
+
+/* firmware functions the database code depends on */
+int emu_get_failure_flags(void)
+{
+    return 0;
+}
+
+uint32_t timer_get_timestamp_us(void)
+{
+    /* flash stats aren't reported by the bench, don't add a clock read to every access */
+    return 0;
+}
+
+void main_reboot(void)
+{
+    /* only ever called on a corrupted database or a security check failure */
+    fprintf(stderr, "bench: main_reboot() called, database code hit a sanity check\n");
+    abort();
+}
+
+void logic_encryption_ctr_encrypt(uint8_t* data, uint16_t data_length, uint8_t* ctr_val_used)
+{
+    /* passwords are opaque to the database code, encryption cost isn't measured here */
+    (void)data;
+    (void)data_length;
+    memset(ctr_val_used, 0, MEMBER_SIZE(nodemgmt_profile_main_data_t, current_ctr));
+}
+
+uint8_t custom_fs_get_recommended_layout_for_current_language(void)
+{
+    return 0;
+}
+
+uint32_t custom_fs_get_number_of_keyb_layouts(void)
+{
+    return 0;
+}
+
+uint32_t custom_fs_get_number_of_languages(void)
+{
+    return 0;
+}
+
+uint8_t custom_fs_get_current_language_id(void)
+{
+    return 0;
+}
+
+/* helpers */
+static uint32_t bench_rand(void)
+{
+    /* xorshift32: same database for each run */
+    bench_rng_state ^= bench_rng_state << 13;
+    bench_rng_state ^= bench_rng_state >> 17;
+    bench_rng_state ^= bench_rng_state << 5;
+    return bench_rng_state;
+}
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_to_cust_char(cust_char_t* dst, const char* src, size_t dst_len)
+{
+    size_t i;
+    for(i = 0; (i < dst_len - 1) && (src[i] != 0); i++) {
+        dst[i] = (cust_char_t)src[i];
+    }
+    dst[i] = 0;
+}
+
+static void bench_start(struct bench_sample_t* sample)
+{
+    sample->start_reads = bench_nb_reads;
+    sample->start_writes = bench_nb_writes;
+    sample->start_bytes_read = bench_bytes_read;
+    sample->start_ns = bench_now_ns();
+}
+
+static void bench_report(const char* op, uint32_t nb_creds, uint32_t nb_calls, struct bench_sample_t* sample)
+{
+    uint64_t elapsed_ns = bench_now_ns() - sample->start_ns;
+    uint32_t reads = bench_nb_reads - sample->start_reads;
+    uint32_t writes = bench_nb_writes - sample->start_writes;
+    uint64_t bytes_read = bench_bytes_read - sample->start_bytes_read;
+
+    if(nb_calls == 0) {
+        nb_calls = 1;
+    }
+
+    fprintf(bench_out, "{\"op\":\"%s\",\"credentials\":%" PRIu32 ",\"services\":%u,\"calls\":%" PRIu32 ","
+            "\"ns_per_call\":%.1f,\"flash_reads_per_call\":%.2f,\"flash_bytes_read_per_call\":%.1f,\"flash_writes_per_call\":%.2f}\n",
+            op, nb_creds, bench_nb_services, nb_calls,
+            (double)elapsed_ns / nb_calls, (double)reads / nb_calls, (double)bytes_read / nb_calls, (double)writes / nb_calls);
+    fflush(bench_out);
+}
+
+/* database generation */
+static uint32_t bench_populate(uint32_t nb_creds_requested)
+{
+    cust_char_t login[LOGIN_NAME_MAX_LEN];
+    uint8_t password[MEMBER_SIZE(child_cred_node_t, password)];
+    uint8_t ctr[MEMBER_SIZE(nodemgmt_profile_main_data_t, current_ctr)];
+    uint16_t nb_services = (uint16_t)((nb_creds_requested + bench_creds_per_service - 1) / bench_creds_per_service);
+    uint16_t dummy_sec_flags, dummy_language, dummy_layout, dummy_ble_layout;
+    uint32_t nb_creds = 0;
+    char tmp[SERVICE_NAME_MAX_LEN];
+
+    /* blank flash and a freshly formatted user */
+    emu_dbflash_open(bench_flash_size);
+    nodemgmt_format_user_profile(BENCH_USER_ID, 0, 0, 0, 0);
+    nodemgmt_init_context(BENCH_USER_ID, &dummy_sec_flags, &dummy_language, &dummy_layout, &dummy_ble_layout);
+
+    free(bench_service_addrs);
+    free(bench_service_names);
+    bench_service_addrs = calloc(nb_services, sizeof(*bench_service_addrs));
+    bench_service_names = calloc(nb_services, sizeof(*bench_service_names));
+    bench_nb_services = 0;
+    bench_rng_state = 0x2545F491;
+    memset(password, 0x55, sizeof(password));
+    memset(ctr, 0, sizeof(ctr));
+
+    /* services are added in random order so that the sorted insertion is exercised */
+    for(uint16_t i = 0; i < nb_services; i++) {
+        snprintf(tmp, sizeof(tmp), "%c%c%c%05u.com", 'a' + bench_rand() % 26, 'a' + bench_rand() % 26, 'a' + bench_rand() % 26, i);
+        bench_to_cust_char(bench_service_names[i], tmp, SERVICE_NAME_MAX_LEN);
+        bench_service_addrs[i] = logic_database_add_service(bench_service_names[i], SERVICE_CRED_TYPE, 0);
+        if(bench_service_addrs[i] == NODE_ADDR_NULL) {
+            break;
+        }
+        bench_nb_services++;
+
+        for(uint16_t j = 0; (j < bench_creds_per_service) && (nb_creds < nb_creds_requested); j++) {
+            snprintf(tmp, sizeof(tmp), "user%u@example.org", j);
+            bench_to_cust_char(login, tmp, LOGIN_NAME_MAX_LEN);
+            nodemgmt_set_current_category_id(1 + (nb_creds % (NODEMGMT_NB_MAX_CATEGORIES-1)));
+            if(logic_database_add_credential_for_service(bench_service_addrs[i], login, 0, 0, password, ctr) != RETURN_OK) {
+                goto db_full;
+            }
+            nb_creds++;
+        }
+    }
+
+db_full:
+    nodemgmt_set_current_category_id(0);
+    return nb_creds;
+}
+
+/* benchmarked operations */
+static void bench_search_service(uint32_t nb_creds, uint32_t iterations)
+{
+    struct bench_sample_t sample;
+    cust_char_t name[SERVICE_NAME_MAX_LEN];
+
+    /* exact match of existing services */
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        uint16_t idx = (uint16_t)(i % bench_nb_services);
+        if(logic_database_search_service(bench_service_names[idx], COMPARE_MODE_MATCH, TRUE, 0) != bench_service_addrs[idx]) {
+            fprintf(stderr, "bench: search_service didn't find service %u\n", idx);
+            exit(1);
+        }
+    }
+    bench_report("search_service_match_hit", nb_creds, iterations, &sample);
+
+    /* exact match of services that aren't stored */
+    bench_to_cust_char(name, "zzzz-not-stored.com", SERVICE_NAME_MAX_LEN);
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        logic_database_search_service(name, COMPARE_MODE_MATCH, TRUE, 0);
+    }
+    bench_report("search_service_match_miss", nb_creds, iterations, &sample);
+
+    /* closest service, as used when scrolling through the service list */
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        name[0] = 'a' + (cust_char_t)(i % 26);
+        name[1] = 'm';
+        name[2] = 0;
+        logic_database_search_service(name, COMPARE_MODE_COMPARE, TRUE, 0);
+    }
+    bench_report("search_service_compare", nb_creds, iterations, &sample);
+}
+
+static void bench_find_free_nodes(uint32_t nb_creds, uint32_t iterations)
+{
+    struct bench_sample_t sample;
+    uint16_t parent_addr, child_addr;
+
+    /* a free parent and child slot search, as nodemgmt_scan_node_usage() does after each node creation, from the start of the memory */
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        nodemgmt_find_free_nodes(1, &parent_addr, 1, &child_addr, PAGE_PER_SECTOR, 0);
+    }
+    bench_report("find_free_nodes", nb_creds, iterations, &sample);
+}
+
+static void bench_get_next_2_fletters(uint32_t nb_creds, uint32_t iterations)
+{
+    struct bench_sample_t sample;
+    cust_char_t fletters[2];
+    uint32_t nb_calls = 0;
+
+    /* go through all the first letters of the service list as the login selection screen does, the list wraps over */
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        uint16_t start_addr = nodemgmt_get_starting_parent_addr_for_category(0);
+        uint16_t addr = start_addr;
+        cust_char_t cur_char;
+        parent_node_t parent;
+
+        if(addr == NODE_ADDR_NULL) {
+            break;
+        }
+        nodemgmt_read_parent_node_data_block_from_flash(addr, &parent);
+        cur_char = parent.cred_parent.service[0];
+
+        do {
+            addr = logic_database_get_next_2_fletters_services(addr, cur_char, fletters, 0);
+            cur_char = fletters[0];
+            nb_calls++;
+        } while((addr != NODE_ADDR_NULL) && (addr != start_addr));
+    }
+    bench_report("get_next_2_fletters_services", nb_creds, nb_calls, &sample);
+}
+
+static void bench_child_iteration(uint32_t nb_creds, uint32_t iterations)
+{
+    struct bench_sample_t sample;
+    uint32_t nb_children = 0;
+    parent_node_t parent;
+
+    /* go through all the children of all parents, once per category */
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        uint16_t category = (uint16_t)(1 + (i % (NODEMGMT_NB_MAX_CATEGORIES-1)));
+        uint16_t parent_addr;
+
+        /* the starting parent is the first one holding logins of the current category */
+        nodemgmt_set_current_category_id(category);
+        parent_addr = nodemgmt_get_starting_parent_addr_for_category(0);
+        while(parent_addr != NODE_ADDR_NULL) {
+            nodemgmt_read_parent_node_data_block_from_flash(parent_addr, &parent);
+            uint16_t child_addr = nodemgmt_check_for_logins_with_category_in_parent_node(parent.cred_parent.nextChildAddress, nodemgmt_get_current_category_flags());
+            while(child_addr != NODE_ADDR_NULL) {
+                nb_children++;
+                child_addr = nodemgmt_get_next_child_node_for_cur_category(child_addr);
+            }
+            parent_addr = parent.cred_parent.nextParentAddress;
+        }
+    }
+    nodemgmt_set_current_category_id(0);
+    bench_report("child_iteration_per_category", nb_creds, iterations, &sample);
+
+    /* each credential belongs to a single category */
+    if(nb_children != nb_creds) {
+        fprintf(stderr, "bench: child iteration found %" PRIu32 " of %" PRIu32 " credentials\n", nb_children, nb_creds);
+        exit(1);
+    }
+}
+
+/* credential deletion is done by the host through node writes in management mode, replay that sequence */
+static void bench_delete_credential(uint16_t parent_addr, uint16_t child_addr)
+{
+    child_node_t child, neighbour;
+    parent_node_t parent;
+
+    nodemgmt_read_child_node_data_block_from_flash(child_addr, &child);
+    uint16_t prev_addr = child.cred_child.prevChildAddress;
+    uint16_t next_addr = child.cred_child.nextChildAddress;
+
+    if(prev_addr == NODE_ADDR_NULL) {
+        nodemgmt_read_parent_node_data_block_from_flash(parent_addr, &parent);
+        parent.cred_parent.nextChildAddress = next_addr;
+        nodemgmt_write_parent_node_data_block_to_flash(parent_addr, &parent);
+    } else {
+        nodemgmt_read_child_node_data_block_from_flash(prev_addr, &neighbour);
+        neighbour.cred_child.nextChildAddress = next_addr;
+        nodemgmt_write_child_node_block_to_flash(prev_addr, &neighbour, FALSE);
+    }
+    if(next_addr != NODE_ADDR_NULL) {
+        nodemgmt_read_child_node_data_block_from_flash(next_addr, &neighbour);
+        neighbour.cred_child.prevChildAddress = prev_addr;
+        nodemgmt_write_child_node_block_to_flash(next_addr, &neighbour, FALSE);
+    }
+
+    memset(&child, 0xff, sizeof(child));
+    nodemgmt_write_child_node_block_to_flash(child_addr, &child, FALSE);
+    nodemgmt_service_index_invalidate();
+}
+
+static void bench_delete_add(uint32_t nb_creds, uint32_t iterations)
+{
+    uint8_t password[MEMBER_SIZE(child_cred_node_t, password)];
+    uint8_t ctr[MEMBER_SIZE(nodemgmt_profile_main_data_t, current_ctr)];
+    struct bench_sample_t sample;
+    cust_char_t login[LOGIN_NAME_MAX_LEN];
+    uint32_t nb_added = 0;
+
+    /* the database may be full: first remove the first login of services spread over the database (7919 is prime, no service is picked twice) */
+    if(iterations > bench_nb_services) {
+        iterations = bench_nb_services;
+    }
+    bench_to_cust_char(login, "user0@example.org", LOGIN_NAME_MAX_LEN);
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        uint16_t idx = (uint16_t)((i * 7919U) % bench_nb_services);
+        uint16_t child_addr = logic_database_search_login_in_service(bench_service_addrs[idx], login, FALSE);
+        if(child_addr == NODE_ADDR_NULL) {
+            fprintf(stderr, "bench: login not found in service %u\n", idx);
+            exit(1);
+        }
+        bench_delete_credential(bench_service_addrs[idx], child_addr);
+    }
+    bench_report("delete_credential", nb_creds, iterations, &sample);
+
+    /* then add them back, the firmware rescans for free nodes after each creation */
+    memset(password, 0xaa, sizeof(password));
+    memset(ctr, 0, sizeof(ctr));
+    nodemgmt_scan_node_usage();
+    nodemgmt_set_current_category_id(1);
+    bench_start(&sample);
+    for(uint32_t i = 0; i < iterations; i++) {
+        uint16_t idx = (uint16_t)((i * 7919U) % bench_nb_services);
+        if(logic_database_add_credential_for_service(bench_service_addrs[idx], login, 0, 0, password, ctr) != RETURN_OK) {
+            break;
+        }
+        nb_added++;
+    }
+    nodemgmt_set_current_category_id(0);
+    bench_report("add_credential", nb_creds, nb_added, &sample);
+
+    /* each deletion freed a child slot pair, even a full database must take all of them back */
+    if(nb_added != iterations) {
+        fprintf(stderr, "bench: only %" PRIu32 " of %" PRIu32 " deleted credentials could be added back\n", nb_added, iterations);
+    }
+}
+
+/* regression check: the parent and child free slot pointers may point to the same slot, only safe as the memory is rescanned after each node creation */
+static void bench_check_shared_free_slot(void)
+{
+    uint8_t password[MEMBER_SIZE(child_cred_node_t, password)];
+    uint8_t ctr[MEMBER_SIZE(nodemgmt_profile_main_data_t, current_ctr)];
+    cust_char_t login[LOGIN_NAME_MAX_LEN];
+    cust_char_t name[SERVICE_NAME_MAX_LEN];
+    char tmp[SERVICE_NAME_MAX_LEN];
+    uint16_t child_addr, service_addr;
+
+    /* fill the memory with logins, then with services until not even a parent node fits */
+    bench_populate(NODEMGMT_FREE_SLOTS_NB_SLOTS);
+    for(uint16_t i = 0; ; i++) {
+        snprintf(tmp, sizeof(tmp), "zzfill%05u.com", i);
+        bench_to_cust_char(name, tmp, SERVICE_NAME_MAX_LEN);
+        if(logic_database_add_service(name, SERVICE_CRED_TYPE, 0) == NODE_ADDR_NULL) {
+            break;
+        }
+    }
+    memset(password, 0xaa, sizeof(password));
+    memset(ctr, 0, sizeof(ctr));
+    bench_to_cust_char(login, "user0@example.org", LOGIN_NAME_MAX_LEN);
+
+    for(uint16_t pass = 0; pass < 2; pass++) {
+        /* deleting a login frees a single child slot, which is the first free slot for both node types */
+        child_addr = logic_database_search_login_in_service(bench_service_addrs[pass], login, FALSE);
+        if(child_addr == NODE_ADDR_NULL) {
+            fprintf(stderr, "bench: free slot check, login not found in service %u\n", pass);
+            exit(1);
+        }
+        bench_delete_credential(bench_service_addrs[pass], child_addr);
+        nodemgmt_scan_node_usage();
+        if((nodemgmt_current_handle.nextParentFreeNode != child_addr) || (nodemgmt_current_handle.nextChildFreeNode != child_addr)) {
+            fprintf(stderr, "bench: free slot check, expected parent and child free slots at 0x%04x, got 0x%04x and 0x%04x\n", child_addr, nodemgmt_current_handle.nextParentFreeNode, nodemgmt_current_handle.nextChildFreeNode);
+            exit(1);
+        }
+
+        if(pass == 0) {
+            /* a child takes the whole slot: no parent may be stored there anymore */
+            nodemgmt_set_current_category_id(1);
+            if(logic_database_add_credential_for_service(bench_service_addrs[pass], login, 0, 0, password, ctr) != RETURN_OK) {
+                fprintf(stderr, "bench: free slot check, login couldn't be added back\n");
+                exit(1);
+            }
+            nodemgmt_set_current_category_id(0);
+            if((nodemgmt_current_handle.nextParentFreeNode != NODE_ADDR_NULL) || (nodemgmt_current_handle.nextChildFreeNode != NODE_ADDR_NULL)) {
+                fprintf(stderr, "bench: free slot check, slot 0x%04x still free after a child was stored there\n", child_addr);
+                exit(1);
+            }
+        } else {
+            /* a parent takes the first half of the slot: a child mustn't be stored there anymore, it would overwrite the parent */
+            bench_to_cust_char(name, "zzzshared.com", SERVICE_NAME_MAX_LEN);
+            service_addr = logic_database_add_service(name, SERVICE_CRED_TYPE, 0);
+            if(service_addr != child_addr) {
+                fprintf(stderr, "bench: free slot check, service stored at 0x%04x instead of 0x%04x\n", service_addr, child_addr);
+                exit(1);
+            }
+            if(nodemgmt_current_handle.nextChildFreeNode == child_addr) {
+                fprintf(stderr, "bench: free slot check, child free slot still at 0x%04x after a parent was stored there\n", child_addr);
+                exit(1);
+            }
+            nodemgmt_set_current_category_id(1);
+            if(logic_database_add_credential_for_service(service_addr, login, 0, 0, password, ctr) == RETURN_OK) {
+                fprintf(stderr, "bench: free slot check, a login was stored without a free child slot\n");
+                exit(1);
+            }
+            nodemgmt_set_current_category_id(0);
+            if(logic_database_search_service(name, COMPARE_MODE_MATCH, TRUE, 0) != service_addr) {
+                fprintf(stderr, "bench: free slot check, service stored in the shared slot is lost\n");
+                exit(1);
+            }
+        }
+    }
+}
+
+/* regression check: nodes sent to the host without their trailing zeros must be written back as they were */
+static void bench_check_trimmed_node_round_trip(void)
+{
+    uint8_t trimmed[sizeof(child_node_t)];
+    child_node_t original, written;
+    parent_node_t parent;
+
+    bench_populate(64);
+    for(uint16_t i = 0; i < bench_nb_services; i++) {
+        uint16_t addrs[2] = {bench_service_addrs[i], NODE_ADDR_NULL};
+
+        nodemgmt_read_parent_node_data_block_from_flash(addrs[0], &parent);
+        addrs[1] = parent.cred_parent.nextChildAddress;
+        for(uint16_t j = 0; (j < 2) && (addrs[j] != NODE_ADDR_NULL); j++) {
+            BOOL child_node = (j == 0) ? FALSE : TRUE;
+            uint16_t node_size = (j == 0) ? sizeof(parent_node_t) : sizeof(child_node_t);
+
+            /* read trimmed, erase, write trimmed back */
+            memset(&original, 0, sizeof(original));
+            memset(&written, 0, sizeof(written));
+            nodemgmt_read_child_node_data_block_from_flash(addrs[j], &original);
+            uint16_t length = nodemgmt_read_node_data_block_without_trailing_zeros(addrs[j], child_node, trimmed, sizeof(trimmed));
+            memset(&written, 0xff, sizeof(written));
+            if(child_node != FALSE) {
+                nodemgmt_write_child_node_block_to_flash(addrs[j], &written, FALSE);
+            } else {
+                nodemgmt_write_parent_node_data_block_to_flash(addrs[j], (parent_node_t*)&written);
+            }
+            nodemgmt_write_node_data_block_with_trailing_zeros(addrs[j], child_node, trimmed, length);
+            nodemgmt_read_child_node_data_block_from_flash(addrs[j], &written);
+            if((length >= node_size) || (memcmp(&original, &written, node_size) != 0)) {
+                fprintf(stderr, "bench: trimmed node at 0x%04x (%u of %u bytes) wasn't written back as read\n", addrs[j], length, node_size);
+                exit(1);
+            }
+        }
+    }
+}
+
+static void bench_run(uint32_t nb_creds_requested, uint32_t iterations)
+{
+    struct bench_sample_t sample;
+
+    bench_start(&sample);
+    uint32_t nb_creds = bench_populate(nb_creds_requested);
+
+    /* a full database would be reported again under a bigger size, don't output duplicate rows */
+    if(nb_creds < nb_creds_requested) {
+        fprintf(stderr, "bench: %" PRIu32 " credentials don't fit in the %uM flash (full after %" PRIu32 "), skipped\n", nb_creds_requested, DBFLASH_CHIP, nb_creds);
+        return;
+    }
+    bench_report("populate", nb_creds, 1, &sample);
+    if(bench_nb_services == 0) {
+        return;
+    }
+
+    /* user login: service indexes and parent categories map */
+    uint16_t dummy_sec_flags, dummy_language, dummy_layout, dummy_ble_layout;
+    bench_start(&sample);
+    nodemgmt_init_context(BENCH_USER_ID, &dummy_sec_flags, &dummy_language, &dummy_layout, &dummy_ble_layout);
+    bench_report("init_context", nb_creds, 1, &sample);
+
+    /* first node creation after login: free slots bitmap build and free node scan */
+    bench_start(&sample);
+    nodemgmt_scan_node_usage();
+    bench_report("first_node_usage_scan", nb_creds, 1, &sample);
+
+    bench_search_service(nb_creds, iterations);
+    bench_find_free_nodes(nb_creds, iterations);
+    bench_get_next_2_fletters(nb_creds, (iterations + 19) / 20);
+    bench_child_iteration(nb_creds, NODEMGMT_NB_MAX_CATEGORIES-1);
+    bench_delete_add(nb_creds, iterations);
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+    uint32_t sizes[16];
+    int nb_sizes = 0;
+
+    bench_out = stdout;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+            bench_out = fopen(argv[++i], "w");
+            if(!bench_out) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "-i") && (i + 1 < argc)) {
+            iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-c") && (i + 1 < argc)) {
+            bench_creds_per_service = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if((argv[i][0] >= '0') && (argv[i][0] <= '9') && (nb_sizes < (int)(sizeof(sizes)/sizeof(sizes[0])))) {
+            sizes[nb_sizes++] = (uint32_t)strtoul(argv[i], NULL, 0);
+        } else {
+            fprintf(stderr, "usage: %s [-o output.json] [-i iterations] [-c creds_per_service] [nb_credentials ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* with the default 4 logins per service, 1536 and 1600 credentials are just at and above what the service index can hold (384 services) */
+    /* the device 8M flash is full at about 1700 credentials, the bigger sizes need a 32M build (up to about 7100 credentials) */
+    if(nb_sizes == 0) {
+        sizes[nb_sizes++] = 1000;
+        sizes[nb_sizes++] = 1536;
+        sizes[nb_sizes++] = 1600;
+        sizes[nb_sizes++] = 5000;
+        sizes[nb_sizes++] = 7000;
+    }
+    if(iterations == 0) {
+        iterations = 1;
+    }
+    if(bench_creds_per_service == 0) {
+        bench_creds_per_service = 1;
+    }
+
+    dbflash_check_presence(&dbflash_descriptor);
+    for(int i = 0; i < nb_sizes; i++) {
+        bench_run(sizes[i], iterations);
+    }
+    bench_check_shared_free_slot();
+    bench_check_trimmed_node_round_trip();
+
+    if(bench_out != stdout) {
+        fclose(bench_out);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "emu_crc32.h"
+
+/* reflected IEEE 802.3 polynomial, same as the DMAC CRCPOLY_CRC32 setting */
+#define EMU_CRC32_POLY  0xEDB88320UL
+
+/* slice-by-8 tables, table[0] is the classic bytewise table */
+static uint32_t emu_crc32_tables[8][256];
+static int emu_crc32_tables_ready = 0;
+
+static void emu_crc32_init_tables(void)
+{
+    for(uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for(int j = 0; j < 8; j++)
+            crc = (crc >> 1) ^ ((crc & 1) ? EMU_CRC32_POLY : 0);
+        emu_crc32_tables[0][i] = crc;
+    }
+
+    for(uint32_t i = 0; i < 256; i++) {
+        for(int t = 1; t < 8; t++)
+            emu_crc32_tables[t][i] = (emu_crc32_tables[t-1][i] >> 8) ^ emu_crc32_tables[0][emu_crc32_tables[t-1][i] & 0xff];
+    }
+
+    emu_crc32_tables_ready = 1;
+}
+
+uint32_t emu_crc32_update(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    if(!emu_crc32_tables_ready)
+        emu_crc32_init_tables();
+
+    crc = ~crc;
+
+    /* 8 bytes per iteration, assembled bytewise so it doesn't depend on alignment or endianness */
+    while(length >= 8) {
+        uint32_t lo = crc ^ ((uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+        uint32_t hi = (uint32_t)data[4] | ((uint32_t)data[5] << 8) | ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+        crc = emu_crc32_tables[7][lo & 0xff] ^ emu_crc32_tables[6][(lo >> 8) & 0xff] ^
+              emu_crc32_tables[5][(lo >> 16) & 0xff] ^ emu_crc32_tables[4][lo >> 24] ^
+              emu_crc32_tables[3][hi & 0xff] ^ emu_crc32_tables[2][(hi >> 8) & 0xff] ^
+              emu_crc32_tables[1][(hi >> 16) & 0xff] ^ emu_crc32_tables[0][hi >> 24];
+        data += 8;
+        length -= 8;
+    }
+
+    while(length--)
+        crc = (crc >> 8) ^ emu_crc32_tables[0][(crc ^ *data++) & 0xff];
+
+    return ~crc;
+}
+
+#ifdef EMU_CRC32_STANDALONE
+/* standalone bundle checker for the scripts:
+ * gcc -O2 -DEMU_CRC32_STANDALONE -o emu_crc32 emu_crc32.c && ./emu_crc32 bundle.img */
+#include <stdio.h>
+
+int main(int argc, char **argv)
+{
+    uint8_t header[12];
+    uint8_t buf[65536];
+
+    if(argc != 2) {
+        fprintf(stderr, "usage: %s bundle.img\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if(!f || fread(header, 1, sizeof(header), f) != sizeof(header)) {
+        fprintf(stderr, "Failed to read %s\n", argv[1]);
+        return 2;
+    }
+
+    /* header: magic, total size, crc32 over the bytes that follow up to total size, all little endian */
+    uint32_t total_size = header[4] | (header[5] << 8) | (header[6] << 16) | ((uint32_t)header[7] << 24);
+    uint32_t header_crc = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+    uint32_t remaining = total_size > sizeof(header) ? total_size - sizeof(header) : 0;
+    uint32_t crc = 0;
+
+    while(remaining) {
+        size_t chunk = remaining < sizeof(buf) ? remaining : sizeof(buf);
+        if(fread(buf, 1, chunk, f) != chunk) {
+            fprintf(stderr, "Bundle file shorter than its total size\n");
+            fclose(f);
+            return 1;
+        }
+        crc = emu_crc32_update(crc, buf, chunk);
+        remaining -= chunk;
+    }
+    fclose(f);
+
+    printf("header crc32 0x%08x, computed crc32 0x%08x: %s\n", header_crc, crc, (crc == header_crc) ? "OK" : "MISMATCH");
+    return (crc == header_crc) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,17 @@
+#ifndef EMU_CRC32_H
+#define EMU_CRC32_H
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* crc32 matching the DMAC CRC32 setup used on the device (IEEE 802.3, reflected, 0xffffffff init and final xor)
+ * chain calls by passing the previous result as crc, start with 0 */
+uint32_t emu_crc32_update(uint32_t crc, const uint8_t *data, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,11 +1,14 @@
 #ifndef EMU_DATAFLASH_H
 #define EMU_DATAFLASH_H
+#include "defines.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void emu_dataflash_init(const char *path);
+/* in_memory: read the bundle once when opening it instead of on each access */
+void emu_dataflash_init(const char *path, BOOL in_memory);
+uint32_t emu_dataflash_crc32_from_opened_transfer(uint32_t length);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,280 @@
+/* Host side benchmark and fuzzer of the HID framing shared by the aux mcu and the emulator
+ * (aux_mcu/src/COMMS/comms_hid_framing.c). Reports fragmentation + reassembly throughput per message size,
+ * then runs lossy / chaotic channels and checks that the framing resynchronizes. Results are JSON lines:
+ *   make -f Makefile.bench hid && build/minible_hid_bench [-o results.json] [-n nb_messages] [-s seed]
+ * Exits with 1 if a check failed.
+ */
+#include "comms_hid_framing.h"
+#include "comms_aux_mcu_defines.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#define HID_BENCH_DEFAULT_MESSAGES  200000
+#define HID_BENCH_CANARY            0xA5
+#define HID_BENCH_CANARY_LENGTH     64
+
+/* results output */
+static FILE* bench_out;
+static uint32_t bench_rng_state = 0x1234567;
+static int bench_failed;
+
+/* receiving side, canaries after the message buffer catch overflows */
+static uint8_t bench_rx_buffer[AUX_MCU_MSG_PAYLOAD_LENGTH + HID_BENCH_CANARY_LENGTH];
+static hid_framing_reassembly_t bench_reassembly;
+
+/* packets of the message being sent */
+static uint8_t bench_packets[HID_FRAMING_MAX_NB_PACKETS][HID_FRAMING_PACKET_LENGTH];
+static uint16_t bench_packet_lengths[HID_FRAMING_MAX_NB_PACKETS];
+
+struct bench_channel_t {
+    const char* name;
+    uint32_t loss_per_1000;         /* packet lost */
+    uint32_t resend_per_1000;       /* whole message sent again with the same flip bit */
+    uint32_t dup_packet_per_1000;   /* packet received twice */
+    uint32_t corrupt_per_1000;      /* random header bytes */
+    uint32_t garbage_per_1000;      /* random packet inserted */
+    uint32_t reset_per_1000;        /* 0xFF 0xFF flip bit reset before a message */
+    int strict;                     /* check delivered messages & resynchronization */
+};
+
+static uint32_t bench_rand(void)
+{
+    bench_rng_state ^= bench_rng_state << 13;
+    bench_rng_state ^= bench_rng_state >> 17;
+    bench_rng_state ^= bench_rng_state << 5;
+    return bench_rng_state;
+}
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* message contents can be regenerated from their sequence number */
+static uint16_t bench_fill_message(uint8_t* message, uint32_t seq, uint16_t length)
+{
+    uint32_t state = seq * 2654435761u + 1;
+    for(uint16_t i = 0; i < length; i++) {
+        state = state * 1103515245u + 12345u;
+        message[i] = (uint8_t)(state >> 16);
+    }
+    if(length >= sizeof(seq)) {
+        memcpy(message, &seq, sizeof(seq));
+    }
+    return length;
+}
+
+static uint16_t bench_fragment(uint8_t* message, uint16_t length, uint8_t flip_bit)
+{
+    hid_framing_fragmentation_t fragmentation;
+    uint16_t nb_packets = 0;
+
+    comms_hid_framing_start_fragmentation(&fragmentation, message, length);
+    while((bench_packet_lengths[nb_packets] = comms_hid_framing_get_next_packet(&fragmentation, bench_packets[nb_packets])) != 0) {
+        /* host side: flip bit toggles for each message */
+        bench_packets[nb_packets][0] |= flip_bit << 7;
+        nb_packets++;
+    }
+    return nb_packets;
+}
+
+static void bench_check_canary(const char* name)
+{
+    for(int i = 0; i < HID_BENCH_CANARY_LENGTH; i++) {
+        if(bench_rx_buffer[AUX_MCU_MSG_PAYLOAD_LENGTH + i] != HID_BENCH_CANARY) {
+            fprintf(stderr, "hid bench: %s: reassembly wrote past the message buffer\n", name);
+            bench_failed = 1;
+            memset(&bench_rx_buffer[AUX_MCU_MSG_PAYLOAD_LENGTH], HID_BENCH_CANARY, HID_BENCH_CANARY_LENGTH);
+            return;
+        }
+    }
+}
+
+/* fragmentation + reassembly of error free traffic */
+static void bench_throughput(uint16_t length, uint32_t nb_messages)
+{
+    uint8_t message[AUX_MCU_MSG_PAYLOAD_LENGTH];
+    uint32_t nb_delivered = 0;
+    uint64_t nb_packets = 0;
+    uint8_t flip_bit = 0;
+
+    bench_fill_message(message, 0, length);
+    comms_hid_framing_reset_reassembly(&bench_reassembly);
+
+    uint64_t start_ns = bench_now_ns();
+    for(uint32_t m = 0; m < nb_messages; m++) {
+        uint16_t nb_msg_packets = bench_fragment(message, length, flip_bit);
+        for(uint16_t p = 0; p < nb_msg_packets; p++) {
+            if(comms_hid_framing_process_packet(&bench_reassembly, bench_packets[p], HID_FRAMING_PACKET_LENGTH) == HID_FRAMING_MESSAGE_COMPLETE) {
+                nb_delivered++;
+            }
+        }
+        nb_packets += nb_msg_packets;
+        flip_bit ^= 1;
+    }
+    uint64_t elapsed_ns = bench_now_ns() - start_ns;
+
+    if((nb_delivered != nb_messages) || (memcmp(bench_rx_buffer, message, length) != 0)) {
+        fprintf(stderr, "hid bench: throughput %u: %" PRIu32 " of %" PRIu32 " messages delivered\n", length, nb_delivered, nb_messages);
+        bench_failed = 1;
+    }
+    bench_check_canary("throughput");
+
+    fprintf(bench_out, "{\"op\":\"throughput\",\"message_length\":%u,\"messages\":%" PRIu32 ",\"packets_per_message\":%.2f,"
+            "\"ns_per_message\":%.1f,\"messages_per_s\":%.0f,\"mbytes_per_s\":%.1f}\n",
+            length, nb_messages, (double)nb_packets / nb_messages, (double)elapsed_ns / nb_messages,
+            nb_messages * 1e9 / elapsed_ns, (double)nb_messages * length * 1e3 / elapsed_ns);
+    fflush(bench_out);
+}
+
+/* random traffic through a damaging channel */
+static void bench_channel(const struct bench_channel_t* channel, uint32_t nb_messages)
+{
+    uint8_t message[AUX_MCU_MSG_PAYLOAD_LENGTH];
+    uint8_t expected[AUX_MCU_MSG_PAYLOAD_LENGTH];
+    uint32_t nb_sent = 0, nb_intact = 0, nb_delivered = 0, nb_mismatches = 0, nb_duplicates = 0, nb_not_resynced = 0;
+    int64_t last_delivered_seq = -1;
+    int previous_damaged = 0;
+    uint8_t flip_bit = 0;
+
+    comms_hid_framing_reset_reassembly(&bench_reassembly);
+
+    for(uint32_t seq = 0; seq < nb_messages; seq++) {
+        uint16_t length = (uint16_t)(sizeof(uint32_t) + bench_rand() % (AUX_MCU_MSG_PAYLOAD_LENGTH - sizeof(uint32_t) + 1));
+        uint16_t nb_msg_packets = bench_fragment(message, bench_fill_message(message, seq, length), flip_bit);
+        int nb_sends = ((bench_rand() % 1000) < channel->resend_per_1000)? 2 : 1;
+        int damaged = 0, delivered = 0;
+
+        if((bench_rand() % 1000) < channel->reset_per_1000) {
+            uint8_t reset_packet[HID_FRAMING_PACKET_LENGTH] = {0xFF, 0xFF};
+            comms_hid_framing_process_packet(&bench_reassembly, reset_packet, sizeof(reset_packet));
+            flip_bit = 0;
+            nb_msg_packets = bench_fragment(message, length, flip_bit);
+        }
+
+        for(int s = 0; s < nb_sends; s++) {
+            for(uint16_t p = 0; p < nb_msg_packets; p++) {
+                uint8_t packet[HID_FRAMING_PACKET_LENGTH];
+                int nb_copies = ((bench_rand() % 1000) < channel->dup_packet_per_1000)? 2 : 1;
+
+                if((bench_rand() % 1000) < channel->garbage_per_1000) {
+                    for(int i = 0; i < HID_FRAMING_PACKET_LENGTH; i++) {
+                        packet[i] = (uint8_t)bench_rand();
+                    }
+                    comms_hid_framing_process_packet(&bench_reassembly, packet, 2 + bench_rand() % (HID_FRAMING_PACKET_LENGTH - 1));
+                    damaged = 1;
+                }
+                if((bench_rand() % 1000) < channel->loss_per_1000) {
+                    damaged |= (s == 0);
+                    continue;
+                }
+                memcpy(packet, bench_packets[p], sizeof(packet));
+                if((bench_rand() % 1000) < channel->corrupt_per_1000) {
+                    packet[bench_rand() % 2] ^= (uint8_t)(1 + bench_rand() % 255);
+                    damaged |= (s == 0);
+                }
+                if(nb_copies > 1) {
+                    damaged |= (s == 0);
+                }
+
+                for(int c = 0; c < nb_copies; c++) {
+                    if(comms_hid_framing_process_packet(&bench_reassembly, packet, bench_rand() % 2? HID_FRAMING_PACKET_LENGTH : bench_packet_lengths[p]) != HID_FRAMING_MESSAGE_COMPLETE) {
+                        continue;
+                    }
+
+                    /* check what was delivered against what was sent */
+                    uint32_t delivered_seq = 0;
+                    memcpy(&delivered_seq, bench_rx_buffer, sizeof(delivered_seq));
+                    if((delivered_seq > seq) || (bench_reassembly.message_length < sizeof(uint32_t)) ||
+                       (bench_fill_message(expected, delivered_seq, bench_reassembly.message_length), memcmp(expected, bench_rx_buffer, bench_reassembly.message_length) != 0)) {
+                        nb_mismatches++;
+                    } else if((int64_t)delivered_seq <= last_delivered_seq) {
+                        nb_duplicates++;
+                    } else {
+                        last_delivered_seq = delivered_seq;
+                        delivered |= (delivered_seq == seq);
+                        nb_delivered++;
+                    }
+                }
+            }
+        }
+        bench_check_canary(channel->name);
+
+        /* a message sent intact right after a damaged one must get through */
+        if(!damaged) {
+            nb_intact++;
+            if(!delivered && previous_damaged) {
+                nb_not_resynced++;
+            }
+        }
+        previous_damaged = damaged;
+        flip_bit ^= 1;
+        nb_sent++;
+    }
+
+    if(channel->strict && (nb_mismatches || nb_duplicates || nb_not_resynced || (nb_delivered < nb_intact))) {
+        fprintf(stderr, "hid bench: %s: %" PRIu32 " mismatches, %" PRIu32 " duplicates, %" PRIu32 " messages lost after a damaged one, %" PRIu32 " delivered for %" PRIu32 " intact\n",
+                channel->name, nb_mismatches, nb_duplicates, nb_not_resynced, nb_delivered, nb_intact);
+        bench_failed = 1;
+    }
+
+    fprintf(bench_out, "{\"op\":\"channel\",\"channel\":\"%s\",\"messages\":%" PRIu32 ",\"intact\":%" PRIu32 ",\"delivered\":%" PRIu32 ","
+            "\"mismatches\":%" PRIu32 ",\"duplicates\":%" PRIu32 ",\"lost_after_damaged\":%" PRIu32 "}\n",
+            channel->name, nb_sent, nb_intact, nb_delivered, nb_mismatches, nb_duplicates, nb_not_resynced);
+    fflush(bench_out);
+}
+
+int main(int argc, char* argv[])
+{
+    const uint16_t lengths[] = {4, 62, 64, 256, 512, AUX_MCU_MSG_PAYLOAD_LENGTH};
+    const struct bench_channel_t channels[] = {
+        /* name         loss  resend  dup  corrupt  garbage  reset  strict */
+        {"clean",          0,      0,   0,       0,       0,     0, 1},
+        {"lossy",         20,      0,   0,       0,       0,     0, 1},
+        {"resend",        20,    100,   0,       0,       0,    10, 1},
+        {"chaos",         20,     50,  20,      20,      10,    10, 0},
+    };
+    uint32_t nb_messages = HID_BENCH_DEFAULT_MESSAGES;
+
+    bench_out = stdout;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+            bench_out = fopen(argv[++i], "w");
+            if(!bench_out) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            nb_messages = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            bench_rng_state = (uint32_t)strtoul(argv[++i], NULL, 0) | 1;
+        } else {
+            fprintf(stderr, "usage: %s [-o output.json] [-n nb_messages] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(nb_messages == 0) {
+        nb_messages = 1;
+    }
+
+    memset(bench_rx_buffer, HID_BENCH_CANARY, sizeof(bench_rx_buffer));
+    comms_hid_framing_init_reassembly(&bench_reassembly, bench_rx_buffer, AUX_MCU_MSG_PAYLOAD_LENGTH);
+
+    for(size_t i = 0; i < sizeof(lengths)/sizeof(lengths[0]); i++) {
+        bench_throughput(lengths[i], nb_messages);
+    }
+    for(size_t i = 0; i < sizeof(channels)/sizeof(channels[0]); i++) {
+        bench_channel(&channels[i], nb_messages / 4);
+    }
+
+    if(bench_out != stdout) {
+        fclose(bench_out);
+    }
+    return bench_failed;
+}
@@ -0,0 +1,326 @@
+/* Host side test of the keyboard typing logic shared with the aux mcu (aux_mcu/src/LOGIC/logic_keyboard_sequencer.c).
+ * Checks symbol -> keystrokes conversion and report planning, then types random strings (repeated characters,
+ * shift / altgr changes, dead keys) through a model of the host and checks what it types. Results are JSON lines:
+ *   make -f Makefile.bench keyboard && build/minible_keyboard_test [-o results.json] [-n nb_strings] [-s seed]
+ * Exits with 1 if a check failed.
+ */
+#include "logic_keyboard_sequencer.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define KEYBOARD_TEST_DEFAULT_STRINGS   2000
+#define KEYBOARD_TEST_MAX_SYMBOLS       200
+/* keys have to be released well before the host starts auto repeating them */
+#define KEYBOARD_TEST_MAX_KEY_HOLD_MS   100
+
+/* results output */
+static FILE* test_out;
+static uint32_t test_rng_state = 0x1234567;
+static int test_failed;
+
+/* host model: keys currently held and keystrokes typed so far */
+struct test_host_t {
+    uint8_t modifier;
+    uint8_t nb_keys;
+    uint8_t keys[LOGIC_KEYBOARD_NB_KEY_SLOTS];
+    uint32_t press_ms[LOGIC_KEYBOARD_NB_KEY_SLOTS];
+    logic_keyboard_keystroke_t typed[2*KEYBOARD_TEST_MAX_SYMBOLS];
+    uint8_t typed_nb_held[2*KEYBOARD_TEST_MAX_SYMBOLS];     /* keys held when typed, itself included */
+    uint8_t typed_slot[2*KEYBOARD_TEST_MAX_SYMBOLS];        /* key slot in the report that typed it */
+    uint32_t nb_typed;
+    uint32_t max_hold_ms;
+    const char* error;
+};
+
+static uint32_t test_rand(void)
+{
+    test_rng_state ^= test_rng_state << 13;
+    test_rng_state ^= test_rng_state >> 17;
+    test_rng_state ^= test_rng_state << 5;
+    return test_rng_state;
+}
+
+static void test_check(int condition, const char* name)
+{
+    if(!condition) {
+        fprintf(stderr, "keyboard test: %s failed\n", name);
+        test_failed = 1;
+    }
+}
+
+static int test_keystroke_is(const logic_keyboard_keystroke_t* keystroke, uint8_t key, uint8_t modifier, BOOL is_dead_key)
+{
+    return (keystroke->key == key) && (keystroke->modifier == modifier) && (keystroke->is_dead_key == is_dead_key);
+}
+
+static void test_symbol_to_keystrokes(void)
+{
+    logic_keyboard_keystroke_t keystrokes[2];
+
+    test_check(logic_keyboard_symbol_to_keystrokes(KEY_A, keystrokes) == 1 && test_keystroke_is(&keystrokes[0], KEY_A, 0, FALSE), "plain key");
+    test_check(logic_keyboard_symbol_to_keystrokes(KEY_A|SHIFT_MASK, keystrokes) == 1 && test_keystroke_is(&keystrokes[0], KEY_A, KEY_SHIFT, FALSE), "shift key");
+    test_check(logic_keyboard_symbol_to_keystrokes(KEY_1|ALTGR_MASK, keystrokes) == 1 && test_keystroke_is(&keystrokes[0], KEY_1, KEY_RIGHT_ALT, FALSE), "altgr key");
+    test_check(logic_keyboard_symbol_to_keystrokes(KEY_1|SHIFT_MASK|ALTGR_MASK, keystrokes) == 1 && test_keystroke_is(&keystrokes[0], KEY_1, KEY_SHIFT|KEY_RIGHT_ALT, FALSE), "shift altgr key");
+    test_check(logic_keyboard_symbol_to_keystrokes(KEY_EUROPE_2, keystrokes) == 1 && test_keystroke_is(&keystrokes[0], KEY_EUROPE_2_REAL, 0, FALSE), "europe 2 key");
+    test_check(logic_keyboard_symbol_to_keystrokes(KEY_EUROPE_2|SHIFT_MASK, keystrokes) == 1 && test_keystroke_is(&keystrokes[0], KEY_EUROPE_2_REAL, KEY_SHIFT, FALSE), "shift europe 2 key");
+    test_check(logic_keyboard_symbol_to_keystrokes(0x8000|KEY_6|SHIFT_MASK, keystrokes) == 2 && test_keystroke_is(&keystrokes[0], KEY_6, KEY_SHIFT, TRUE) && test_keystroke_is(&keystrokes[1], KEY_SPACE, 0, FALSE), "dead key");
+    test_check(logic_keyboard_symbol_to_keystrokes((uint16_t)(((KEY_6|SHIFT_MASK) << 8)|KEY_E), keystrokes) == 2 && test_keystroke_is(&keystrokes[0], KEY_6, KEY_SHIFT, FALSE) && test_keystroke_is(&keystrokes[1], KEY_E, 0, FALSE), "two keys symbol");
+    test_check(logic_keyboard_symbol_to_keystrokes(0xFFFF, keystrokes) == 0, "untypable symbol");
+}
+
+static uint16_t test_plan(const uint16_t* symbols, uint16_t nb_symbols, logic_keyboard_report_t* report)
+{
+    logic_keyboard_keystroke_t keystrokes[16];
+    uint16_t nb_keystrokes = 0;
+
+    for(uint16_t i = 0; i < nb_symbols; i++) {
+        nb_keystrokes += logic_keyboard_symbol_to_keystrokes(symbols[i], &keystrokes[nb_keystrokes]);
+    }
+    return logic_keyboard_plan_report(keystrokes, nb_keystrokes, report);
+}
+
+static void test_plan_report(void)
+{
+    const uint16_t distinct[] = {KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H};
+    const uint16_t repeated[] = {KEY_A, KEY_B, KEY_A};
+    const uint16_t doubled[] = {KEY_A, KEY_A};
+    const uint16_t shift_change[] = {KEY_A, KEY_B, KEY_C|SHIFT_MASK, KEY_D};
+    const uint16_t shifted[] = {KEY_A|SHIFT_MASK, KEY_B|SHIFT_MASK, KEY_C};
+    const uint16_t before_dead[] = {KEY_A, 0x8000|KEY_6, KEY_E};
+    const uint16_t dead[] = {0x8000|KEY_6, KEY_E};
+    logic_keyboard_report_t report;
+
+    test_check(test_plan(distinct, 8, &report) == LOGIC_KEYBOARD_NB_KEY_SLOTS && report.nb_keys == LOGIC_KEYBOARD_NB_KEY_SLOTS && report.modifier == 0, "plan: key slots cap");
+    test_check(test_plan(repeated, 3, &report) == 2 && report.keys[0] == KEY_A && report.keys[1] == KEY_B, "plan: repeated key");
+    test_check(test_plan(doubled, 2, &report) == 1, "plan: doubled key");
+    test_check(test_plan(shift_change, 4, &report) == 2 && report.modifier == 0, "plan: shift pressed");
+    test_check(test_plan(shifted, 3, &report) == 2 && report.modifier == KEY_SHIFT, "plan: shift released");
+    test_check(test_plan(before_dead, 3, &report) == 1 && report.keys[0] == KEY_A, "plan: key before dead key");
+    test_check(test_plan(dead, 2, &report) == 1 && report.keys[0] == KEY_6 && report.modifier == 0, "plan: dead key");
+}
+
+static uint32_t test_count_reports(const uint16_t* symbols, uint16_t nb_symbols)
+{
+    static logic_keyboard_sequencer_t sequencer;
+    logic_keyboard_report_t report;
+    uint16_t symbol_index = 0;
+    uint32_t nb_reports = 0;
+
+    memset(&sequencer, 0, sizeof(sequencer));
+    while(1) {
+        while((symbol_index < nb_symbols) && (logic_keyboard_sequencer_add_symbol(&sequencer, symbols[symbol_index]) != FALSE)) {
+            symbol_index++;
+        }
+        if(logic_keyboard_sequencer_get_next_report(&sequencer, &report) == FALSE) {
+            return nb_reports;
+        }
+        nb_reports++;
+    }
+}
+
+static void test_report_packing(void)
+{
+    const uint16_t distinct[] = {KEY_A, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F};
+    const uint16_t shifted[] = {KEY_A|SHIFT_MASK, KEY_B|SHIFT_MASK, KEY_C|SHIFT_MASK};
+    const uint16_t doubled[] = {KEY_A, KEY_A};
+    uint16_t alphabet[26];
+
+    for(uint16_t i = 0; i < 26; i++) {
+        alphabet[i] = (uint16_t)(KEY_A + i);
+    }
+
+    /* press + release per group of keys, the modifier is sent alone first */
+    test_check(test_count_reports(distinct, 6) == 2, "packing: distinct keys");
+    test_check(test_count_reports(alphabet, 26) == 2*((26 + LOGIC_KEYBOARD_NB_KEY_SLOTS - 1) / LOGIC_KEYBOARD_NB_KEY_SLOTS), "packing: alphabet");
+    test_check(test_count_reports(shifted, 3) == 3, "packing: shifted keys");
+    test_check(test_count_reports(doubled, 2) == 4, "packing: doubled key");
+}
+
+/* what the host sees: keys appearing in a report are typed in key slot order, with the report modifier */
+static void test_host_process(struct test_host_t* host, const logic_keyboard_report_t* report, uint32_t timestamp_ms)
+{
+    uint8_t nb_kept_keys = 0;
+
+    for(uint8_t i = 0; i < host->nb_keys; i++) {
+        if(memchr(report->keys, host->keys[i], report->nb_keys) != NULL) {
+            nb_kept_keys++;
+        } else if(timestamp_ms - host->press_ms[i] > host->max_hold_ms) {
+            host->max_hold_ms = timestamp_ms - host->press_ms[i];
+        }
+    }
+    if((nb_kept_keys != host->nb_keys) && (report->nb_keys != 0)) {
+        host->error = "keys released one by one";
+    }
+    if((report->modifier != host->modifier) && (report->nb_keys != 0)) {
+        host->error = "modifier changed while keys are held";
+    }
+
+    for(uint8_t i = 0; i < report->nb_keys; i++) {
+        if(memchr(host->keys, report->keys[i], host->nb_keys) != NULL) {
+            continue;
+        }
+        if(host->nb_typed == sizeof(host->typed)/sizeof(host->typed[0])) {
+            host->error = "too many keystrokes typed";
+            continue;
+        }
+        host->typed[host->nb_typed].key = report->keys[i];
+        host->typed[host->nb_typed].modifier = report->modifier;
+        host->typed_nb_held[host->nb_typed] = report->nb_keys;
+        host->typed_slot[host->nb_typed] = i;
+        host->nb_typed++;
+    }
+
+    /* press time of the held keys */
+    uint32_t press_ms[LOGIC_KEYBOARD_NB_KEY_SLOTS] = {0};
+    for(uint8_t i = 0; i < report->nb_keys; i++) {
+        press_ms[i] = timestamp_ms;
+        for(uint8_t j = 0; j < host->nb_keys; j++) {
+            if(host->keys[j] == report->keys[i]) {
+                press_ms[i] = host->press_ms[j];
+            }
+        }
+    }
+    memcpy(host->press_ms, press_ms, sizeof(press_ms));
+    memcpy(host->keys, report->keys, sizeof(host->keys));
+    host->nb_keys = report->nb_keys;
+    host->modifier = report->modifier;
+}
+
+static uint16_t test_random_symbol(void)
+{
+    const uint8_t alphabet[] = {KEY_A, KEY_B, KEY_C, KEY_1, KEY_6, KEY_SPACE, KEY_EUROPE_2};
+    const uint8_t masks[] = {0, 0, 0, SHIFT_MASK, SHIFT_MASK, ALTGR_MASK, SHIFT_MASK|ALTGR_MASK};
+    uint8_t symbol = alphabet[test_rand() % sizeof(alphabet)] | masks[test_rand() % sizeof(masks)];
+
+    switch(test_rand() % 16) {
+        case 0: return 0x8000|symbol;
+        case 1: return (uint16_t)((symbol << 8)|alphabet[test_rand() % sizeof(alphabet)]);
+        case 2: return 0xFFFF;
+        default: return symbol;
+    }
+}
+
+static void test_typing(uint32_t interval_ms, uint32_t nb_strings)
+{
+    static logic_keyboard_sequencer_t sequencer;
+    static struct test_host_t host;
+    uint16_t symbols[KEYBOARD_TEST_MAX_SYMBOLS];
+    logic_keyboard_keystroke_t expected[2*KEYBOARD_TEST_MAX_SYMBOLS];
+    uint32_t nb_failed = 0;
+    uint32_t nb_keystrokes = 0;
+    uint32_t nb_reports = 0;
+    uint32_t max_hold_ms = 0;
+    uint32_t timestamp_ms = test_rand();
+
+    for(uint32_t string = 0; string < nb_strings; string++) {
+        uint16_t nb_symbols = (uint16_t)(1 + test_rand() % KEYBOARD_TEST_MAX_SYMBOLS);
+        uint32_t nb_expected = 0;
+        uint16_t symbol_index = 0;
+        logic_keyboard_report_t report;
+
+        for(uint16_t i = 0; i < nb_symbols; i++) {
+            symbols[i] = test_random_symbol();
+            nb_expected += logic_keyboard_symbol_to_keystrokes(symbols[i], &expected[nb_expected]);
+        }
+
+        /* same calls as logic_keyboard_send_next_job_report() */
+        memset(&sequencer, 0, sizeof(sequencer));
+        memset(&host, 0, sizeof(host));
+        while(1) {
+            while((symbol_index < nb_symbols) && (logic_keyboard_sequencer_add_symbol(&sequencer, symbols[symbol_index]) != FALSE)) {
+                symbol_index++;
+            }
+            if(logic_keyboard_sequencer_get_next_report(&sequencer, &report) == FALSE) {
+                break;
+            }
+            test_host_process(&host, &report, timestamp_ms);
+            timestamp_ms += interval_ms;
+            nb_reports++;
+            if(host.nb_typed > nb_expected) {
+                break;
+            }
+        }
+
+        if((host.error == NULL) && ((host.nb_keys != 0) || (host.modifier != 0))) {
+            host.error = "keys still held";
+        }
+        if(host.error == NULL) {
+            if(host.nb_typed != nb_expected) {
+                host.error = "wrong number of keystrokes typed";
+            }
+            for(uint32_t i = 0; (i < nb_expected) && (host.error == NULL); i++) {
+                if((host.typed[i].key != expected[i].key) || (host.typed[i].modifier != expected[i].modifier)) {
+                    host.error = "keystrokes typed out of order";
+                }
+                /* the host combines a dead key with the next key press */
+                if((expected[i].is_dead_key != FALSE) && ((host.typed_nb_held[i] != 1) || ((i + 1 < nb_expected) && (host.typed_slot[i + 1] != 0)))) {
+                    host.error = "dead key held with another key";
+                }
+            }
+        }
+        if(host.max_hold_ms > interval_ms) {
+            host.error = "keys not released by the next report";
+        }
+        if(host.error != NULL) {
+            if(nb_failed++ == 0) {
+                fprintf(stderr, "keyboard test: %" PRIu32 "ms per report, string %" PRIu32 ": %s\n", interval_ms, string, host.error);
+            }
+        }
+
+        nb_keystrokes += nb_expected;
+        if(host.max_hold_ms > max_hold_ms) {
+            max_hold_ms = host.max_hold_ms;
+        }
+    }
+
+    if(nb_failed != 0) {
+        fprintf(stderr, "keyboard test: %" PRIu32 "ms per report: %" PRIu32 " of %" PRIu32 " strings typed wrong\n", interval_ms, nb_failed, nb_strings);
+        test_failed = 1;
+    }
+    if((interval_ms <= KEYBOARD_TEST_MAX_KEY_HOLD_MS) && (max_hold_ms > KEYBOARD_TEST_MAX_KEY_HOLD_MS)) {
+        fprintf(stderr, "keyboard test: %" PRIu32 "ms per report: keys held for %" PRIu32 "ms\n", interval_ms, max_hold_ms);
+        test_failed = 1;
+    }
+    fprintf(test_out, "{\"op\":\"typing\",\"ms_per_report\":%" PRIu32 ",\"strings\":%" PRIu32 ",\"failed\":%" PRIu32 ",\"keystrokes\":%" PRIu32 ","
+            "\"reports_per_keystroke\":%.3f,\"max_hold_ms\":%" PRIu32 "}\n",
+            interval_ms, nb_strings, nb_failed, nb_keystrokes, nb_keystrokes ? (double)nb_reports / nb_keystrokes : 0.0, max_hold_ms);
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t intervals_ms[] = {0, 1, 7, 30, KEYBOARD_TEST_MAX_KEY_HOLD_MS, 150};
+    uint32_t nb_strings = KEYBOARD_TEST_DEFAULT_STRINGS;
+
+    test_out = stdout;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+            test_out = fopen(argv[++i], "w");
+            if(!test_out) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            nb_strings = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            test_rng_state = (uint32_t)strtoul(argv[++i], NULL, 0) | 1;
+        } else {
+            fprintf(stderr, "usage: %s [-o output.json] [-n nb_strings] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    test_symbol_to_keystrokes();
+    test_plan_report();
+    test_report_packing();
+    for(size_t i = 0; i < sizeof(intervals_ms)/sizeof(intervals_ms[0]); i++) {
+        test_typing(intervals_ms[i], nb_strings);
+    }
+
+    if(test_out != stdout) {
+        fclose(test_out);
+    }
+    return test_failed;
+}
@@ -23,6 +23,7 @@ extern "C" {
 /// grayscale 8-bit
 static uint8_t oled_fb[FB_WIDTH * FB_HEIGHT];
 static int oled_col, oled_row;
+static bool oled_display_on = true;
 
 void emu_oled_byte(uint8_t data)
 {
@@ -52,10 +53,14 @@ void emu_oled_byte(uint8_t data)
                 cmdargs = 1;
                 break;
             case SH1122_CMD_SET_DISPLAY_ON:
-                postToObject([]() { oled->set_display_on(true); }, oled);
+                oled_display_on = true;
+                if(oled)
+                    postToObject([]() { oled->set_display_on(true); }, oled);
                 break;
             case SH1122_CMD_SET_DISPLAY_OFF:
-                postToObject([]() { oled->set_display_on(false); }, oled);
+                oled_display_on = false;
+                if(oled)
+                    postToObject([]() { oled->set_display_on(false); }, oled);
                 break;
             }
 
@@ -90,13 +95,21 @@ void emu_oled_byte(uint8_t data)
 
 static QMutex fb_update;
 static uint8_t framebuffers[2][256*64];
+static uint8_t fb_flushed[256*64];
 static int fb_next=0, fb_pending=-1;
 
 void emu_oled_flush(void)
 {
     emu_appexit_test();
     fb_update.lock();
-    if(fb_pending >= 0) {
+
+    // keep the last flushed frame around for emu_oled_get_framebuffer()
+    memcpy(fb_flushed, oled_fb, 256*64);
+
+    if(!oled) {
+        // headless, nothing to repaint
+
+    } else if(fb_pending >= 0) {
         // an update is queued, just replace the contents
         memcpy(framebuffers[fb_pending], oled_fb, 256*64);
 
@@ -120,6 +133,33 @@ void emu_oled_flush(void)
     fb_update.unlock();
 }
 
+void emu_oled_get_framebuffer(uint8_t *fb)
+{
+    fb_update.lock();
+    memcpy(fb, fb_flushed, 256*64);
+    fb_update.unlock();
+}
+
+BOOL emu_oled_is_display_on(void)
+{
+    return oled_display_on ? TRUE : FALSE;
+}
+
+bool emu_oled_save_framebuffer(QString filePath)
+{
+    QImage image(FB_WIDTH, FB_HEIGHT, QImage::Format_Grayscale8);
+    uint8_t fb[FB_WIDTH * FB_HEIGHT];
+
+    emu_oled_get_framebuffer(fb);
+    if(!oled_display_on)
+        memset(fb, 0, sizeof(fb));
+
+    for(int y=0;y<FB_HEIGHT;y++)
+        memcpy(image.scanLine(y), fb + y*FB_WIDTH, FB_WIDTH);
+
+    return image.save(filePath);
+}
+
 OLEDWidget::OLEDWidget(): display(256, 64, QImage::Format_RGB888) {
     setMinimumSize(display.size());
     setMaximumSize(display.size());
@@ -206,11 +246,25 @@ extern "C" void inputs_scan(void)
 }
 
 
-void OLEDWidget::wheelEvent(QWheelEvent *evt) {
-    int delta = evt->angleDelta().y()/120;
+void emu_inputs_wheel_scroll(int16_t increment)
+{
+    irq_mutex.lock();
+    inputs_wheel_cur_increment += increment;
+    irq_mutex.unlock();
+    emu_idle_wake();
+}
+
+void emu_inputs_wheel_press(BOOL pressed, BOOL long_press)
+{
     irq_mutex.lock();
-    inputs_wheel_cur_increment -= delta;
+    set_emulated_wheel_state(pressed != FALSE, ((pressed != FALSE) && (long_press != FALSE)) ? 3000 : -1);
     irq_mutex.unlock();
+    emu_idle_wake();
+}
+
+void OLEDWidget::wheelEvent(QWheelEvent *evt) {
+    int delta = evt->angleDelta().y()/120;
+    emu_inputs_wheel_scroll(-delta);
 }
 
 void OLEDWidget::mousePressEvent(QMouseEvent *evt) {
@@ -1,11 +1,13 @@
 #ifndef _EMU_OLED_H
 #define _EMU_OLED_H
 #include <inttypes.h>
+#include "defines.h"
 
 #ifdef __cplusplus
 
 #include <QWidget>
 #include <QImage>
+#include <QString>
 
 class OLEDWidget: public QWidget {
 public:
@@ -26,12 +28,23 @@ protected:
     virtual void keyReleaseEvent(QKeyEvent *evt);
 };
 
+/* save the last flushed frame to an image file, format is deduced from the extension */
+bool emu_oled_save_framebuffer(QString filePath);
+
 extern "C" {
 #endif
 
 void emu_oled_byte(uint8_t data);
 void emu_oled_flush(void);
 
+/* last flushed frame, 256x64 8-bit grayscale */
+void emu_oled_get_framebuffer(uint8_t *fb);
+BOOL emu_oled_is_display_on(void);
+
+/* scriptable inputs, positive increments scroll down */
+void emu_inputs_wheel_scroll(int16_t increment);
+void emu_inputs_wheel_press(BOOL pressed, BOOL long_press);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,140 @@
+#include "emu_script.h"
+#include "emu_oled.h"
+#include "emu_smartcard.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+/* time during which the wheel is held for click commands */
+#define EMU_SCRIPT_CLICK_MS         50
+#define EMU_SCRIPT_LONG_CLICK_MS    3100
+
+enum emu_script_op_t { OP_WAIT, OP_SCROLL, OP_PRESS, OP_LONG_PRESS, OP_RELEASE, OP_CARD, OP_SWAPCARD, OP_NOCARD, OP_SCREENSHOT, OP_QUIT };
+
+struct emu_script_cmd_t {
+    emu_script_op_t op;
+    int arg;
+    QString path;
+};
+
+static QVector<emu_script_cmd_t> script;
+static int script_pos;
+static uint64_t script_resume_ms;
+
+static void emu_script_add(emu_script_op_t op, int arg = 0, QString path = QString())
+{
+    emu_script_cmd_t cmd;
+    cmd.op = op;
+    cmd.arg = arg;
+    cmd.path = path;
+    script.append(cmd);
+}
+
+bool emu_script_load(QString filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Failed to open script" << filePath;
+        return false;
+    }
+
+    QTextStream in(&file);
+    for(int line_nb = 1; !in.atEnd(); line_nb++) {
+        QString line = in.readLine().section('#', 0, 0).trimmed();
+        if(line.isEmpty())
+            continue;
+
+        QString cmd = line.section(' ', 0, 0);
+        QString arg = line.section(' ', 1).trimmed();
+        bool ok = true;
+
+        if(cmd == "wait") {
+            emu_script_add(OP_WAIT, arg.toInt(&ok));
+        } else if(cmd == "scroll") {
+            emu_script_add(OP_SCROLL, arg.toInt(&ok));
+        } else if(cmd == "click") {
+            emu_script_add(OP_PRESS);
+            emu_script_add(OP_WAIT, EMU_SCRIPT_CLICK_MS);
+            emu_script_add(OP_RELEASE);
+        } else if(cmd == "longclick") {
+            emu_script_add(OP_LONG_PRESS);
+            emu_script_add(OP_WAIT, EMU_SCRIPT_LONG_CLICK_MS);
+            emu_script_add(OP_RELEASE);
+        } else if(cmd == "press") {
+            emu_script_add(OP_PRESS);
+        } else if(cmd == "release") {
+            emu_script_add(OP_RELEASE);
+        } else if(cmd == "card") {
+            emu_script_add(OP_CARD, 0, arg);
+            ok = !arg.isEmpty();
+        } else if(cmd == "swapcard") {
+            emu_script_add(OP_SWAPCARD, 0, arg);
+            ok = !arg.isEmpty();
+        } else if(cmd == "nocard") {
+            emu_script_add(OP_NOCARD);
+        } else if(cmd == "screenshot") {
+            emu_script_add(OP_SCREENSHOT, 0, arg);
+            ok = !arg.isEmpty();
+        } else if(cmd == "quit") {
+            emu_script_add(OP_QUIT);
+        } else {
+            ok = false;
+        }
+
+        if(!ok) {
+            qWarning() << "Invalid script command at line" << line_nb << ":" << line;
+            return false;
+        }
+    }
+
+    script_pos = 0;
+    script_resume_ms = 0;
+    return true;
+}
+
+void emu_script_tick(uint64_t now_ms)
+{
+    while((script_pos < script.size()) && (now_ms >= script_resume_ms)) {
+        const emu_script_cmd_t & cmd = script[script_pos++];
+
+        switch(cmd.op) {
+        case OP_WAIT:
+            script_resume_ms = now_ms + cmd.arg;
+            break;
+        case OP_SCROLL:
+            emu_inputs_wheel_scroll(cmd.arg);
+            break;
+        case OP_PRESS:
+            emu_inputs_wheel_press(TRUE, FALSE);
+            break;
+        case OP_LONG_PRESS:
+            emu_inputs_wheel_press(TRUE, TRUE);
+            break;
+        case OP_RELEASE:
+            emu_inputs_wheel_press(FALSE, FALSE);
+            break;
+        case OP_CARD:
+            if(!emu_insert_smartcard(cmd.path))
+                qWarning() << "Script: failed to insert smartcard" << cmd.path;
+            break;
+        case OP_SWAPCARD:
+            if(!emu_swap_smartcard(cmd.path))
+                qWarning() << "Script: failed to swap smartcard" << cmd.path;
+            break;
+        case OP_NOCARD:
+            emu_remove_smartcard();
+            break;
+        case OP_SCREENSHOT:
+            if(!emu_oled_save_framebuffer(cmd.path))
+                qWarning() << "Script: failed to save screenshot" << cmd.path;
+            break;
+        case OP_QUIT:
+            QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+            break;
+        }
+    }
+}
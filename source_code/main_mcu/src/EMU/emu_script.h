@@ -0,0 +1,26 @@
+#ifndef EMU_SCRIPT_H
+#define EMU_SCRIPT_H
+#include <inttypes.h>
+
+#ifdef __cplusplus
+#include <QString>
+
+/* Input scripts, one command per line, '#' starts a comment:
+ *   wait <ms>            wait for <ms> milliseconds of emulated time
+ *   scroll <n>           scroll the wheel by n detents (negative scrolls up)
+ *   click / longclick    short / long wheel click
+ *   press / release      press or release the wheel
+ *   card <file>          insert the smartcard stored in <file>
+ *   swapcard <file>      remove the smartcard and insert the one stored in <file> at the next card detection
+ *   nocard               remove the smartcard
+ *   screenshot <file>    save the last flushed frame
+ *   quit                 exit the emulator
+ */
+bool emu_script_load(QString filePath);
+
+/* run the commands due at the provided emulated time, from the app thread */
+void emu_script_tick(uint64_t now_ms);
+
+#endif
+
+#endif
@@ -1,19 +1,145 @@
 #include "emu_smartcard.h"
+#include "emulator.h"
 
 #include <QMutex>
 #include <QMutexLocker>
+#include <QDebug>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+
+/* card files are only read at their first insertion, then kept in a pool keyed by path.
+ * writes mark dirty zones, which are written back when the card is removed and at exit.
+ * a file changed by someone else since it was loaded or written back is loaded again */
+#define EMU_SMARTCARD_ZONE_SIZE     64
+#define EMU_SMARTCARD_NB_ZONES      ((sizeof(struct emu_smartcard_storage_t) + EMU_SMARTCARD_ZONE_SIZE - 1) / EMU_SMARTCARD_ZONE_SIZE)
+static_assert(EMU_SMARTCARD_NB_ZONES <= 32, "Dirty zones do not fit in a 32 bits mask");
+
+struct emu_smartcard_slot_t {
+    struct emu_smartcard_t card;
+    struct emu_smartcard_storage_t disk_copy;   // file contents, to find the dirty zones
+    uint32_t dirty_zones;
+    QString filePath;                           // empty for cards without a file
+    QDateTime fileModified;                     // file state when last loaded or written back
+    qint64 fileSize;
+};
 
 static QMutex smc_mutex;
-static emu_smartcard_t card;
-static bool card_present = false;
-static QFile smartcardFile;
+static QHash<QString, emu_smartcard_slot_t*> card_pool;
+static emu_smartcard_slot_t anonymous_card;
+static emu_smartcard_slot_t *inserted_card = NULL;
+static emu_smartcard_slot_t *swapped_card = NULL;
+
+static void emu_smartcard_mark_dirty_zones(emu_smartcard_slot_t *slot)
+{
+    const uint8_t *storage = (const uint8_t*)&slot->card.storage;
+    const uint8_t *disk_copy = (const uint8_t*)&slot->disk_copy;
+
+    for(size_t zone = 0; zone < EMU_SMARTCARD_NB_ZONES; zone++) {
+        size_t offset = zone * EMU_SMARTCARD_ZONE_SIZE;
+        size_t length = qMin((size_t)EMU_SMARTCARD_ZONE_SIZE, sizeof(slot->card.storage) - offset);
+        if(memcmp(storage + offset, disk_copy + offset, length) != 0)
+            slot->dirty_zones |= 1UL << zone;
+    }
+}
+
+static void emu_smartcard_save_file_state(emu_smartcard_slot_t *slot)
+{
+    QFileInfo info(slot->filePath);
+    slot->fileModified = info.lastModified();
+    slot->fileSize = info.size();
+}
+
+static bool emu_smartcard_file_changed(emu_smartcard_slot_t *slot)
+{
+    QFileInfo info(slot->filePath);
+    return (info.lastModified() != slot->fileModified) || (info.size() != slot->fileSize);
+}
+
+// called with smc_mutex held
+static void emu_smartcard_write_back(emu_smartcard_slot_t *slot)
+{
+    if((slot->dirty_zones == 0) || slot->filePath.isEmpty())
+        return;
+
+    // never write zones of the previous card into a regenerated file
+    if(emu_smartcard_file_changed(slot)) {
+        qWarning() << "Smartcard file changed on disk, dropping emulator writes" << slot->filePath;
+        slot->dirty_zones = 0;
+        return;
+    }
+
+    QFile smartcardFile(slot->filePath);
+    if(!smartcardFile.open(QIODevice::ReadWrite)) {
+        qWarning() << "Failed to write back smartcard" << slot->filePath;
+        return;
+    }
+
+    const uint8_t *storage = (const uint8_t*)&slot->card.storage;
+    for(size_t zone = 0; zone < EMU_SMARTCARD_NB_ZONES; zone++) {
+        if((slot->dirty_zones & (1UL << zone)) == 0)
+            continue;
+
+        size_t offset = zone * EMU_SMARTCARD_ZONE_SIZE;
+        size_t length = qMin((size_t)EMU_SMARTCARD_ZONE_SIZE, sizeof(slot->card.storage) - offset);
+        smartcardFile.seek(offset);
+        smartcardFile.write((const char*)storage + offset, length);
+    }
+    smartcardFile.close();
+
+    slot->disk_copy = slot->card.storage;
+    slot->dirty_zones = 0;
+    emu_smartcard_save_file_state(slot);
+}
+
+// called with smc_mutex held
+static void emu_smartcard_eject(void)
+{
+    if(inserted_card != NULL)
+        emu_smartcard_write_back(inserted_card);
+
+    inserted_card = NULL;
+    swapped_card = NULL;
+
+    // card detection is polled by the main loop
+    emu_idle_wake();
+}
+
+// called with smc_mutex held, returns the pooled card or loads it
+static emu_smartcard_slot_t *emu_smartcard_get_slot(QString filePath)
+{
+    QString key = QFileInfo(filePath).absoluteFilePath();
+    emu_smartcard_slot_t *slot = card_pool.value(key, NULL);
+    if(slot != NULL) {
+        if(!emu_smartcard_file_changed(slot))
+            return slot;
+
+        // the file was regenerated: pending writes belong to the previous card
+        card_pool.remove(key);
+        delete slot;
+    }
+
+    QFile smartcardFile(key);
+    if(!smartcardFile.exists() || !smartcardFile.open(QIODevice::ReadWrite))
+        return NULL;
+
+    slot = new emu_smartcard_slot_t();
+    smartcardFile.read((char*)&slot->card.storage, sizeof(slot->card.storage));
+    slot->disk_copy = slot->card.storage;
+    slot->dirty_zones = 0;
+    slot->filePath = key;
+    emu_smartcard_save_file_state(slot);
+    card_pool.insert(key, slot);
+
+    return slot;
+}
 
 struct emu_smartcard_t *emu_open_smartcard()
 {
     smc_mutex.lock();
-    if(card_present) {
-        return &card;
+    if(inserted_card != NULL) {
+        return &inserted_card->card;
 
     } else {
         smc_mutex.unlock();
@@ -23,27 +149,23 @@ struct emu_smartcard_t *emu_open_smartcard()
 
 void emu_close_smartcard(BOOL written)
 {
-    if(written) {
-        smartcardFile.seek(0);
-        smartcardFile.write((char*)&card, sizeof(card));
-        smartcardFile.flush();
-    }
+    if(written && !inserted_card->filePath.isEmpty())
+        emu_smartcard_mark_dirty_zones(inserted_card);
+
     smc_mutex.unlock();
 }
 
 bool emu_insert_smartcard(QString filePath)
 {
     QMutexLocker locker(&smc_mutex);
-    smartcardFile.close();
-    
-    memset(&card, 0, sizeof(card));
+    emu_smartcard_eject();
 
-    smartcardFile.setFileName(filePath);
-    if(!smartcardFile.exists() || !smartcardFile.open(QIODevice::ReadWrite))
+    emu_smartcard_slot_t *slot = emu_smartcard_get_slot(filePath);
+    if(slot == NULL)
         return false;
 
-    smartcardFile.read((char*)&card.storage, sizeof(card.storage));
-    card_present = true;
+    slot->card.unlocked = FALSE;
+    inserted_card = slot;
 
     return true;
 }
@@ -51,38 +173,77 @@ bool emu_insert_smartcard(QString filePath)
 bool emu_insert_new_smartcard(QString filePath, int smartcard_type)
 {
     QMutexLocker locker(&smc_mutex);
-    smartcardFile.close();
-    
-    memset(&card, 0, sizeof(card));
+    emu_smartcard_eject();
+
+    emu_smartcard_slot_t *slot = &anonymous_card;
+    if(!filePath.isEmpty()) {
+        QString key = QFileInfo(filePath).absoluteFilePath();
+        slot = card_pool.value(key, NULL);
+        if(slot == NULL) {
+            slot = new emu_smartcard_slot_t();
+            slot->filePath = key;
+            card_pool.insert(key, slot);
+        }
+    }
 
-    card_present = true;
-    emu_init_smartcard(&card.storage, smartcard_type);
+    memset(&slot->card, 0, sizeof(slot->card));
+    emu_init_smartcard(&slot->card.storage, smartcard_type);
+    slot->disk_copy = slot->card.storage;
+    slot->dirty_zones = 0;
+    inserted_card = slot;
 
     if(!filePath.isEmpty()) {
-        smartcardFile.setFileName(filePath);
-        if(!smartcardFile.open(QIODevice::ReadWrite))
+        QFile smartcardFile(slot->filePath);
+        if(!smartcardFile.open(QIODevice::ReadWrite | QIODevice::Truncate))
             return false;
 
-        smartcardFile.write((char*)&card.storage, sizeof(card.storage));
-        smartcardFile.flush();
+        smartcardFile.write((char*)&slot->card.storage, sizeof(slot->card.storage));
+        smartcardFile.close();
+        emu_smartcard_save_file_state(slot);
     }
 
-    card_present = true;
     return true;
 }
 
+bool emu_swap_smartcard(QString filePath)
+{
+    QMutexLocker locker(&smc_mutex);
+    emu_smartcard_eject();
+
+    swapped_card = emu_smartcard_get_slot(filePath);
+    return swapped_card != NULL;
+}
+
+void emu_complete_smartcard_swap(void)
+{
+    QMutexLocker locker(&smc_mutex);
+    if(swapped_card == NULL)
+        return;
+
+    swapped_card->card.unlocked = FALSE;
+    inserted_card = swapped_card;
+    swapped_card = NULL;
+    emu_idle_wake();
+}
+
 void emu_remove_smartcard() {
     QMutexLocker locker(&smc_mutex);
-    smartcardFile.close();
-    card_present = false;
+    emu_smartcard_eject();
 }
 
 void emu_reset_smartcard() {
     QMutexLocker locker(&smc_mutex);
-    card.unlocked = FALSE;
+    if(inserted_card != NULL)
+        inserted_card->card.unlocked = FALSE;
+}
+
+void emu_smartcard_sync() {
+    QMutexLocker locker(&smc_mutex);
+    for(emu_smartcard_slot_t *slot : card_pool)
+        emu_smartcard_write_back(slot);
 }
 
 bool emu_is_smartcard_inserted()
 {
-    return card_present;
+    return inserted_card != NULL;
 }
@@ -28,13 +28,20 @@ enum { EMU_SMARTCARD_REGULAR, EMU_SMARTCARD_INVALID, EMU_SMARTCARD_BROKEN };
 void emu_init_smartcard(struct emu_smartcard_storage_t *smartcard, int smartcard_type);
 void emu_reset_smartcard();
 
+// inserts the card staged by emu_swap_smartcard(), once its absence was seen by the card detection
+void emu_complete_smartcard_swap(void);
+
 #ifdef __cplusplus
 
 bool emu_insert_smartcard(QString filePath);
 bool emu_insert_new_smartcard(QString filePath, int smartcard_type = EMU_SMARTCARD_REGULAR);
+bool emu_swap_smartcard(QString filePath);
 void emu_remove_smartcard();
 bool emu_is_smartcard_inserted();
 
+// writes the dirty zones of all the cards back to their files
+void emu_smartcard_sync();
+
 
 }
 #endif
@@ -1,20 +1,27 @@
 #include "emu_storage.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <QDebug>
 #include <QFile>
 
-static QFile eeprom("eeprom.bin");
-static QFile dbflash("dbflash.bin");
-static bool emu_open_flash(QFile & flashFile)
-{
-    if(!flashFile.open(QIODevice::ReadWrite)) {
-        qWarning() << "Failed to open emulated flash" << flashFile.fileName();
-        abort();
-    }
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
-    return flashFile.size() > 0;
-}
+struct emu_flash_t {
+    QFile file;
+    uchar *map;
+    int map_size;
+
+    emu_flash_t(const char *name): file(name), map(NULL), map_size(0) {}
+};
+
+static emu_flash_t eeprom("eeprom.bin");
+static emu_flash_t dbflash("dbflash.bin");
+static bool use_mmap = true;
 
 static void emu_extend_flash(QFile & flashFile, int size)
 {
@@ -23,35 +30,87 @@ static void emu_extend_flash(QFile & flashFile, int size)
         int extend_size = size - flashFile.size();
         flashFile.write(QByteArray(extend_size, '\xff'));
     }
-    
+
     flashFile.flush();
 }
 
-static void emu_flash_read(QFile & flashFile, int offset, uint8_t *buf, int length) 
+static BOOL emu_open_flash(emu_flash_t & flash, int size)
+{
+    if(!flash.file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Failed to open emulated flash" << flash.file.fileName();
+        abort();
+    }
+
+    BOOL existed = flash.file.size() > 0;
+
+    if(use_mmap) {
+        // pre-size the file once, all accesses then go through the mapping
+        emu_extend_flash(flash.file, size);
+        flash.map = flash.file.map(0, size);
+        if(flash.map) {
+            flash.map_size = size;
+        } else {
+            qWarning() << "Failed to map emulated flash" << flash.file.fileName() << ", using file accesses";
+        }
+    }
+
+    return existed;
+}
+
+static void emu_flash_read(emu_flash_t & flash, int offset, uint8_t *buf, int length)
 {
-    if(flashFile.isOpen()) {
-        emu_extend_flash(flashFile, offset+length);
-        flashFile.seek(offset);
-        flashFile.read((char*)buf, length);
+    if(flash.map && (offset + length <= flash.map_size)) {
+        memcpy(buf, flash.map + offset, length);
+
+    } else if(flash.file.isOpen()) {
+        emu_extend_flash(flash.file, offset+length);
+        flash.file.seek(offset);
+        flash.file.read((char*)buf, length);
 
     } else {
         memset(buf, 0xff, length);
     }
 }
 
-static void emu_flash_write(QFile & flashFile, int offset, uint8_t *buf, int length)
+static void emu_flash_write(emu_flash_t & flash, int offset, uint8_t *buf, int length)
 {
-    if(flashFile.isOpen()) {
-        emu_extend_flash(flashFile, offset+length);
-        flashFile.seek(offset);
-        flashFile.write((char*)buf, length);
-        flashFile.flush();
+    if(flash.map && (offset + length <= flash.map_size)) {
+        memcpy(flash.map + offset, buf, length);
+
+    } else if(flash.file.isOpen()) {
+        emu_extend_flash(flash.file, offset+length);
+        flash.file.seek(offset);
+        flash.file.write((char*)buf, length);
+        flash.file.flush();
     }
 }
 
-BOOL emu_eeprom_open()
+static void emu_flash_sync(emu_flash_t & flash)
+{
+    if(!flash.map)
+        return;
+
+#ifdef WIN32
+    FlushViewOfFile(flash.map, flash.map_size);
+#else
+    msync(flash.map, flash.map_size, MS_SYNC);
+#endif
+}
+
+void emu_storage_set_mmap(BOOL enable)
+{
+    use_mmap = enable;
+}
+
+void emu_storage_sync(void)
+{
+    emu_flash_sync(eeprom);
+    emu_flash_sync(dbflash);
+}
+
+BOOL emu_eeprom_open(int size)
 {
-    return emu_open_flash(eeprom);
+    return emu_open_flash(eeprom, size);
 }
 
 void emu_eeprom_read(int offset, uint8_t *buf, int length)
@@ -64,9 +123,9 @@ void emu_eeprom_write(int offset, uint8_t *buf, int length)
     return emu_flash_write(eeprom, offset, buf, length);
 }
 
-BOOL emu_dbflash_open()
+BOOL emu_dbflash_open(int size)
 {
-    return emu_open_flash(dbflash);
+    return emu_open_flash(dbflash, size);
 }
 
 void emu_dbflash_read(int offset, uint8_t *buf, int length)
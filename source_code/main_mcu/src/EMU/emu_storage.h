@@ -7,11 +7,15 @@
 extern "C" {
 #endif
 
-BOOL emu_eeprom_open(void);
+/* mmap backed storage (default), call emu_storage_sync() to write it back to disk */
+void emu_storage_set_mmap(BOOL enable);
+void emu_storage_sync(void);
+
+BOOL emu_eeprom_open(int size);
 void emu_eeprom_read(int offset, uint8_t *buf, int length);
 void emu_eeprom_write(int offset, uint8_t *buf, int length);
 
-BOOL emu_dbflash_open(void);
+BOOL emu_dbflash_open(int size);
 void emu_dbflash_read(int offset, uint8_t *buf, int length);
 void emu_dbflash_write(int offset, uint8_t *buf, int length);
 
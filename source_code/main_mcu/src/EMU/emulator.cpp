@@ -2,24 +2,34 @@ extern "C" {
 #include "asf.h"
 #include "driver_timer.h"
 #include "emulator.h"
+#include "emu_aux_mcu.h"
 #include "inputs.h"
 #include "logic_power.h"
 }
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QScopedPointer>
 #include <QThread>
 #include <QTimer>
 #include <QWidget>
 #include <QSemaphore>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInteger>
 #include <QTime>
 #include <QLocalSocket>
 #include <QCommandLineParser>
 #include <QElapsedTimer>
+#include <unistd.h>
+#include <string.h>
 
 #include "emu_oled.h"
 #include "emu_smartcard.h"
 #include "emu_dataflash.h"
+#include "emu_storage.h"
+#include "emu_script.h"
+#include "qt_metacall_helper.h"
 #include "emulator_ui.h"
 
 static struct emu_port_t _PORT;
@@ -37,9 +47,24 @@ void cpu_irq_leave_critical(void)
     irq_mutex.unlock();
 }
 
-static void pseudo_irq(void)
+/* Number of pseudo irqs run so far, i.e. emulated time in ms */
+static uint64_t pseudo_irq_count;
+
+/* Headless mode: no UI, time only advances when the app thread waits */
+static bool headless = false;
+static uint32_t virtual_clock_us_remainder;
+
+// see TIMER/driver_timer.c
+extern "C" volatile uint32_t timer_next_deadline;
+extern "C" volatile BOOL timer_next_deadline_armed;
+
+// an emulated input changed, wake the idle app thread once the next pseudo irq has scanned it
+static QAtomicInt idle_wake_pending;
+static void idle_wake_app(void);
+
+// called with irq_mutex held, releases it
+static void pseudo_irq_run(void)
 {
-    irq_mutex.lock();
     timer_ms_tick();
 
     /* Scan buttons */
@@ -48,31 +73,271 @@ static void pseudo_irq(void)
     /* Power logic */
     logic_power_ms_tick();
 
+    bool wake_app = idle_wake_pending.testAndSetOrdered(1, 0);
+
     irq_mutex.unlock();
+
+    if(wake_app && !headless)
+        idle_wake_app();
+
+    // scripted inputs need to take irq_mutex themselves
+    emu_script_tick(++pseudo_irq_count);
+}
+
+static void pseudo_irq(void)
+{
+    irq_mutex.lock();
+    pseudo_irq_run();
+}
+
+static void virtual_clock_advance(uint32_t ms)
+{
+    for(; ms > 0; ms--) {
+        // waiting from a critical section: "interrupts" are masked, time stands still
+        if(!irq_mutex.tryLock())
+            return;
+
+        pseudo_irq_run();
+    }
+}
+
+void emu_delay_us(uint32_t us)
+{
+    if(!headless) {
+        usleep(us);
+        return;
+    }
+
+    virtual_clock_us_remainder += us;
+    virtual_clock_advance(virtual_clock_us_remainder / 1000);
+    virtual_clock_us_remainder %= 1000;
+}
+
+void emu_timer_polled(int timer_id)
+{
+    static int last_timer_id = -1;
+    static uint64_t last_poll_ms;
+
+    if(!headless)
+        return;
+
+    // the same timer polled twice without time passing in between: busy wait
+    if((timer_id == last_timer_id) && (last_poll_ms == pseudo_irq_count))
+        virtual_clock_advance(1);
+
+    last_timer_id = timer_id;
+    last_poll_ms = pseudo_irq_count;
 }
 
 extern "C" void minible_main();
 
-class AppThread: public QThread {
+/* Lock-free single producer single consumer byte ring */
+template <int SIZE>
+class SpscRing {
+    static_assert((SIZE & (SIZE-1)) == 0, "ring size must be a power of 2");
+
+    char buf[SIZE];
+    QAtomicInteger<quint32> head;   // only written by the producer
+    QAtomicInteger<quint32> tail;   // only written by the consumer
+
+public:
+    SpscRing(): head(0), tail(0) {}
+
+    bool empty() const { return head.loadAcquire() == tail.loadAcquire(); }
+    quint32 write_pos() const { return head.loadAcquire(); }
+
+    // producer side, returns the number of bytes stored
+    int write(const char *data, int size) {
+        quint32 h = head.loadAcquire();
+        int nb = qMin(size, (int)(SIZE - (h - tail.loadAcquire())));
+
+        for(int i = 0; i < nb; i++)
+            buf[(h + i) & (SIZE-1)] = data[i];
+
+        head.storeRelease(h + nb);
+        return nb;
+    }
+
+    // consumer side, returns the number of bytes fetched
+    int read(char *data, int size) {
+        quint32 t = tail.loadAcquire();
+        int nb = qMin(size, (int)(head.loadAcquire() - t));
+
+        for(int i = 0; i < nb; i++)
+            data[i] = buf[(t + i) & (SIZE-1)];
+
+        tail.storeRelease(t + nb);
+        return nb;
+    }
+
+    // consumer side, drop everything written before pos
+    void discard_to(quint32 pos) {
+        tail.storeRelease(pos);
+    }
+};
+
+/* Local socket to moolticuted, owned by the Qt thread.
+ * The app thread only goes through the rings and never touches the socket.
+ */
+class HidTransport: public QObject {
 private:
-    QMutex appexit_mutex;
-    bool app_exiting = false;
-    QSemaphore app_thread_blocked;
+    QLocalSocket socket;
+    QTimer reconnect_timer;
+
+    SpscRing<1<<16> rx_ring;
+    SpscRing<1<<16> tx_ring;
+
+    // rx data left in the socket because rx_ring was full
+    QAtomicInt rx_stalled;
+    QAtomicInt tx_flush_pending;
+
+    // bumped on each new connection, stale rx bytes are dropped by the app thread
+    QAtomicInt connected;
+    QAtomicInt connection_id;
+    QAtomicInteger<quint32> connection_rx_pos;
+    int app_connection_id = 0;
+
+    // wakes the app thread on rx data or input changes / tx room
+    QMutex event_mutex;
+    QWaitCondition rx_event;
+    QWaitCondition tx_event;
+    bool app_wake_pending = false;
+
+    void socket_read() {
+        char buf[4096];
+
+        rx_stalled.storeRelease(0);
+        while(socket.bytesAvailable() > 0) {
+            int nb = socket.peek(buf, sizeof(buf));
+            nb = rx_ring.write(buf, nb);
+            socket.read(buf, nb);
+
+            if(nb == 0) {
+                rx_stalled.storeRelease(1);
+                break;
+            }
+        }
+
+        event_mutex.lock();
+        rx_event.wakeAll();
+        event_mutex.unlock();
+    }
+
+    void socket_flush() {
+        char buf[4096];
+        int nb;
+
+        tx_flush_pending.storeRelease(0);
+        while((nb = tx_ring.read(buf, sizeof(buf))) > 0) {
+            if(connected.loadAcquire())
+                socket.write(buf, nb);
+        }
+
+        event_mutex.lock();
+        tx_event.wakeAll();
+        event_mutex.unlock();
+    }
 
-    QLocalSocket *hid;
+    void socket_state_changed(QLocalSocket::LocalSocketState state) {
+        if(state == QLocalSocket::ConnectedState) {
+            connection_rx_pos.storeRelease(rx_ring.write_pos());
+            connection_id.fetchAndAddOrdered(1);
+            connected.storeRelease(1);
+            reconnect_timer.stop();
 
-    bool reconnect_hid() {
-        if(hid->state() != QLocalSocket::ConnectedState) {
-            hid->connectToServer("moolticuted_local_dev");
-            hid->waitForConnected(10);
+        } else if(state == QLocalSocket::UnconnectedState) {
+            connected.storeRelease(0);
+            reconnect_timer.start();
         }
-        
-        return hid->state() == QLocalSocket::ConnectedState;
     }
 
+public:
+    HidTransport() {
+        connect(&socket, &QLocalSocket::readyRead, this, &HidTransport::socket_read);
+        connect(&socket, &QLocalSocket::stateChanged, this, &HidTransport::socket_state_changed);
+
+        // moolticuted may come and go, poll for it while disconnected
+        reconnect_timer.setInterval(100);
+        connect(&reconnect_timer, &QTimer::timeout, this, [this]() {
+            if(socket.state() == QLocalSocket::UnconnectedState)
+                socket.connectToServer("moolticuted_local_dev");
+        });
+        reconnect_timer.start();
+        socket.connectToServer("moolticuted_local_dev");
+    }
+
+    // app thread
+    void send(const char *data, int size) {
+        if(!connected.loadAcquire())
+            return;
+
+        while(size > 0) {
+            int nb = tx_ring.write(data, size);
+            data += nb;
+            size -= nb;
+
+            if(tx_flush_pending.testAndSetOrdered(0, 1))
+                postToObject([this]() { socket_flush(); }, this);
+
+            if(size > 0) {
+                // ring full, wait for the Qt thread to drain it
+                event_mutex.lock();
+                tx_event.wait(&event_mutex, 10);
+                event_mutex.unlock();
+                emu_appexit_test();
+            }
+        }
+    }
+
+    // app thread
+    int receive(char *data, int size) {
+        if(!connected.loadAcquire())
+            return -1;
+
+        int id = connection_id.loadAcquire();
+        if(id != app_connection_id) {
+            // new connection: drop what is left from the previous one and have the caller reset its state
+            rx_ring.discard_to(connection_rx_pos.loadAcquire());
+            app_connection_id = id;
+            return -1;
+        }
+
+        int nb = rx_ring.read(data, size);
+
+        if((nb > 0) && rx_stalled.testAndSetOrdered(1, 0))
+            postToObject([this]() { socket_read(); }, this);
+
+        return nb;
+    }
+
+    // any thread
+    void wake_app() {
+        event_mutex.lock();
+        app_wake_pending = true;
+        rx_event.wakeAll();
+        event_mutex.unlock();
+    }
+
+    // app thread
+    void wait_for_rx(unsigned long ms) {
+        event_mutex.lock();
+        if(rx_ring.empty() && !app_wake_pending)
+            rx_event.wait(&event_mutex, ms);
+        app_wake_pending = false;
+        event_mutex.unlock();
+    }
+};
+
+static HidTransport *hid_transport;
+
+class AppThread: public QThread {
+private:
+    QMutex appexit_mutex;
+    bool app_exiting = false;
+    QSemaphore app_thread_blocked;
+
 public:
     void run() {
-        hid = new QLocalSocket;
         minible_main();
     }
 
@@ -93,33 +358,6 @@ public:
 
         appexit_mutex.unlock();
     }
-
-    void send_hid(char *data, int size) {
-        if(!reconnect_hid())
-            return;
-
-        while(size > 0) {
-            int nb = hid->write(data, size);
-            if(nb <= 0)
-                break;
-
-            data += nb;
-            size -= nb;
-
-            while(hid->bytesToWrite() > 0 && hid->state() == QLocalSocket::ConnectedState)
-                hid->waitForBytesWritten();
-        }
-    }
-
-    int rcv_hid(char *data, int size) {
-        test_stop();
-        if(!reconnect_hid())
-            return -1;
-
-        hid->waitForReadyRead(0);
-        int nb = hid->read(data, size);
-        return nb > 0 ? nb : 0;
-    }
 };
 
 AppThread app_thread;
@@ -132,12 +370,45 @@ OLEDWidget *oled;
 
 void emu_send_hid(char *data, int size)
 {
-    app_thread.send_hid(data, size);
+    hid_transport->send(data, size);
 }
 
 int emu_rcv_hid(char *data, int size)
 {
-    return app_thread.rcv_hid(data, size);
+    emu_appexit_test();
+    return hid_transport->receive(data, size);
+}
+
+void emu_idle_wake(void)
+{
+    idle_wake_pending.storeRelease(1);
+}
+
+static void idle_wake_app(void)
+{
+    hid_transport->wake_app();
+}
+
+void emu_idle_wait(void)
+{
+    if(headless) {
+        emu_delay_us(1000);
+        return;
+    }
+
+    // the emulated aux mcu still has a message to hand over
+    if(emu_aux_has_pending_rx())
+        return;
+
+    // sleep until the earliest armed timer expires, returns early when moolticuted sends something or an input changes
+    // no irq_mutex here as we may be called from a critical section, a stale deadline only shortens the wait
+    uint32_t wait_ms = EMU_IDLE_MAX_WAIT_MS;
+    if(timer_next_deadline_armed != FALSE) {
+        int32_t deadline_ms = (int32_t)(timer_next_deadline - timer_get_systick());
+        wait_ms = (uint32_t)qBound(1, deadline_ms, EMU_IDLE_MAX_WAIT_MS);
+    }
+
+    hid_transport->wait_for_rx(wait_ms);
 }
 
 static QElapsedTimer systick_timer;
@@ -148,7 +419,7 @@ BOOL emu_get_systick(uint32_t *value)
 {
     systick_mutex.lock();
     // milliseconds to 48MHz ticks
-    uint64_t systick = systick_timer.elapsed() * (uint64_t)48000;
+    uint64_t systick = (headless ? pseudo_irq_count : systick_timer.elapsed()) * (uint64_t)48000;
     BOOL wrapped = FALSE;
     if((systick & 0xffffff) != (last_systick & 0xffffff))
         wrapped = TRUE;
@@ -160,12 +431,22 @@ BOOL emu_get_systick(uint32_t *value)
     return wrapped;
 }
 
+uint32_t emu_get_timestamp_us(void)
+{
+    return (uint32_t)(systick_timer.nsecsElapsed() / 1000);
+}
+
 int main(int ac, char ** av)
 {
+    // the application type has to be known before parsing the command line
+    for(int i = 1; i < ac; i++)
+        if(strcmp(av[i], "--headless") == 0)
+            headless = true;
+
     // Qt needs to run on the main thread. We run the application code on a separate thread
     // (1) to ensure responsiveness when the main code blocks
     // (2) to have our input behave in an interrupt-like manner
-    QApplication app(ac, av);
+    QScopedPointer<QCoreApplication> app(headless ? new QCoreApplication(ac, av) : new QApplication(ac, av));
 
     // ensure that the calendar works in UTC, so that time doesn't shift unpredictably
     qputenv("TZ", "");
@@ -177,11 +458,34 @@ int main(int ac, char ** av)
 
     parser.addOption(QCommandLineOption("smartcard", "Smartcard file to be used at startup", "smartcard"));
     parser.addOption(QCommandLineOption("bundle", "Specify path to bundle.img file", "bundle"));
-    parser.process(app);
+    parser.addOption(QCommandLineOption("no-mmap", "Use file reads/writes instead of memory mapped storage"));
+    parser.addOption(QCommandLineOption("sync-interval", "Memory mapped storage sync interval in ms, 0 to only sync at exit", "ms", "1000"));
+    parser.addOption(QCommandLineOption("headless", "Run without UI, on a virtual clock advancing as fast as the device code waits"));
+    parser.addOption(QCommandLineOption("script", "Input script to run, see emu_script.h", "script"));
+    parser.process(*app);
+
+    if(parser.isSet("script") && !emu_script_load(parser.value("script")))
+        return 1;
+
+    bool use_mmap = !parser.isSet("no-mmap");
+    emu_storage_set_mmap(use_mmap);
+
+    // mapped storage is only written back to disk when explicitly synced
+    QTimer storage_sync_timer;
+    int sync_interval = parser.value("sync-interval").toInt();
+    if(use_mmap && (sync_interval > 0)) {
+        storage_sync_timer.setInterval(sync_interval);
+        storage_sync_timer.start();
+        QObject::connect(&storage_sync_timer, &QTimer::timeout, [] () {
+            emu_storage_sync();
+        });
+    }
 
+    // in headless mode the app thread drives the pseudo irqs through emu_delay_us()/emu_timer_polled()
     QTimer ms_timer;
     ms_timer.setInterval(1);
-    ms_timer.start();
+    if(!headless)
+        ms_timer.start();
 
     QObject::connect(&ms_timer, &QTimer::timeout, [] () {
         // the OS will most likely not schedule our timer with 1ms frequency,
@@ -191,22 +495,29 @@ int main(int ac, char ** av)
             pseudo_irq();
     });
 
-    oled = new OLEDWidget;
+    if(!headless)
+        oled = new OLEDWidget;
 
     if(parser.isSet("smartcard"))
         emu_insert_smartcard(parser.value("smartcard"));
 
-    emu_dataflash_init(parser.value("bundle").toUtf8().constData());
+    emu_dataflash_init(parser.value("bundle").toUtf8().constData(), use_mmap ? TRUE : FALSE);
 
-    EmuWindow emu_window;
-    emu_window.show();
+    QScopedPointer<EmuWindow> emu_window;
+    if(!headless) {
+        emu_window.reset(new EmuWindow);
+        emu_window->show();
+        oled->show();
+    }
 
-    oled->show();
+    hid_transport = new HidTransport;
     app_thread.start();
 
-    app.exec();
+    app->exec();
 
     app_thread.stop();
+    emu_storage_sync();
+    emu_smartcard_sync();
 
     delete oled;
     return 0;
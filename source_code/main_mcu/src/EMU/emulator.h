@@ -18,11 +18,23 @@ void emu_appexit_test(void);
 void emu_send_hid(char *data, int size);
 int emu_rcv_hid(char *data, int size);
 
+/* idle wait in the main loop: until the next timer deadline, hid data or an input change, at most EMU_IDLE_MAX_WAIT_MS */
+#define EMU_IDLE_MAX_WAIT_MS 50
+void emu_idle_wait(void);
+/* called when an emulated input changed, so that the idle main loop looks at it */
+void emu_idle_wake(void);
+
 int emu_get_battery_level(void);
 BOOL emu_get_usb_charging(void);
 void emu_charger_enable(BOOL en);
 
 BOOL emu_get_systick(uint32_t *value);
+/* real time, also in headless mode, to measure short durations */
+uint32_t emu_get_timestamp_us(void);
+
+/* waits go through these so that headless runs can use a virtual clock */
+void emu_delay_us(uint32_t us);
+void emu_timer_polled(int timer_id);
 
 BOOL emu_get_lefthanded(void);
 
@@ -7,11 +7,16 @@
 #include <QMenu>
 #include <QFileDialog>
 #include <QCheckBox>
+#include <QLabel>
+#include <QFontDatabase>
 #include <QMutex>
 #include <QTimer>
 
 #include "emulator.h"
 #include "emu_smartcard.h"
+extern "C" {
+#include "flash_stats.h"
+}
 
 EmuWindow::EmuWindow()
 {
@@ -30,6 +35,11 @@ EmuWindow::EmuWindow()
     
     auto fail = createFailuresUi();
     layout->addRow("Failures", fail);
+
+#ifdef FLASH_STATS_ENABLED
+    auto flash_stats = createFlashStatsUi();
+    layout->addRow("Flash", flash_stats);
+#endif
 }
 
 QWidget *EmuWindow::createSmartcardUi() 
@@ -229,3 +239,41 @@ QWidget *EmuWindow::createFailuresUi()
 
     return col_failures;
 }
+
+#ifdef FLASH_STATS_ENABLED
+QWidget *EmuWindow::createFlashStatsUi()
+{
+    auto col_stats = new QWidget(this);
+    auto layout = new QBoxLayout(QBoxLayout::TopToBottom, col_stats);
+    layout->setContentsMargins(0,0,0,0);
+
+    auto label = new QLabel();
+    label->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    layout->addWidget(label);
+
+    // counters are only ever incremented by the firmware thread, a racy read or reset is fine here
+    auto reset = new QPushButton("reset");
+    QObject::connect(reset, &QPushButton::clicked, this, []() {
+        flash_stats_reset();
+    });
+    layout->addWidget(reset);
+
+    auto refresh = new QTimer(this);
+    QObject::connect(refresh, &QTimer::timeout, this, [label]() {
+        const char *categories[FLASH_STATS_NB_CATEGORIES] = {"nodemgmt", "gui", "fonts", "bitmaps", "settings"};
+        flash_stats_counters_t *counters = flash_stats_get_counters();
+        QStringList lines;
+
+        for(int i=0;i<FLASH_STATS_NB_CATEGORIES;i++) {
+            lines << QString::asprintf("%-8s %7u rd %9u B %7u wr %9u B %9u us", categories[i],
+                                       counters[i].nb_reads, counters[i].nb_bytes_read,
+                                       counters[i].nb_writes, counters[i].nb_bytes_written,
+                                       counters[i].time_spent_us);
+        }
+        label->setText(lines.join("\n"));
+    });
+    refresh->start(500);
+
+    return col_stats;
+}
+#endif
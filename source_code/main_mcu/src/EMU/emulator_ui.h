@@ -13,6 +13,7 @@ private:
     QWidget *createChargerUi();
     QWidget *createAccelerometerUi();
     QWidget *createFailuresUi();
+    QWidget *createFlashStatsUi();
 };
 
 #endif
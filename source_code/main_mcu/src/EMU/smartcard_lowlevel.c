@@ -41,6 +41,9 @@ det_ret_type_te smartcard_lowlevel_is_card_plugged(void)
             smartcard_status = RETURN_REL;
         else if(smartcard_status != RETURN_REL)
             smartcard_status = RETURN_JRELEASED;
+
+        /* swapped card: present from the next poll on, so that the removal is always seen */
+        emu_complete_smartcard_swap();
     }
 
     return smartcard_status;
@@ -28,6 +28,7 @@
 #include "platform_defines.h"
 #include "driver_sercom.h"
 #include "logic_device.h"
+#include "flash_stats.h"
 #include "custom_fs.h"
 #include "dataflash.h"
 #include "utils.h"
@@ -89,6 +90,8 @@ custom_fs_address_t custom_fs_usb_keyboard_layout_addr = 0;
 uint8_t custom_fs_cur_usb_keyboard_id = 0;
 custom_fs_address_t custom_fs_ble_keyboard_layout_addr = 0;
 uint8_t custom_fs_cur_ble_keyboard_id = 0;
+/* Decoded keyboard layout, for the last interface typed on */
+custom_fs_keyboard_lut_t custom_fs_keyboard_lut;
 /* CPZ look up table */
 cpz_lut_entry_t* custom_fs_cpz_lut;
 
@@ -157,7 +160,9 @@ RET_TYPE custom_fs_read_from_flash(uint8_t* datap, custom_fs_address_t address,
     } 
     else
     {
+        FLASH_STATS_ACCESS_START();
         dataflash_read_data_array(custom_fs_dataflash_desc, address, datap, size);
+        FLASH_STATS_ACCESS_END(FLASH_STATS_CAT_GUI, FALSE, size);
         //memcpy(datap, &mooltipass_bundle[address], size);
     }
     return RETURN_OK;
@@ -213,6 +218,8 @@ RET_TYPE custom_fs_continuous_read_from_flash(uint8_t* datap, custom_fs_address_
     }
     else
     {
+        FLASH_STATS_ACCESS_START();
+        
         /* Check if we have opened the SPI bus */
         if (custom_fs_data_bus_opened == FALSE)
         {
@@ -230,7 +237,8 @@ RET_TYPE custom_fs_continuous_read_from_flash(uint8_t* datap, custom_fs_address_
         {
             /* Read data */
             dataflash_read_bytes_from_opened_transfer(custom_fs_dataflash_desc, datap, size);
-        }        
+        }
+        FLASH_STATS_ACCESS_END(FLASH_STATS_CAT_GUI, FALSE, size);
     }
     
     return RETURN_OK;
@@ -242,7 +250,6 @@ RET_TYPE custom_fs_continuous_read_from_flash(uint8_t* datap, custom_fs_address_
 */
 RET_TYPE custom_fs_compute_and_check_external_bundle_crc32(void)
 {
-#ifndef EMULATOR_BUILD
     /* Start a read on external flash */
     dataflash_read_data_array_start(custom_fs_dataflash_desc, CUSTOM_FS_FILES_ADDR_OFFSET + sizeof(custom_fs_flash_header.magic_header) + sizeof(custom_fs_flash_header.total_size) + sizeof(custom_fs_flash_header.crc32));
 
@@ -267,11 +274,6 @@ RET_TYPE custom_fs_compute_and_check_external_bundle_crc32(void)
     {
         return RETURN_NOK;
     }
-
-#else
-    /* We don't emulate the DMA controller, and don't bother with reimplementing the crc32 routines */
-    return RETURN_OK;
-#endif
 }
 
 /*! \fn     custom_fs_stop_continuous_read_from_flash(BOOL was_using_emergency_bundle_data)
@@ -390,6 +392,7 @@ uint32_t custom_fs_get_number_of_keyb_layouts(void)
 ret_type_te custom_fs_get_keyboard_descriptor_string(uint8_t keyboard_id, cust_char_t* string_pt)
 {
     custom_fs_address_t layout_file_addr;
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_SETTINGS);
     
     /* Try to fetch layout file address */
     ret_type_te file_address_found = custom_fs_get_file_address((uint32_t)keyboard_id, &layout_file_addr, CUSTOM_FS_BINARY_TYPE);
@@ -397,16 +400,58 @@ ret_type_te custom_fs_get_keyboard_descriptor_string(uint8_t keyboard_id, cust_c
     /* Check for success */
     if (file_address_found != RETURN_OK)
     {
+        FLASH_STATS_CATEGORY_EXIT();
         return RETURN_NOK;
     }
     
     /* Load description, 0 terminate it in case */
     custom_fs_read_from_flash((uint8_t*)string_pt, CUSTOM_FS_FILES_ADDR_OFFSET + layout_file_addr, CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t));
     string_pt[CUSTOM_FS_KEYBOARD_DESC_LGTH-1] = 0;
+    FLASH_STATS_CATEGORY_EXIT();
     
     return RETURN_OK;
 }
 
+/*! \fn     custom_fs_load_keyboard_lut(custom_fs_keyboard_lut_t* lut_pt, custom_fs_address_t layout_addr)
+*   \brief  Load a keyboard layout LUT: description intervals and as many symbols as possible
+*   \param  lut_pt          Pointer to the LUT to load
+*   \param  layout_addr     Layout file address
+*   \note   USB and BLE share the LUT: it is only reloaded when typing on an interface with a different layout
+*/
+static void custom_fs_load_keyboard_lut(custom_fs_keyboard_lut_t* lut_pt, custom_fs_address_t layout_addr)
+{
+    uint16_t nb_described_symbols = 0;
+    
+    /* Already loaded? */
+    if (lut_pt->layout_addr == layout_addr)
+    {
+        return;
+    }
+    
+    /* Load the description intervals */
+    custom_fs_read_from_flash((uint8_t*)lut_pt->intervals, layout_addr + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t), sizeof(lut_pt->intervals));
+    
+    /* Compute where the symbols of each interval start, no valid interval means no symbol */
+    lut_pt->nb_symbols_in_lut = 0;
+    for (uint16_t i = 0; i < ARRAY_SIZE(lut_pt->intervals); i++)
+    {
+        lut_pt->intervals_symbol_offset[i] = nb_described_symbols;
+        if (lut_pt->intervals[i].interval_start != 0xFFFF)
+        {
+            lut_pt->nb_symbols_in_lut = nb_described_symbols + lut_pt->intervals[i].interval_end - lut_pt->intervals[i].interval_start + 1;
+        }
+        nb_described_symbols += lut_pt->intervals[i].interval_end - lut_pt->intervals[i].interval_start + 1;
+    }
+    
+    /* Load the symbols that fit in the LUT */
+    if (lut_pt->nb_symbols_in_lut > ARRAY_SIZE(lut_pt->symbols))
+    {
+        lut_pt->nb_symbols_in_lut = ARRAY_SIZE(lut_pt->symbols);
+    }
+    custom_fs_read_from_flash((uint8_t*)lut_pt->symbols, layout_addr + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t) + sizeof(lut_pt->intervals), lut_pt->nb_symbols_in_lut*sizeof(lut_pt->symbols[0]));
+    lut_pt->layout_addr = layout_addr;
+}
+
 /*! \fn     custom_fs_set_current_keyboard_id(uint8_t keyboard_id, BOOL usb_layout)
 *   \brief  Set current keyboard ID
 *   \param  keyboard_id     Keyboard ID
@@ -418,11 +463,13 @@ ret_type_te custom_fs_set_current_keyboard_id(uint8_t keyboard_id, BOOL usb_layo
     custom_fs_address_t layout_file_addr;
     
     /* Try to fetch layout file address */
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_SETTINGS);
     ret_type_te file_address_found = custom_fs_get_file_address((uint32_t)keyboard_id, &layout_file_addr, CUSTOM_FS_BINARY_TYPE);
     
     /* Check for success */
     if (file_address_found != RETURN_OK)
     {
+        FLASH_STATS_CATEGORY_EXIT();
         return RETURN_NOK;
     }
     
@@ -437,6 +484,7 @@ ret_type_te custom_fs_set_current_keyboard_id(uint8_t keyboard_id, BOOL usb_layo
         custom_fs_usb_keyboard_layout_addr = layout_file_addr;
         custom_fs_cur_usb_keyboard_id = keyboard_id;
     }
+    FLASH_STATS_CATEGORY_EXIT();
     
     return RETURN_OK;
 }
@@ -448,15 +496,14 @@ ret_type_te custom_fs_set_current_keyboard_id(uint8_t keyboard_id, BOOL usb_layo
 *   \param  usb_layout  Set to TRUE to use USB layout mapping, FALSE for BLE layout mapping
 *   \return RETURN_(N)OK depending on if we were able to "translate" the complete string
 *   \note   Take care of buffer overflows. One symbol will be generated per unicode point
+*   \note   Symbols not fitting in the layout LUT are read from flash
 */
 ret_type_te custom_fs_get_keyboard_symbols_for_unicode_string(cust_char_t* string_pt, uint16_t* buffer, BOOL usb_layout)
 {
-    unicode_interval_desc_t description_intervals[CUSTOM_FS_KEYB_NB_INT_DESCRIBED];
-    custom_fs_address_t layout_address = custom_fs_usb_keyboard_layout_addr;
+    custom_fs_keyboard_lut_t* lut_pt = &custom_fs_keyboard_lut;
     BOOL point_support_described = FALSE;
     uint16_t symbol_desc_pt_offset = 0;
     BOOL all_points_described = TRUE;
-    uint16_t interval_start = 0;
     
     /* Check for correctly setup keyboard layout */
     if ((custom_fs_usb_keyboard_layout_addr == 0) || (custom_fs_ble_keyboard_layout_addr == 0))
@@ -464,14 +511,16 @@ ret_type_te custom_fs_get_keyboard_symbols_for_unicode_string(cust_char_t* strin
         return RETURN_NOK;
     }   
     
-    /* Mapping address based on layout selection */
+    /* Mapping based on layout selection */
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_SETTINGS);
     if (usb_layout == FALSE)
     {
-        layout_address = custom_fs_ble_keyboard_layout_addr;
+        custom_fs_load_keyboard_lut(lut_pt, custom_fs_ble_keyboard_layout_addr);
+    }
+    else
+    {
+        custom_fs_load_keyboard_lut(lut_pt, custom_fs_usb_keyboard_layout_addr);
     }
-    
-    /* Load the description intervals */
-    custom_fs_read_from_flash((uint8_t*)description_intervals, layout_address + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t), sizeof(description_intervals));
     
     /* Iterate over string */
     while (*string_pt != 0)
@@ -479,21 +528,17 @@ ret_type_te custom_fs_get_keyboard_symbols_for_unicode_string(cust_char_t* strin
         /* Reset vars */
         point_support_described = FALSE;
         symbol_desc_pt_offset = 0;
-        interval_start = 0;
         
         /* Check that support for this point is described */
-        for (uint16_t i = 0; i < ARRAY_SIZE(description_intervals); i++)
+        for (uint16_t i = 0; i < ARRAY_SIZE(lut_pt->intervals); i++)
         {
             /* Check if char is within this interval */
-            if ((description_intervals[i].interval_start != 0xFFFF) && (description_intervals[i].interval_start <= *string_pt) && (description_intervals[i].interval_end >= *string_pt))
+            if ((lut_pt->intervals[i].interval_start != 0xFFFF) && (lut_pt->intervals[i].interval_start <= *string_pt) && (lut_pt->intervals[i].interval_end >= *string_pt))
             {
-                interval_start = description_intervals[i].interval_start;
+                symbol_desc_pt_offset = lut_pt->intervals_symbol_offset[i] + (*string_pt - lut_pt->intervals[i].interval_start);
                 point_support_described = TRUE;
                 break;
             }
-            
-            /* Add offset to descriptor */
-            symbol_desc_pt_offset += description_intervals[i].interval_end - description_intervals[i].interval_start + 1;
         }
         
         /* Check for described point support */
@@ -517,7 +562,14 @@ ret_type_te custom_fs_get_keyboard_symbols_for_unicode_string(cust_char_t* strin
         else
         {
             /* Fetch keyboard symbol: 0xFFFF for "not supported" matches with our definition of not described */
-            custom_fs_read_from_flash((uint8_t*)buffer, layout_address + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t) + sizeof(description_intervals) + symbol_desc_pt_offset*sizeof(*string_pt) + (*string_pt - interval_start)*sizeof(*string_pt), sizeof(*buffer));       
+            if (symbol_desc_pt_offset < lut_pt->nb_symbols_in_lut)
+            {
+                *buffer = lut_pt->symbols[symbol_desc_pt_offset];
+            }
+            else
+            {
+                custom_fs_read_from_flash((uint8_t*)buffer, lut_pt->layout_addr + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t) + sizeof(lut_pt->intervals) + symbol_desc_pt_offset*sizeof(*string_pt), sizeof(*buffer));
+            }
             
             /* Is this symbol supported? */
             if (*buffer == 0xFFFF)
@@ -530,6 +582,7 @@ ret_type_te custom_fs_get_keyboard_symbols_for_unicode_string(cust_char_t* strin
         string_pt++;
         buffer++;
     }
+    FLASH_STATS_CATEGORY_EXIT();
     
     /* Return depending on if we were able to translate all the string */
     if (all_points_described == FALSE)
@@ -556,6 +609,7 @@ ret_type_te custom_fs_set_current_language(uint8_t language_id)
     }
     
     /* Load address to language map table */
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_SETTINGS);
     custom_fs_address_t language_map_table_addr;
     custom_fs_read_from_flash((uint8_t*)&language_map_table_addr, CUSTOM_FS_FILES_ADDR_OFFSET + custom_fs_flash_header.language_map_offset, sizeof(language_map_table_addr));
     
@@ -568,6 +622,7 @@ ret_type_te custom_fs_set_current_language(uint8_t language_id)
     {
         custom_fs_read_from_flash((uint8_t*)&custom_fs_current_text_file_string_count, custom_fs_current_text_file_addr, sizeof(custom_fs_current_text_file_string_count));
     }
+    FLASH_STATS_CATEGORY_EXIT();
     
     /* Language changed, stored current language ID */
     custom_fs_cur_language_id = language_id;
@@ -590,12 +645,14 @@ ret_type_te custom_fs_get_language_description(uint8_t language_id, cust_char_t*
     }
     
     /* Load address to language map table */
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_SETTINGS);
     custom_fs_address_t language_map_table_addr;
     custom_fs_read_from_flash((uint8_t*)&language_map_table_addr, CUSTOM_FS_FILES_ADDR_OFFSET + custom_fs_flash_header.language_map_offset, sizeof(language_map_table_addr));
     
     /* Load language map entry, 0 terminate it in case */
     custom_fs_read_from_flash((uint8_t*)string_pt, CUSTOM_FS_FILES_ADDR_OFFSET + language_map_table_addr + (language_id*sizeof(custom_fs_cur_language_entry)), MEMBER_SIZE(language_map_entry_t,language_descr));
     string_pt[MEMBER_ARRAY_SIZE(language_map_entry_t,language_descr)-1] = 0;   
+    FLASH_STATS_CATEGORY_EXIT();
     
     return RETURN_OK; 
 }
@@ -652,6 +709,9 @@ ret_type_te custom_fs_init(void)
     #ifdef BOOTLOADER
         return RETURN_OK;
     #else
+        /* Keyboard layouts may have moved: reload the LUT when next used */
+        custom_fs_keyboard_lut.layout_addr = 0;
+        
         /* Fetch default language (if set) */
         uint8_t default_device_language = custom_fs_settings_get_device_setting(SETTING_DEVICE_DEFAULT_LANGUAGE);
     
@@ -981,7 +1041,7 @@ static uint8_t eeprom[256 * 128];
 
 static void custom_fs_init_custom_storage_slots(void)
 {
-    if(!emu_eeprom_open())
+    if(!emu_eeprom_open(sizeof(eeprom)))
         custom_fs_hard_reset_settings();
 
     emu_eeprom_read(0, eeprom, sizeof(eeprom));
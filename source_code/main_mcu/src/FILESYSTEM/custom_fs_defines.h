@@ -48,6 +48,7 @@
 /* Fields sizes */
 #define CUSTOM_FS_KEYBOARD_DESC_LGTH        20
 #define CUSTOM_FS_KEYB_NB_INT_DESCRIBED     20
+#define CUSTOM_FS_KEYB_LUT_NB_SYMBOLS       96      // Enough for the printable ASCII symbols, the others are read from flash
 
 /* Settings IDs */
 #define NB_DEVICE_SETTINGS                  64
@@ -237,4 +238,14 @@ typedef struct
     uint8_t reserved[6];
 } cpz_lut_entry_t;
 
+// Keyboard layout LUT: decoded intervals and first symbols of a layout
+typedef struct
+{
+    custom_fs_address_t layout_addr;
+    unicode_interval_desc_t intervals[CUSTOM_FS_KEYB_NB_INT_DESCRIBED];
+    uint16_t intervals_symbol_offset[CUSTOM_FS_KEYB_NB_INT_DESCRIBED];
+    uint16_t symbols[CUSTOM_FS_KEYB_LUT_NB_SYMBOLS];
+    uint16_t nb_symbols_in_lut;
+} custom_fs_keyboard_lut_t;
+
 #endif /* CUSTOM_FS_DEFINES_H_ */
@@ -61,29 +61,12 @@ void dataflash_write_array_to_memory(spi_flash_descriptor_t* descriptor_pt, uint
         /* Guaranteed to not go below 0 */
         length -= nb_bytes_to_write;
         
-        /* Write enable */
-        dataflash_send_write_enable(descriptor_pt);
+        /* Program page */
+        dataflash_write_page_without_wait(descriptor_pt, address, data, nb_bytes_to_write);
         
-        /* SS low */
-        PORT->Group[descriptor_pt->cs_pin_group].OUTCLR.reg = descriptor_pt->cs_pin_mask;
-        
-        /* Send write command */
-        sercom_spi_send_single_byte(descriptor_pt->sercom_pt, 0x02);
-        sercom_spi_send_single_byte(descriptor_pt->sercom_pt, (uint8_t)((address >> 16) & 0x0FF));
-        sercom_spi_send_single_byte(descriptor_pt->sercom_pt, (uint8_t)((address >> 8) & 0x0FF));
-        sercom_spi_send_single_byte(descriptor_pt->sercom_pt, (uint8_t)((address >> 0) & 0x0FF));
-        
-        /* Send data */
-        for (uint32_t i = 0; i < nb_bytes_to_write; i++)
-        {
-            sercom_spi_send_single_byte(descriptor_pt->sercom_pt, *data++);
-        }
-        
-        /* SS high */
-        PORT->Group[descriptor_pt->cs_pin_group].OUTSET.reg = descriptor_pt->cs_pin_mask;
-        
-        /* Increment address */
+        /* Increment address & data pointer */
         address += nb_bytes_to_write;
+        data += nb_bytes_to_write;
         
         /* Compute remaining bytes to write */
         nb_bytes_to_write = W25Q16_PAGE_SIZE;
@@ -97,6 +80,38 @@ void dataflash_write_array_to_memory(spi_flash_descriptor_t* descriptor_pt, uint
     }
 }
 
+/*! \fn     dataflash_write_page_without_wait(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length)
+*   \brief  Start programming bytes inside a single dataflash page
+*   \param  descriptor_pt   Pointer to dataflash descriptor
+*   \param  address         Address at which we should write the data
+*   \param  data            Pointer to the buffer containing the data of interest
+*   \param  length          Length of data to write, must not cross a page boundary
+*   \note   Flash should be previously erased and not busy. Page programming takes a while (up to 3ms), please call dataflash_is_busy to know termination
+*/
+void dataflash_write_page_without_wait(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length)
+{
+    /* Write enable */
+    dataflash_send_write_enable(descriptor_pt);
+    
+    /* SS low */
+    PORT->Group[descriptor_pt->cs_pin_group].OUTCLR.reg = descriptor_pt->cs_pin_mask;
+    
+    /* Send write command */
+    sercom_spi_send_single_byte(descriptor_pt->sercom_pt, 0x02);
+    sercom_spi_send_single_byte(descriptor_pt->sercom_pt, (uint8_t)((address >> 16) & 0x0FF));
+    sercom_spi_send_single_byte(descriptor_pt->sercom_pt, (uint8_t)((address >> 8) & 0x0FF));
+    sercom_spi_send_single_byte(descriptor_pt->sercom_pt, (uint8_t)((address >> 0) & 0x0FF));
+    
+    /* Send data */
+    for (uint32_t i = 0; i < length; i++)
+    {
+        sercom_spi_send_single_byte(descriptor_pt->sercom_pt, *data++);
+    }
+    
+    /* SS high */
+    PORT->Group[descriptor_pt->cs_pin_group].OUTSET.reg = descriptor_pt->cs_pin_mask;
+}
+
 /*! \fn     dataflash_read_data_array(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length)
 *   \brief  Function to read an array from the dataflash memory
 *   \param  descriptor_pt   Pointer to dataflash descriptor
@@ -265,6 +280,19 @@ void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t
     dataflash_send_command(descriptor_pt, erase_64kb_cmd, sizeof(erase_64kb_cmd));
 } 
 
+/*! \fn     dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address)
+*   \brief  Erase a 4KB sector
+*   \param  descriptor_pt   Pointer to dataflash descriptor
+*   \param  address         Address of the 4KB sector
+*   \note   This command takes a while (around 45ms), please call flash_check_busy to know termination
+*/
+void dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address)
+{
+    uint8_t erase_4kb_cmd[] = {0x20, (uint8_t)((address >> 16) & 0xFF), (uint8_t)((address >> 8) & 0xFF), (uint8_t)((address >> 0) & 0xFF)};
+    dataflash_send_write_enable(descriptor_pt);
+    dataflash_send_command(descriptor_pt, erase_4kb_cmd, sizeof(erase_4kb_cmd));
+}
+
 /*! \fn     dataflash_bulk_erase_with_wait(spi_flash_descriptor_t* descriptor_pt)
 *   \brief  Erase the complete flash (will take a long while)
 *   \param  descriptor_pt   Pointer to dataflash descriptor
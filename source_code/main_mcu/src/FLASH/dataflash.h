@@ -27,16 +27,19 @@
 
 /* Defines */
 #define W25Q16_PAGE_SIZE    256
+#define W25Q16_SECTOR_SIZE  4096
 #define W25Q16_FLASH_SIZE   2097152UL
 
 /* Prototypes */
 void dataflash_write_array_to_memory(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length);
+void dataflash_write_page_without_wait(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length);
 void dataflash_read_data_array(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length);
 void dataflash_read_bytes_from_opened_transfer(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length);
 void dataflash_send_command(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length);
 void dataflash_send_single_byte_command(spi_flash_descriptor_t* descriptor_pt, uint8_t command);
 void dataflash_read_data_array_start(spi_flash_descriptor_t* descriptor_pt, uint32_t address);
 void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t address);
+void dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address);
 void dataflash_bulk_erase_without_wait(spi_flash_descriptor_t* descriptor_pt);
 uint8_t dataflash_read_status_register(spi_flash_descriptor_t* descriptor_pt);
 void dataflash_stop_ongoing_transfer(spi_flash_descriptor_t* descriptor_pt);
@@ -21,6 +21,7 @@
 */
 #include "platform_defines.h"
 #include "driver_sercom.h"
+#include "flash_stats.h"
 #include "dbflash.h"
 #include "main.h"
 
@@ -396,6 +397,8 @@ void dbflash_write_data_pattern_to_flash(spi_flash_descriptor_t* descriptor_pt,
         }
     #endif
     
+    FLASH_STATS_ACCESS_START();
+    
     // If needed, load the page in the internal buffer
     if ((offset != 0) || (dataSize != BYTES_PER_PAGE))
     {
@@ -409,6 +412,7 @@ void dbflash_write_data_pattern_to_flash(spi_flash_descriptor_t* descriptor_pt,
     
     /* Wait until memory is ready */
     dbflash_wait_for_not_busy(descriptor_pt);
+    FLASH_STATS_ACCESS_END(FLASH_STATS_CAT_NODEMGMT, TRUE, dataSize);
 }
 
 /*! \fn     dbflash_write_data_to_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, void *data)
@@ -436,6 +440,8 @@ void dbflash_write_data_to_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t
         }
     #endif
     
+    FLASH_STATS_ACCESS_START();
+    
     // If needed, load the page in the internal buffer
     if ((offset != 0) || (dataSize != BYTES_PER_PAGE))
     {
@@ -449,6 +455,7 @@ void dbflash_write_data_to_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t
     
     /* Wait until memory is ready */
     dbflash_wait_for_not_busy(descriptor_pt);
+    FLASH_STATS_ACCESS_END(FLASH_STATS_CAT_NODEMGMT, TRUE, dataSize);
 }
 
 /*! \fn     dbflash_read_data_from_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, void *data)
@@ -485,9 +492,11 @@ void dbflash_read_data_from_flash(spi_flash_descriptor_t* descriptor_pt, uint16_
         }
     #endif
     
+    FLASH_STATS_ACCESS_START();
     uint8_t opcode[4] = {DBFLASH_OPCODE_LOWF_READ};
     dbflash_fill_page_read_write_erase_opcode_from_address(pageNumber, offset, &opcode[1]);
     dbflash_send_data_with_four_bytes_opcode(descriptor_pt, opcode, data, dataSize);
+    FLASH_STATS_ACCESS_END(FLASH_STATS_CAT_NODEMGMT, FALSE, dataSize);
 } 
 
 /*! \fn     dbflash_raw_read(spi_flash_descriptor_t* descriptor_pt, uint8_t* datap, uint16_t addr, uint16_t size)
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the Mooltipass Project (https://github.com/mooltipass).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!  \file     flash_stats.c
+*    \brief    External flashes access counters, per caller category
+*/
+#include <string.h>
+#include "flash_stats.h"
+#ifdef FLASH_STATS_ENABLED
+// Counters for each category
+flash_stats_counters_t flash_stats_counters[FLASH_STATS_NB_CATEGORIES];
+// Category set by the current caller
+flash_stats_category_te flash_stats_current_category = FLASH_STATS_CAT_ACCESS_DEFAULT;
+
+
+/*! \fn     flash_stats_reset(void)
+*   \brief  Reset all counters
+*/
+void flash_stats_reset(void)
+{
+    memset(flash_stats_counters, 0, sizeof(flash_stats_counters));
+}
+
+/*! \fn     flash_stats_get_counters(void)
+*   \brief  Get the counters array
+*   \return Pointer to FLASH_STATS_NB_CATEGORIES counters structures
+*/
+flash_stats_counters_t* flash_stats_get_counters(void)
+{
+    return flash_stats_counters;
+}
+
+/*! \fn     flash_stats_set_category(flash_stats_category_te category)
+*   \brief  Set the category the next flash accesses should be attributed to
+*   \param  category    The category, or FLASH_STATS_CAT_ACCESS_DEFAULT to use each flash default category
+*   \return The previously set category, to be restored once done
+*/
+flash_stats_category_te flash_stats_set_category(flash_stats_category_te category)
+{
+    flash_stats_category_te previous_category = flash_stats_current_category;
+    flash_stats_current_category = category;
+    return previous_category;
+}
+
+/*! \fn     flash_stats_log_access(flash_stats_category_te default_category, BOOL is_write, uint32_t nb_bytes, uint32_t start_timestamp_us)
+*   \brief  Log a flash access
+*   \param  default_category    Category to use if none was set by the caller
+*   \param  is_write            TRUE for a write access
+*   \param  nb_bytes            Number of bytes read or written
+*   \param  start_timestamp_us  Timestamp taken before the access
+*   \note   For DMA reads, only the time taken to arm the transfer is accounted for
+*/
+void flash_stats_log_access(flash_stats_category_te default_category, BOOL is_write, uint32_t nb_bytes, uint32_t start_timestamp_us)
+{
+    flash_stats_category_te category = flash_stats_current_category;
+
+    /* Caller didn't specify a category */
+    if (category >= FLASH_STATS_NB_CATEGORIES)
+    {
+        category = default_category;
+    }
+
+    /* Update counters */
+    flash_stats_counters_t* counters_pt = &flash_stats_counters[category];
+    if (is_write == FALSE)
+    {
+        counters_pt->nb_reads++;
+        counters_pt->nb_bytes_read += nb_bytes;
+    }
+    else
+    {
+        counters_pt->nb_writes++;
+        counters_pt->nb_bytes_written += nb_bytes;
+    }
+    counters_pt->time_spent_us += timer_get_timestamp_us() - start_timestamp_us;
+}
+#endif
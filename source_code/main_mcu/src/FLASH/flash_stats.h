@@ -0,0 +1,67 @@
+/*
+ * This file is part of the Mooltipass Project (https://github.com/mooltipass).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*!  \file     flash_stats.h
+*    \brief    External flashes access counters, per caller category
+*/
+#ifndef FLASH_STATS_H_
+#define FLASH_STATS_H_
+
+#include "platform_defines.h"
+#include "driver_timer.h"
+#include "defines.h"
+
+/* Enums */
+typedef enum    {   FLASH_STATS_CAT_NODEMGMT = 0,
+                    FLASH_STATS_CAT_GUI = 1,
+                    FLASH_STATS_CAT_FONTS = 2,
+                    FLASH_STATS_CAT_BITMAPS = 3,
+                    FLASH_STATS_CAT_SETTINGS = 4,
+                    FLASH_STATS_NB_CATEGORIES = 5,
+                    FLASH_STATS_CAT_ACCESS_DEFAULT = 5
+                } flash_stats_category_te;
+
+/* Typedefs */
+typedef struct
+{
+    uint32_t nb_reads;
+    uint32_t nb_bytes_read;
+    uint32_t nb_writes;
+    uint32_t nb_bytes_written;
+    uint32_t time_spent_us;
+} flash_stats_counters_t;
+
+/* Macros: flash accesses are attributed to the category set by the innermost caller, or to the default category of the accessed flash */
+#ifdef FLASH_STATS_ENABLED
+    #define FLASH_STATS_CATEGORY_ENTER(cat)                 flash_stats_category_te flash_stats_previous_category = flash_stats_set_category(cat)
+    #define FLASH_STATS_CATEGORY_EXIT()                     flash_stats_set_category(flash_stats_previous_category)
+    #define FLASH_STATS_ACCESS_START()                      uint32_t flash_stats_access_start_us = timer_get_timestamp_us()
+    #define FLASH_STATS_ACCESS_END(cat, is_write, nb_bytes) flash_stats_log_access(cat, is_write, nb_bytes, flash_stats_access_start_us)
+#else
+    #define FLASH_STATS_CATEGORY_ENTER(cat)
+    #define FLASH_STATS_CATEGORY_EXIT()
+    #define FLASH_STATS_ACCESS_START()
+    #define FLASH_STATS_ACCESS_END(cat, is_write, nb_bytes)
+#endif
+
+/* Prototypes */
+#ifdef FLASH_STATS_ENABLED
+void flash_stats_log_access(flash_stats_category_te default_category, BOOL is_write, uint32_t nb_bytes, uint32_t start_timestamp_us);
+flash_stats_category_te flash_stats_set_category(flash_stats_category_te category);
+flash_stats_counters_t* flash_stats_get_counters(void);
+void flash_stats_reset(void);
+#endif
+
+#endif /* FLASH_STATS_H_ */
@@ -2006,7 +2006,7 @@ mini_input_yes_no_ret_te gui_prompts_ask_for_login_select(uint16_t parent_node_a
             if ((animation_step > 0) && (before_top_of_list_child_addr != NODE_ADDR_NULL))
             {
                 /* Fetch node */
-                nodemgmt_read_cred_child_node_except_pwd(before_top_of_list_child_addr, temp_half_cnode_pt);
+                nodemgmt_read_cred_child_node_header_and_login(before_top_of_list_child_addr, temp_half_cnode_pt);
                 
                 /* Display fading out login */
                 sh1122_refresh_used_font(&plat_oled_descriptor, FONT_UBUNTU_REGULAR_13_ID);
@@ -2034,7 +2034,7 @@ mini_input_yes_no_ret_te gui_prompts_ask_for_login_select(uint16_t parent_node_a
                     /* Fetch node if needed */
                     if (i > 0)
                     {
-                        nodemgmt_read_cred_child_node_except_pwd(*(address_to_check_to_display[i]), temp_half_cnode_pt);
+                        nodemgmt_read_cred_child_node_header_and_login(*(address_to_check_to_display[i]), temp_half_cnode_pt);
                     }
                     
                     /* Surround center of list item */
@@ -2109,7 +2109,7 @@ mini_input_yes_no_ret_te gui_prompts_ask_for_login_select(uint16_t parent_node_a
                         if ((animation_step < 0) && (*(address_to_check_to_display[i+1]) != NODE_ADDR_NULL))
                         {
                             /* Fetch node */
-                            nodemgmt_read_cred_child_node_except_pwd(*(address_to_check_to_display[i+1]), temp_half_cnode_pt);
+                            nodemgmt_read_cred_child_node_header_and_login(*(address_to_check_to_display[i+1]), temp_half_cnode_pt);
                             
                             /* Display fading out login */
                             sh1122_refresh_used_font(&plat_oled_descriptor, FONT_UBUNTU_REGULAR_13_ID);
@@ -2181,6 +2181,82 @@ mini_input_yes_no_ret_te gui_prompts_ask_for_login_select(uint16_t parent_node_a
     return MINI_INPUT_RET_NO;
 }
 
+/*! \fn     gui_prompts_serv_sel_cache_get_entry(serv_sel_cache_t* cache, uint16_t parent_addr)
+*   \brief  Get the service selection cache entry for a given parent node
+*   \param  cache           Pointer to the cache
+*   \param  parent_addr     Parent node address, not NODE_ADDR_NULL
+*   \return Pointer to the cache entry
+*   \note   On cache miss, the least recently used entry is replaced
+*/
+static serv_sel_cache_entry_t* gui_prompts_serv_sel_cache_get_entry(serv_sel_cache_t* cache, uint16_t parent_addr)
+{
+    serv_sel_cache_entry_t* entry_pt = &cache->entries[0];
+    
+    /* Look for our node, or else for the entry to replace */
+    for (uint16_t i = 0; i < ARRAY_SIZE(cache->entries); i++)
+    {
+        if (cache->entries[i].address == parent_addr)
+        {
+            cache->entries[i].last_used = ++(cache->use_counter);
+            return &cache->entries[i];
+        }
+        
+        /* Empty entries first, then least recently used */
+        if (entry_pt->address != NODE_ADDR_NULL)
+        {
+            if ((cache->entries[i].address == NODE_ADDR_NULL) || ((uint16_t)(cache->use_counter - cache->entries[i].last_used) > (uint16_t)(cache->use_counter - entry_pt->last_used)))
+            {
+                entry_pt = &cache->entries[i];
+            }
+        }
+    }
+    
+    /* Cache miss: prev / next addresses are fetched when asked for */
+    entry_pt->address = parent_addr;
+    entry_pt->prev_address_fetched = FALSE;
+    entry_pt->next_address_fetched = FALSE;
+    entry_pt->last_used = ++(cache->use_counter);
+    return entry_pt;
+}
+
+/*! \fn     gui_prompts_serv_sel_cache_get_prev_address(serv_sel_cache_t* cache, uint16_t parent_addr)
+*   \brief  Cached version of nodemgmt_get_prev_parent_node_for_cur_category() for standard credentials
+*   \param  cache           Pointer to the cache
+*   \param  parent_addr     Parent node address, not NODE_ADDR_NULL
+*   \return The previous parent node address or NODE_ADDR_NULL
+*/
+static uint16_t gui_prompts_serv_sel_cache_get_prev_address(serv_sel_cache_t* cache, uint16_t parent_addr)
+{
+    serv_sel_cache_entry_t* entry_pt = gui_prompts_serv_sel_cache_get_entry(cache, parent_addr);
+    
+    if (entry_pt->prev_address_fetched == FALSE)
+    {
+        entry_pt->prev_address = nodemgmt_get_prev_parent_node_for_cur_category(parent_addr, NODEMGMT_STANDARD_CRED_TYPE_ID);
+        entry_pt->prev_address_fetched = TRUE;
+    }
+    
+    return entry_pt->prev_address;
+}
+
+/*! \fn     gui_prompts_serv_sel_cache_get_next_address(serv_sel_cache_t* cache, uint16_t parent_addr)
+*   \brief  Cached version of nodemgmt_get_next_parent_node_for_cur_category() for standard credentials
+*   \param  cache           Pointer to the cache
+*   \param  parent_addr     Parent node address, not NODE_ADDR_NULL
+*   \return The next parent node address or NODE_ADDR_NULL
+*/
+static uint16_t gui_prompts_serv_sel_cache_get_next_address(serv_sel_cache_t* cache, uint16_t parent_addr)
+{
+    serv_sel_cache_entry_t* entry_pt = gui_prompts_serv_sel_cache_get_entry(cache, parent_addr);
+    
+    if (entry_pt->next_address_fetched == FALSE)
+    {
+        entry_pt->next_address = nodemgmt_get_next_parent_node_for_cur_category(parent_addr, NODEMGMT_STANDARD_CRED_TYPE_ID);
+        entry_pt->next_address_fetched = TRUE;
+    }
+    
+    return entry_pt->next_address;
+}
+
 /*! \fn     gui_prompts_service_selection_screen(uint16_t start_address)
 *   \brief  Screen for manual service selection
 *   \param  start_address   Address of the service we should start at
@@ -2189,6 +2265,7 @@ mini_input_yes_no_ret_te gui_prompts_ask_for_login_select(uint16_t parent_node_a
 uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
 {
     cust_char_t* select_credential_string;
+    serv_sel_cache_t serv_sel_cache;
     parent_node_t temp_pnode;
     
     /* Activity detected */
@@ -2211,8 +2288,11 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
     sh1122_clear_current_screen(&plat_oled_descriptor);
     #endif
     
+    /* Category links of the parent nodes around the displayed ones are cached: the database can't change while we're here */
+    memset(&serv_sel_cache, 0, sizeof(serv_sel_cache));
+    
     /* Temp vars for our main loop */
-    uint16_t top_of_list_parent_addr = nodemgmt_get_prev_parent_node_for_cur_category(start_address, NODEMGMT_STANDARD_CRED_TYPE_ID);
+    uint16_t top_of_list_parent_addr = gui_prompts_serv_sel_cache_get_prev_address(&serv_sel_cache, start_address);
     uint16_t before_top_of_list_parent_addr = NODE_ADDR_NULL;
     uint16_t center_of_list_parent_addr = start_address;
     uint16_t bottom_of_list_parent_addr = NODE_ADDR_NULL;
@@ -2231,6 +2311,7 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
     int16_t animation_step = 0;
     BOOL redraw_needed = TRUE;
     BOOL action_taken = FALSE;
+    int16_t prefetch_direction = 0;
     int16_t displayed_length;
     BOOL scrolling_needed[4];
     
@@ -2316,6 +2397,7 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
                 top_of_list_parent_addr = center_of_list_parent_addr;
                 animation_step = ((LOGIN_SCROLL_Y_TLINE-LOGIN_SCROLL_Y_SLINE)/2)*2;
                 animation_just_started = TRUE;
+                prefetch_direction = 1;
             }
         }
         else if (detect_result == WHEEL_ACTION_UP)
@@ -2326,6 +2408,7 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
                 top_of_list_parent_addr = before_top_of_list_parent_addr;
                 animation_step = -((LOGIN_SCROLL_Y_SLINE-LOGIN_SCROLL_Y_FLINE)/2)*2;
                 animation_just_started = TRUE;
+                prefetch_direction = -1;
             }
         }
         else if (detect_result == WHEEL_ACTION_CLICK_DOWN)
@@ -2347,7 +2430,7 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
                 fchar_array[0] = cur_fchar;
                 displaying_service_fchars = TRUE;
                 center_of_list_parent_addr = next_diff_fletter_node_addr;
-                top_of_list_parent_addr = nodemgmt_get_prev_parent_node_for_cur_category(center_of_list_parent_addr, NODEMGMT_STANDARD_CRED_TYPE_ID);
+                top_of_list_parent_addr = gui_prompts_serv_sel_cache_get_prev_address(&serv_sel_cache, center_of_list_parent_addr);
                 animation_just_started = TRUE;
                 
                 /* Only 2 letters */
@@ -2380,7 +2463,7 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
                 fchar_array[2] = cur_fchar;
                 displaying_service_fchars = TRUE;
                 center_of_list_parent_addr = prev_diff_fletter_node_addr;
-                top_of_list_parent_addr = nodemgmt_get_prev_parent_node_for_cur_category(center_of_list_parent_addr, NODEMGMT_STANDARD_CRED_TYPE_ID);
+                top_of_list_parent_addr = gui_prompts_serv_sel_cache_get_prev_address(&serv_sel_cache, center_of_list_parent_addr);
                 animation_just_started = TRUE;
                 
                 /* Only 2 letters */
@@ -2512,7 +2595,7 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
                     /* First address: store the "before top address */
                     if (i == 1)
                     {
-                        before_top_of_list_parent_addr = nodemgmt_get_prev_parent_node_for_cur_category(top_of_list_parent_addr, NODEMGMT_STANDARD_CRED_TYPE_ID);
+                        before_top_of_list_parent_addr = gui_prompts_serv_sel_cache_get_prev_address(&serv_sel_cache, top_of_list_parent_addr);
                     }
                     
                     /* Last address: store correct bool */
@@ -2612,7 +2695,7 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
                     if (i > 0)
                     {
                         /* Array has an extra element */
-                        *(address_to_check_to_display[i+1]) = nodemgmt_get_next_parent_node_for_cur_category(*(address_to_check_to_display[i]), NODEMGMT_STANDARD_CRED_TYPE_ID);
+                        *(address_to_check_to_display[i+1]) = gui_prompts_serv_sel_cache_get_next_address(&serv_sel_cache, *(address_to_check_to_display[i]));
                     }
                     
                     /* Last item & animation scrolling up: display upcoming item */
@@ -2682,6 +2765,20 @@ uint16_t gui_prompts_service_selection_screen(uint16_t start_address)
                 redraw_needed = FALSE;
             }
         }
+        
+        /* Scrolling animation over: walk to the next parent node in the scrolling direction so the next scroll doesn't wait on it */
+        if ((redraw_needed == FALSE) && (prefetch_direction != 0))
+        {
+            if ((prefetch_direction > 0) && (after_bottom_of_list_parent_addr != NODE_ADDR_NULL))
+            {
+                gui_prompts_serv_sel_cache_get_next_address(&serv_sel_cache, after_bottom_of_list_parent_addr);
+            }
+            else if ((prefetch_direction < 0) && (before_top_of_list_parent_addr != NODE_ADDR_NULL))
+            {
+                gui_prompts_serv_sel_cache_get_prev_address(&serv_sel_cache, before_top_of_list_parent_addr);
+            }
+            prefetch_direction = 0;
+        }
     }
     
     return NODE_ADDR_NULL;
@@ -3129,7 +3226,7 @@ int32_t gui_prompts_favorite_selection_screen(int16_t start_favid, int16_t start
             {
                 /* Fetch nodes */                
                 nodemgmt_read_favorite((uint16_t)before_top_of_list_child_cat, (uint16_t)before_top_of_list_child_index, &temp_parent_addr, &temp_child_addr);
-                nodemgmt_read_cred_child_node_except_pwd(temp_child_addr, temp_half_cnode_pt);
+                nodemgmt_read_cred_child_node_header_and_login(temp_child_addr, temp_half_cnode_pt);
                 nodemgmt_read_parent_node(temp_parent_addr, &temp_pnode, TRUE);
                 
                 /* Generate string */
@@ -3166,7 +3263,7 @@ int32_t gui_prompts_favorite_selection_screen(int16_t start_favid, int16_t start
                     {
                         /* Fetch nodes */
                         nodemgmt_read_favorite((uint16_t)*(cat_to_check_to_display[i]), (uint16_t)*(index_to_check_to_display[i]), &temp_parent_addr, &temp_child_addr);
-                        nodemgmt_read_cred_child_node_except_pwd(temp_child_addr, temp_half_cnode_pt);
+                        nodemgmt_read_cred_child_node_header_and_login(temp_child_addr, temp_half_cnode_pt);
                         nodemgmt_read_parent_node(temp_parent_addr, &temp_pnode, TRUE);
                         
                         /* Generate string */
@@ -3270,7 +3367,7 @@ int32_t gui_prompts_favorite_selection_screen(int16_t start_favid, int16_t start
                         {
                             /* Fetch nodes */
                             nodemgmt_read_favorite((uint16_t)after_bottom_list_child_cat, (uint16_t)after_bottom_list_child_index, &temp_parent_addr, &temp_child_addr);
-                            nodemgmt_read_cred_child_node_except_pwd(temp_child_addr, temp_half_cnode_pt);
+                            nodemgmt_read_cred_child_node_header_and_login(temp_child_addr, temp_half_cnode_pt);
                             nodemgmt_read_parent_node(temp_parent_addr, &temp_pnode, TRUE);
                             
                             /* Display fading out login */
@@ -24,6 +24,7 @@
 #ifndef GUI_PROMPTS_H_
 #define GUI_PROMPTS_H_
 
+#include "nodemgmt_defines.h"
 #include "defines.h"
 
 /* Defines */
@@ -118,6 +119,7 @@
 #define LOGIN_SCROLL_Y_SLINE            33
 #define LOGIN_SCROLL_Y_TLINE            49
 #define LOGIN_SCROLL_ANIM_DELAY         15
+#define SERV_SEL_CACHE_NB_ENTRIES       6       // 5 parents displayed at most + 1 fetched ahead
 
 // Delay when scrolling a text
 #define SCROLLING_DEL                   33
@@ -132,6 +134,22 @@ typedef struct
     cust_char_t* lines[4];
 } confirmationText_t;
 
+typedef struct
+{
+    uint16_t address;                           // Parent node address, NODE_ADDR_NULL if entry is empty
+    uint16_t prev_address;                      // Previous parent node address for the current category
+    uint16_t next_address;                      // Next parent node address for the current category
+    BOOL prev_address_fetched;                  // Set once prev_address is valid
+    BOOL next_address_fetched;                  // Set once next_address is valid
+    uint16_t last_used;                         // Use stamp, for least recently used replacement
+} serv_sel_cache_entry_t;
+
+typedef struct
+{
+    serv_sel_cache_entry_t entries[SERV_SEL_CACHE_NB_ENTRIES];
+    uint16_t use_counter;
+} serv_sel_cache_t;
+
 /* Prototypes */
 wheel_action_ret_te gui_prompts_render_pin_enter_screen(uint8_t* current_pin, uint16_t selected_digit, uint16_t stringID, int16_t vert_anim_direction, int16_t hor_anim_direction, BOOL six_digit_prompt);
 mini_input_yes_no_ret_te gui_prompts_ask_for_confirmation(uint16_t nb_args, confirmationText_t* text_object, BOOL accept_cancel_message, BOOL parse_aux_messages, BOOL exit_on_power_change);
@@ -34,6 +34,7 @@
 *   \param  char_array          An array for 2 chars
 *   \param  category_id         Credential/Data category ID
 *   \return Address of the next node having a different first letter
+*   \note   The parent linked list is only walked when the first letter index can't be used
 */
 uint16_t logic_database_get_prev_2_fletters_services(uint16_t start_address, cust_char_t start_char, cust_char_t* char_array, uint16_t credential_type_id)
 {
@@ -51,6 +52,12 @@ uint16_t logic_database_get_prev_2_fletters_services(uint16_t start_address, cus
     temp_pnode.cred_parent.prevParentAddress = start_address;
     char_array[0] = ' '; char_array[1] = ' ';
     
+    /* Try the first letter index */
+    if (nodemgmt_fletter_index_get_jump(credential_type_id, start_char, FALSE, char_array, &return_value) == RETURN_OK)
+    {
+        return return_value;
+    }
+    
     while(TRUE)
     {
         /* Update current node address */
@@ -76,7 +83,7 @@ uint16_t logic_database_get_prev_2_fletters_services(uint16_t start_address, cus
         nodemgmt_read_parent_node(current_node_addr, &temp_pnode, FALSE);
         
         /* Part of current category? */
-        if (nodemgmt_check_for_logins_with_category_in_parent_node(temp_pnode.cred_parent.nextChildAddress, nodemgmt_get_current_category_flags()) != NODE_ADDR_NULL)
+        if (nodemgmt_parent_node_has_logins_with_category(current_node_addr, temp_pnode.cred_parent.nextChildAddress, nodemgmt_get_current_category_flags()) != FALSE)
         {
             /* Check if the fchar changed */
             if (temp_pnode.cred_parent.service[0] != cur_char)
@@ -132,6 +139,7 @@ uint16_t logic_database_get_prev_2_fletters_services(uint16_t start_address, cus
 *   \param  char_array          An array for 2 chars
 *   \param  category_id         Credential/Data category ID
 *   \return Address of the next node having a different first letter
+*   \note   The parent linked list is only walked when the first letter index can't be used
 */
 uint16_t logic_database_get_next_2_fletters_services(uint16_t start_address, cust_char_t cur_char, cust_char_t* char_array, uint16_t credential_type_id)
 {
@@ -145,6 +153,12 @@ uint16_t logic_database_get_next_2_fletters_services(uint16_t start_address, cus
     temp_pnode.cred_parent.nextParentAddress = start_address;
     char_array[0] = ' '; char_array[1] = ' ';
     
+    /* Try the first letter index */
+    if (nodemgmt_fletter_index_get_jump(credential_type_id, cur_char, TRUE, char_array, &return_value) == RETURN_OK)
+    {
+        return return_value;
+    }
+    
     while(TRUE)
     {
         /* Check for credential loop */
@@ -163,7 +177,7 @@ uint16_t logic_database_get_next_2_fletters_services(uint16_t start_address, cus
         nodemgmt_read_parent_node(current_node_addr, &temp_pnode, FALSE);
         
         /* Check if the fchar changed */
-        if ((temp_pnode.cred_parent.service[0] != cur_char) && (nodemgmt_check_for_logins_with_category_in_parent_node(temp_pnode.cred_parent.nextChildAddress, nodemgmt_get_current_category_flags()) != NODE_ADDR_NULL))
+        if ((temp_pnode.cred_parent.service[0] != cur_char) && (nodemgmt_parent_node_has_logins_with_category(current_node_addr, temp_pnode.cred_parent.nextChildAddress, nodemgmt_get_current_category_flags()) != FALSE))
         {            
             /* Store node */
             char_array[storage_index++] = temp_pnode.cred_parent.service[0];
@@ -200,19 +214,26 @@ uint16_t logic_database_get_next_2_fletters_services(uint16_t start_address, cus
 *   \param  category_id             Credential/Data category ID
 *   \return Address of the found node, NODE_ADDR_NULL otherwise
 *   \note   Full 8Mb database search has been timed at 581ms
+*   \note   Exact matches first go through the service name index, the linked list is only walked when the index can't be used, or from the first character run of the services a full index can't hold
 */
 uint16_t logic_database_search_service(cust_char_t* name, service_compare_mode_te compare_type, BOOL cred_type, uint16_t category_id)
 {
+    uint16_t next_node_addr = NODE_ADDR_NULL;
     parent_node_t temp_pnode;
-    uint16_t next_node_addr;
     int16_t compare_result;
     
+    /* Exact match: try the service name index, which may also tell us where to start in the linked list */
+    if ((compare_type == COMPARE_MODE_MATCH) && (nodemgmt_service_index_search(name, cred_type, category_id, &next_node_addr) == RETURN_OK))
+    {
+        return next_node_addr;
+    }
+    
     /* Get start node */
-    if (cred_type != FALSE)
+    if ((next_node_addr == NODE_ADDR_NULL) && (cred_type != FALSE))
     {
         next_node_addr = nodemgmt_get_starting_parent_addr(category_id);
     }
-    else
+    else if (next_node_addr == NODE_ADDR_NULL)
     {
         next_node_addr = nodemgmt_get_starting_data_parent_addr(category_id);
     }
@@ -329,42 +350,84 @@ uint16_t logic_database_search_webauthn_userhandle_in_service(uint16_t parent_ad
 */
 uint16_t logic_database_search_webauthn_credential_id_in_service(uint16_t parent_addr, uint8_t* credential_id)
 {
+    uint16_t nb_matches;
+    return logic_database_search_webauthn_credential_ids_in_service(parent_addr, (uint8_t (*)[FIDO2_CREDENTIAL_ID_LENGTH])credential_id, 1, &nb_matches);
+}
+
+/*! \fn     logic_database_search_webauthn_credential_ids_in_service(uint16_t parent_addr, uint8_t credential_id_list[][FIDO2_CREDENTIAL_ID_LENGTH], uint16_t credential_id_list_length, uint16_t* nb_matches)
+*   \brief  Find the children of a given parent whose credential id is in a given list, going through the children only once
+*   \param  parent_addr                 Parent node address
+*   \param  credential_id_list          List of credential IDs
+*   \param  credential_id_list_length   Number of credential IDs in the list, only the first FIDO2_ALLOW_LIST_MAX_SIZE are considered
+*   \param  nb_matches                  Where to store the number of matching children
+*   \return Address of the first matching node, NODE_ADDR_NULL otherwise
+*   \note   Credential ids are random, so their first bytes are used as fingerprints and full comparisons are only done on fingerprint hits
+*/
+uint16_t logic_database_search_webauthn_credential_ids_in_service(uint16_t parent_addr, uint8_t credential_id_list[][FIDO2_CREDENTIAL_ID_LENGTH], uint16_t credential_id_list_length, uint16_t* nb_matches)
+{
+    uint32_t credential_id_fingerprints[FIDO2_ALLOW_LIST_MAX_SIZE];
+    uint16_t first_match_addr = NODE_ADDR_NULL;
     child_webauthn_node_t* temp_half_cnode_pt;
+    uint32_t child_fingerprint;
     parent_node_t temp_pnode;
     uint16_t next_node_addr;
     
+    /* Static asserts */
+    _Static_assert(MEMBER_SIZE(child_webauthn_node_t, credential_id) == FIDO2_CREDENTIAL_ID_LENGTH, "credential id length mismatch");
+    _Static_assert(FIDO2_CREDENTIAL_ID_LENGTH >= sizeof(uint32_t), "credential id too short for fingerprint");
+    
     /* Dirty trick */
     temp_half_cnode_pt = (child_webauthn_node_t*)&temp_pnode;
+    *nb_matches = 0;
     
-    /* Read parent node and get first child address */
-    nodemgmt_read_parent_node(parent_addr, &temp_pnode, TRUE);
-    next_node_addr = temp_pnode.cred_parent.nextChildAddress;
+    /* Sanitize the list length to prevent overflows */
+    if (credential_id_list_length > FIDO2_ALLOW_LIST_MAX_SIZE)
+    {
+        credential_id_list_length = FIDO2_ALLOW_LIST_MAX_SIZE;
+    }
     
-    /* Check that there's actually a child node */
-    if (next_node_addr == NODE_ADDR_NULL)
+    /* Build the fingerprints of the credential IDs we're looking for */
+    for (uint16_t i = 0; i < credential_id_list_length; i++)
     {
-        return NODE_ADDR_NULL;
+        memcpy(&credential_id_fingerprints[i], credential_id_list[i], sizeof(credential_id_fingerprints[0]));
     }
     
+    /* Read parent node and get first child address */
+    nodemgmt_read_parent_node(parent_addr, &temp_pnode, TRUE);
+    next_node_addr = temp_pnode.cred_parent.nextChildAddress;
+    
     /* Start going through the nodes */
-    do
+    while ((next_node_addr != NODE_ADDR_NULL) && (credential_id_list_length != 0))
     {
         /* Read child node */
         nodemgmt_read_webauthn_child_node_except_display_name(next_node_addr, temp_half_cnode_pt, FALSE);
+        memcpy(&child_fingerprint, temp_half_cnode_pt->credential_id, sizeof(child_fingerprint));
         
-        /* Compare with provided credential id */
-        if (memcmp(temp_half_cnode_pt->credential_id, credential_id, MEMBER_SIZE(child_webauthn_node_t, credential_id)) == 0)
+        /* Look it up in the provided credential ids */
+        for (uint16_t i = 0; i < credential_id_list_length; i++)
         {
-            return next_node_addr;
+            if ((credential_id_fingerprints[i] == child_fingerprint) && (memcmp(temp_half_cnode_pt->credential_id, credential_id_list[i], FIDO2_CREDENTIAL_ID_LENGTH) == 0))
+            {
+                if (first_match_addr == NODE_ADDR_NULL)
+                {
+                    first_match_addr = next_node_addr;
+                }
+                *nb_matches += 1;
+                break;
+            }
+        }
+        
+        /* Credential ids are unique: stop once all of them were found */
+        if (*nb_matches == credential_id_list_length)
+        {
+            break;
         }
         
         /* Go to next one */
         next_node_addr = temp_half_cnode_pt->nextChildAddress;
     }
-    while (next_node_addr != NODE_ADDR_NULL);
     
-    /* We didn't find the credential id */
-    return NODE_ADDR_NULL;
+    return first_match_addr;
 }
 
 /*! \fn     logic_database_search_login_in_service(uint16_t parent_addr, cust_char_t* login, BOOL category_filter)
@@ -397,7 +460,7 @@ uint16_t logic_database_search_login_in_service(uint16_t parent_addr, cust_char_
     do
     {
         /* Read child node */
-        nodemgmt_read_cred_child_node_except_pwd(next_node_addr, temp_half_cnode_pt);
+        nodemgmt_read_cred_child_node_header_and_login(next_node_addr, temp_half_cnode_pt);
         
         /* Compare login with the provided name */        
         if ((utils_custchar_strncmp(login, temp_half_cnode_pt->login, ARRAY_SIZE(temp_half_cnode_pt->login)) == 0) && ((category_filter == FALSE) || (nodemgmt_get_current_category_flags() == 0) || (categoryFromFlags(temp_half_cnode_pt->flags) == nodemgmt_get_current_category_flags())))
@@ -427,7 +490,7 @@ void logic_database_get_login_for_address(uint16_t child_addr, cust_char_t** log
     temp_half_cnode_pt = (child_cred_node_t*)&temp_pnode;
     
     /* Read child node */
-    nodemgmt_read_cred_child_node_except_pwd(child_addr, temp_half_cnode_pt);
+    nodemgmt_read_cred_child_node_header_and_login(child_addr, temp_half_cnode_pt);
     
     /* Copy string */
     utils_strncpy(*login, temp_half_cnode_pt->login, MEMBER_ARRAY_SIZE(child_cred_node_t, login));
@@ -563,7 +626,7 @@ uint16_t logic_database_get_number_of_creds_for_service(uint16_t parent_addr, ui
     do
     {
         /* Read child node */
-        nodemgmt_read_cred_child_node_except_pwd(next_node_addr, temp_half_cnode_pt);
+        nodemgmt_read_cred_child_node_header(next_node_addr, temp_half_cnode_pt);
         
         /* Check for category */
         if ((category_filter == FALSE) || (nodemgmt_get_current_category_flags() == 0) || (categoryFromFlags(temp_half_cnode_pt->flags) == nodemgmt_get_current_category_flags()))
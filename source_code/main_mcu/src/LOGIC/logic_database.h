@@ -24,11 +24,13 @@
 #ifndef LOGIC_DATABASE_H_
 #define LOGIC_DATABASE_H_
 
+#include "fido2_values_defines.h"
 #include "comms_hid_msgs.h"
 #include "defines.h"
 
 
 /* Prototypes */
+uint16_t logic_database_search_webauthn_credential_ids_in_service(uint16_t parent_addr, uint8_t credential_id_list[][FIDO2_CREDENTIAL_ID_LENGTH], uint16_t credential_id_list_length, uint16_t* nb_matches);
 RET_TYPE logic_database_add_webauthn_credential_for_service(uint16_t service_addr, uint8_t* user_handle, uint8_t user_handle_len, cust_char_t* user_name, cust_char_t* display_name, uint8_t* private_key,  uint8_t* ctr, uint8_t* credential_id);
 void logic_database_get_webauthn_data_for_address_and_inc_count(uint16_t child_addr, uint8_t* user_handle, uint8_t* user_handle_len, uint8_t* credential_id, uint8_t* key, uint32_t* count, uint8_t* ctr);
 RET_TYPE logic_database_add_child_node_to_data_service(uint16_t logic_user_data_service_addr, uint16_t* logic_user_last_data_child_addr, hid_message_store_data_into_file_t* store_data_request);
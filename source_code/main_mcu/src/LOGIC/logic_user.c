@@ -1142,8 +1142,8 @@ fido2_return_code_te logic_user_get_webauthn_credential_key_for_rp(cust_char_t*
 {
     uint8_t temp_cred_ctr[MEMBER_SIZE(child_webauthn_node_t, ctr)];
     
-    /* TODO2: allow an allow list that has more than 1, which requires extra code on the GUI as it isn't as simple as listing all children nodes */
-    /* However, I'm not sure why this would happen, as the RP would need to keep track of all aliases of a given user... */
+    /* TODO2: let the user pick among several allowed credentials, which requires extra code on the GUI as it isn't as simple as listing all children nodes */
+    /* However, I'm not sure why this would happen, as the RP would need to keep track of all aliases of a given user... so we use the first match */
     
     /* Copy strings locally */
     cust_char_t temp_user_name[MEMBER_ARRAY_SIZE(child_webauthn_node_t, user_name)+1];
@@ -1167,16 +1167,21 @@ fido2_return_code_te logic_user_get_webauthn_credential_key_for_rp(cust_char_t*
         return FIDO2_CRED_NOT_FOUND;
     }
     
-    /* See how many credentials there are for this service */
-    uint16_t nb_logins_for_cred = logic_database_get_number_of_creds_for_service(parent_address, &child_address, FALSE);
+    /* No allow list: see how many credentials there are for this service */
+    uint16_t nb_logins_for_cred = 0;
+    if (credential_id_allow_list_length == 0)
+    {
+        nb_logins_for_cred = logic_database_get_number_of_creds_for_service(parent_address, &child_address, FALSE);
+    }
     
-    /* Check if wanted credential id has been specified or if there's only one credential for that service */
-    if ((credential_id_allow_list_length == 1) || (nb_logins_for_cred == 1))
+    /* Check if wanted credential ids have been specified or if there's only one credential for that service */
+    if ((credential_id_allow_list_length != 0) || (nb_logins_for_cred == 1))
     {
-        /* Login specified? look for it */
+        /* Logins specified? look for them in a single pass over the children */
         if (credential_id_allow_list_length != 0)
         {
-            child_address = logic_database_search_webauthn_credential_id_in_service(parent_address, credential_id_allow_list[0]);
+            uint16_t nb_allowed_creds_found;
+            child_address = logic_database_search_webauthn_credential_ids_in_service(parent_address, credential_id_allow_list, credential_id_allow_list_length, &nb_allowed_creds_found);
             
             /* Check for existing login */
             if (child_address == NODE_ADDR_NULL)
@@ -36,6 +36,29 @@
 nodemgmtHandle_t nodemgmt_current_handle;
 // Current date
 uint16_t nodemgmt_current_date;
+// Service name index: open addressing hash table of parent addresses
+nodemgmt_service_index_entry_t nodemgmt_service_index[NODEMGMT_SERVICE_INDEX_NB_ENTRIES];
+// Service name index state and number of used slots
+service_index_state_te nodemgmt_service_index_state = SERVICE_INDEX_NEEDS_REBUILD;
+uint16_t nodemgmt_service_index_nb_used_slots = 0;
+// Services the index can't hold once full: where their runs of same first character start in the (sorted) parent linked lists
+nodemgmt_service_index_run_t nodemgmt_service_index_runs[NODEMGMT_SERVICE_INDEX_NB_RUNS];
+uint16_t nodemgmt_service_index_nb_runs = 0;
+// First letter index: first parent address of each run of services sharing the same first character
+nodemgmt_fletter_index_entry_t nodemgmt_fletter_index[NODEMGMT_FLETTER_INDEX_NB_ENTRIES];
+// First letter index state, number of entries and the category flags / credential type it was built for
+service_index_state_te nodemgmt_fletter_index_state = SERVICE_INDEX_NEEDS_REBUILD;
+uint16_t nodemgmt_fletter_index_nb_entries = 0;
+uint16_t nodemgmt_fletter_index_category_flags = 0;
+uint16_t nodemgmt_fletter_index_cred_type_id = 0;
+// Free node slots bitmap, a set bit means the slot is free
+uint8_t nodemgmt_free_slots_bitmap[NODEMGMT_FREE_SLOTS_BITMAP_SIZE];
+// Set when the free node slots bitmap reflects the flash contents
+BOOL nodemgmt_free_slots_bitmap_valid = FALSE;
+// Parent categories map: for each credential parent node slot, ORed category flags of its children
+uint8_t nodemgmt_parent_categories_map[NODEMGMT_PARENT_CATS_MAP_SIZE];
+// Parent categories map state
+service_index_state_te nodemgmt_parent_categories_state = SERVICE_INDEX_NEEDS_REBUILD;
 
 
 /*! \fn     nodemgmt_set_current_date(uint16_t date)
@@ -126,6 +149,73 @@ static inline uint16_t userIdFromFlags(uint16_t flags)
     return ((flags >> NODEMGMT_USERID_BITSHIFT) & NODEMGMT_USERID_MASK_FINAL);
 }
 
+/*! \fn     nodemgmt_free_slot_index(uint16_t pageNumber, uint16_t nodeNumber)
+*   \brief  Get the free slots bitmap bit index for a given node slot
+*   \param  pageNumber      Page number, must be past the first sector
+*   \param  nodeNumber      Node number inside the page
+*   \return The bit index
+*/
+static inline uint16_t nodemgmt_free_slot_index(uint16_t pageNumber, uint16_t nodeNumber)
+{
+    return (pageNumber - PAGE_PER_SECTOR) * (BYTES_PER_PAGE / BASE_NODE_SIZE) + nodeNumber;
+}
+
+/*! \fn     nodemgmt_free_slot_update(uint16_t address, uint16_t flags)
+*   \brief  Update the free slots bitmap for a node slot that was just written
+*   \param  address     Node slot address
+*   \param  flags       Flags written at the beginning of the node slot
+*/
+static inline void nodemgmt_free_slot_update(uint16_t address, uint16_t flags)
+{
+    uint16_t slot_index = nodemgmt_free_slot_index(nodemgmt_page_from_address(address), nodemgmt_node_from_address(address));
+    
+    if (validBitFromFlags(flags) == NODEMGMT_VBIT_INVALID)
+    {
+        nodemgmt_free_slots_bitmap[slot_index >> 3] |= (1 << (slot_index & 0x07));
+    } 
+    else
+    {
+        nodemgmt_free_slots_bitmap[slot_index >> 3] &= ~(1 << (slot_index & 0x07));
+    }
+}
+
+/*! \fn     nodemgmt_parent_categories_add(uint16_t address, uint16_t category_flags)
+*   \brief  Add a child category to the parent categories map
+*   \param  address         Parent node address
+*   \param  category_flags  Category flags of a child below that parent
+*   \note   Children without a category (or with an invalid one) only show when no category is selected, which doesn't use the map
+*/
+static inline void nodemgmt_parent_categories_add(uint16_t address, uint16_t category_flags)
+{
+    uint16_t slot_index = nodemgmt_free_slot_index(nodemgmt_page_from_address(address), nodemgmt_node_from_address(address));
+    
+    if ((category_flags != 0) && ((category_flags & (category_flags - 1)) == 0) && ((category_flags & NODEMGMT_CAT_MASK_FINAL) == category_flags))
+    {
+        nodemgmt_parent_categories_map[slot_index >> 1] |= (uint8_t)(category_flags << ((slot_index & 0x01) * 4));
+    }
+}
+
+/*! \fn     nodemgmt_parent_categories_clear(uint16_t address)
+*   \brief  Clear the categories of a given parent in the parent categories map
+*   \param  address         Parent node address
+*/
+static inline void nodemgmt_parent_categories_clear(uint16_t address)
+{
+    uint16_t slot_index = nodemgmt_free_slot_index(nodemgmt_page_from_address(address), nodemgmt_node_from_address(address));
+    nodemgmt_parent_categories_map[slot_index >> 1] &= (uint8_t)~(NODEMGMT_CAT_MASK_FINAL << ((slot_index & 0x01) * 4));
+}
+
+/*! \fn     nodemgmt_parent_categories_get(uint16_t address)
+*   \brief  Get the ORed category flags of the children below a given parent
+*   \param  address         Parent node address
+*   \return The category flags
+*/
+static inline uint16_t nodemgmt_parent_categories_get(uint16_t address)
+{
+    uint16_t slot_index = nodemgmt_free_slot_index(nodemgmt_page_from_address(address), nodemgmt_node_from_address(address));
+    return (nodemgmt_parent_categories_map[slot_index >> 1] >> ((slot_index & 0x01) * 4)) & NODEMGMT_CAT_MASK_FINAL;
+}
+
 /*! \fn     nodemgmt_construct_date(uint16_t year, uint16_t month, uint16_t day)
 *   \brief  Packs a uint16_t type with a date code in format YYYYYYYMMMMDDDDD. Year Offset from 2010
 *   \param  year            The year to pack into the uint16_t
@@ -276,6 +366,7 @@ void nodemgmt_write_parent_node_data_block_to_flash(uint16_t address, parent_nod
     nodemgmt_check_address_validity_and_lock(address);
     nodemgmt_user_id_to_flags(&(parent_node->cred_parent.flags), nodemgmt_current_handle.currentUserId);
     dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), BASE_NODE_SIZE, (void*)parent_node->node_as_bytes);
+    nodemgmt_free_slot_update(address, parent_node->cred_parent.flags);
 }
 
 /*! \fn     nodemgmt_write_child_node_block_to_flash(uint16_t address, child_node_t* child_node, BOOL write_category)
@@ -304,6 +395,48 @@ void nodemgmt_write_child_node_block_to_flash(uint16_t address, child_node_t* ch
     nodemgmt_check_address_validity_and_lock(address);
     dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), BASE_NODE_SIZE, (void*)child_node->node_as_bytes);
     dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(nodemgmt_get_incremented_address(address)), BASE_NODE_SIZE * nodemgmt_node_from_address(nodemgmt_get_incremented_address(address)), BASE_NODE_SIZE, (void*)(&child_node->node_as_bytes[BASE_NODE_SIZE]));
+    nodemgmt_free_slot_update(address, child_node->cred_child.flags);
+    nodemgmt_free_slot_update(nodemgmt_get_incremented_address(address), child_node->cred_child.fakeFlags);
+}
+
+/*! \fn     nodemgmt_write_node_data_block_with_trailing_zeros(uint16_t address, BOOL child_node, uint8_t* data, uint16_t data_length)
+*   \brief  Write a node data block to flash, zero padded up to the node size
+*   \param  address     Where to write
+*   \param  child_node  TRUE for a child node, FALSE for a parent node
+*   \param  data        Node data, as returned by nodemgmt_read_node_data_block_without_trailing_zeros()
+*   \param  data_length Node data length, not more than the node size
+*   \note   Node halves are padded in the temporary parent node, flags are enforced as in the full node write functions
+*/
+void nodemgmt_write_node_data_block_with_trailing_zeros(uint16_t address, BOOL child_node, uint8_t* data, uint16_t data_length)
+{
+    parent_node_t* temp_half_node_pt = &nodemgmt_current_handle.temp_parent_node;
+    uint16_t second_address = nodemgmt_get_incremented_address(address);
+    
+    /* First half: a parent node is written as is */
+    memset(temp_half_node_pt, 0, sizeof(*temp_half_node_pt));
+    memcpy(temp_half_node_pt->node_as_bytes, data, (data_length < BASE_NODE_SIZE) ? data_length : BASE_NODE_SIZE);
+    if (child_node == FALSE)
+    {
+        nodemgmt_write_parent_node_data_block_to_flash(address, temp_half_node_pt);
+        return;
+    }
+    
+    /* Child node: both halves start with flags, enforce user ID */
+    nodemgmt_user_id_to_flags(&(temp_half_node_pt->cred_parent.flags), nodemgmt_current_handle.currentUserId);
+    nodemgmt_check_address_validity_and_lock(address);
+    dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), BASE_NODE_SIZE, (void*)temp_half_node_pt->node_as_bytes);
+    nodemgmt_free_slot_update(address, temp_half_node_pt->cred_parent.flags);
+    
+    /* Second half, starting with the fake flags */
+    memset(temp_half_node_pt, 0, sizeof(*temp_half_node_pt));
+    if (data_length > BASE_NODE_SIZE)
+    {
+        memcpy(temp_half_node_pt->node_as_bytes, &data[BASE_NODE_SIZE], data_length - BASE_NODE_SIZE);
+    }
+    nodemgmt_user_id_to_flags(&(temp_half_node_pt->cred_parent.flags), nodemgmt_current_handle.currentUserId);
+    temp_half_node_pt->cred_parent.flags |= (NODEMGMT_VBIT_INVALID << NODEMGMT_CORRECT_FLAGS_BIT_BITSHIFT);
+    dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(second_address), BASE_NODE_SIZE * nodemgmt_node_from_address(second_address), BASE_NODE_SIZE, (void*)temp_half_node_pt->node_as_bytes);
+    nodemgmt_free_slot_update(second_address, temp_half_node_pt->cred_parent.flags);
 }
 
 /*! \fn     nodemgmt_read_parent_node_data_block_from_flash(uint16_t address, parent_node_t* parent_node)
@@ -346,6 +479,62 @@ void nodemgmt_read_child_node_data_block_from_flash(uint16_t address, child_node
     dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), sizeof(child_node->node_as_bytes), (void*)child_node->node_as_bytes);
 }
 
+/*! \fn     nodemgmt_read_node_data_block_without_trailing_zeros(uint16_t address, BOOL child_node, uint8_t* buffer, uint16_t buffer_size)
+*   \brief  Read a node data block to a buffer, leaving out its trailing zero bytes
+*   \param  address     Where to read
+*   \param  child_node  TRUE for a child node, FALSE for a parent node
+*   \param  buffer      Where to store the node data
+*   \param  buffer_size Buffer size
+*   \return Number of node bytes left once trimmed, rounded up to an even number. Nothing is stored if it is bigger than buffer_size
+*   \note   Strings and unused fields are zero padded: most parent nodes are much shorter than their slot
+*/
+uint16_t nodemgmt_read_node_data_block_without_trailing_zeros(uint16_t address, BOOL child_node, uint8_t* buffer, uint16_t buffer_size)
+{
+    uint16_t node_size = (child_node != FALSE) ? sizeof(child_node_t) : sizeof(parent_node_t);
+    uint16_t second_address = nodemgmt_get_incremented_address(address);
+    uint16_t data_length = 0;
+    uint8_t tail_buffer[24];
+    
+    /* Chunks shouldn't cross the two halves of a child node */
+    _Static_assert(BASE_NODE_SIZE % sizeof(tail_buffer) == 0, "Tail buffer doesn't divide the base node size");
+    nodemgmt_check_address_validity_and_lock(address);
+    if (child_node != FALSE)
+    {
+        nodemgmt_check_address_validity_and_lock(second_address);
+    }
+    
+    /* Look for the last non zero byte, from the end of the node */
+    for (uint16_t offset = node_size; (offset != 0) && (data_length == 0);)
+    {
+        offset -= sizeof(tail_buffer);
+        uint16_t chunk_address = (offset < BASE_NODE_SIZE) ? address : second_address;
+        dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(chunk_address), BASE_NODE_SIZE * nodemgmt_node_from_address(chunk_address) + (offset % BASE_NODE_SIZE), sizeof(tail_buffer), (void*)tail_buffer);
+        for (uint16_t i = sizeof(tail_buffer); i != 0; i--)
+        {
+            if (tail_buffer[i-1] != 0)
+            {
+                data_length = offset + i;
+                break;
+            }
+        }
+    }
+    
+    /* Keep node fields aligned for whoever stores several nodes in a row */
+    data_length = (data_length + 1) & ~1;
+    
+    /* Read node data if it fits */
+    if (data_length <= buffer_size)
+    {
+        dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), (data_length < BASE_NODE_SIZE) ? data_length : BASE_NODE_SIZE, (void*)buffer);
+        if (data_length > BASE_NODE_SIZE)
+        {
+            dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(second_address), BASE_NODE_SIZE * nodemgmt_node_from_address(second_address), data_length - BASE_NODE_SIZE, (void*)(&buffer[BASE_NODE_SIZE]));
+        }
+    }
+    
+    return data_length;
+}
+
 /*! \fn     nodemgmt_read_cred_child_node(uint16_t address, child_cred_node_t* child_node)
 *   \brief  Read a child node
 *   \param  address     Where to read
@@ -388,6 +577,44 @@ void nodemgmt_read_cred_child_node_except_pwd(uint16_t address, child_cred_node_
     child_node->description[(sizeof(child_node->description)/sizeof(child_node->description[0]))-1] = 0;
 }
 
+/*! \fn     nodemgmt_read_cred_child_node_first_bytes(uint16_t address, child_cred_node_t* child_node, uint16_t nb_bytes)
+*   \brief  Read the first bytes of a child node, leaving the other fields untouched
+*   \param  address     Where to read
+*   \param  child_node  Pointer to the node
+*   \param  nb_bytes    Number of bytes to read, must at least cover the flags
+*/
+static void nodemgmt_read_cred_child_node_first_bytes(uint16_t address, child_cred_node_t* child_node, uint16_t nb_bytes)
+{
+    nodemgmt_check_address_validity_and_lock(address);
+    dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), nb_bytes, (void*)child_node);
+    nodemgmt_check_user_perm_from_flags_and_lock(child_node->flags);
+}
+
+/*! \fn     nodemgmt_read_cred_child_node_header(uint16_t address, child_cred_node_t* child_node)
+*   \brief  Read a child node header only: flags, addresses and dates
+*   \param  address     Where to read
+*   \param  child_node  Pointer to the node, only the header fields are valid after the call
+*   \note   For list walks and counts, which only need the flags (category) and the next address
+*/
+void nodemgmt_read_cred_child_node_header(uint16_t address, child_cred_node_t* child_node)
+{
+    nodemgmt_read_cred_child_node_first_bytes(address, child_node, offsetof(child_cred_node_t, login));
+}
+
+/*! \fn     nodemgmt_read_cred_child_node_header_and_login(uint16_t address, child_cred_node_t* child_node)
+*   \brief  Read a child node header and login, not the description, third field and password fields
+*   \param  address     Where to read
+*   \param  child_node  Pointer to the node, only the header fields and login are valid after the call
+*   \note   For login lists and searches, reads about half of what nodemgmt_read_cred_child_node_except_pwd reads
+*/
+void nodemgmt_read_cred_child_node_header_and_login(uint16_t address, child_cred_node_t* child_node)
+{
+    nodemgmt_read_cred_child_node_first_bytes(address, child_node, offsetof(child_cred_node_t, login) + sizeof(child_node->login));
+    
+    // String cleaning
+    child_node->login[(sizeof(child_node->login)/sizeof(child_node->login[0]))-1] = 0;
+}
+
 /*! \fn     nodemgmt_read_webauthn_child_node_except_display_name(uint16_t address, child_webauthn_node_t* child_node, BOOL update_date_and_increment_preinc_count)
 *   \brief  Read a webauthn child node but not the display name field
 *   \param  address                                 Where to read
@@ -1056,6 +1283,58 @@ uint16_t nodemgmt_check_for_logins_with_category_in_parent_node(uint16_t start_c
     return NODE_ADDR_NULL;
 }
 
+/*! \fn     nodemgmt_parent_node_has_logins_with_category(uint16_t parent_addr, uint16_t first_child_addr, uint16_t category_flags)
+ *  \brief  See if a credential parent node contains children that have the desired category
+ *  \param  parent_addr         Parent node address
+ *  \param  first_child_addr    Address of the parent first child
+ *  \param  category_flags      Desired category flags
+ *  \return TRUE if a child has the desired category
+ *  \note   Uses the parent categories map, children are only walked when it can't be used
+ */
+BOOL nodemgmt_parent_node_has_logins_with_category(uint16_t parent_addr, uint16_t first_child_addr, uint16_t category_flags)
+{
+    /* No logins at all */
+    if (first_child_addr == NODE_ADDR_NULL)
+    {
+        return FALSE;
+    }
+    
+    /* No category selected: any login will do */
+    if (category_flags == 0)
+    {
+        return TRUE;
+    }
+    
+    /* DB was externally modified since last build */
+    if (nodemgmt_parent_categories_state == SERVICE_INDEX_NEEDS_REBUILD)
+    {
+        nodemgmt_build_parent_categories_map();
+    }
+    
+    /* Use the map if possible */
+    if ((nodemgmt_parent_categories_state == SERVICE_INDEX_UP_TO_DATE) && (nodemgmt_check_address_validity(parent_addr) == RETURN_OK))
+    {
+        if ((nodemgmt_parent_categories_get(parent_addr) & category_flags) != 0)
+        {
+            return TRUE;
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+    
+    /* Walk through the children */
+    if (nodemgmt_check_for_logins_with_category_in_parent_node(first_child_addr, category_flags) != NODE_ADDR_NULL)
+    {
+        return TRUE;
+    }
+    else
+    {
+        return FALSE;
+    }
+}
+
 /*! \fn     nodemgmt_get_prev_parent_node_for_cur_category(uint16_t search_start_parent_addr, uint16_t credential_type_id)
  *  \brief  Gets the prev parent node for the current category
  *  \param  search_start_parent_addr    The parent address from which to start looking.
@@ -1096,7 +1375,7 @@ uint16_t nodemgmt_get_prev_parent_node_for_cur_category(uint16_t search_start_pa
         /* Check if the last node could work */
         nodemgmt_check_address_validity_and_lock(search_start_parent_addr);
         dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(search_start_parent_addr), BASE_NODE_SIZE*nodemgmt_node_from_address(search_start_parent_addr), sizeof(parent_read_buffer), &parent_read_buffer);
-        if (nodemgmt_check_for_logins_with_category_in_parent_node(parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) != NODE_ADDR_NULL)
+        if (nodemgmt_parent_node_has_logins_with_category(search_start_parent_addr, parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) != FALSE)
         {
                 return search_start_parent_addr;
         }
@@ -1115,7 +1394,7 @@ uint16_t nodemgmt_get_prev_parent_node_for_cur_category(uint16_t search_start_pa
         dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(prev_parent_node_addr_to_scan), BASE_NODE_SIZE*nodemgmt_node_from_address(prev_parent_node_addr_to_scan), sizeof(parent_read_buffer), &parent_read_buffer);
 
         /* Check for logins with desired category */
-        if (nodemgmt_check_for_logins_with_category_in_parent_node(parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) != NODE_ADDR_NULL)
+        if (nodemgmt_parent_node_has_logins_with_category(prev_parent_node_addr_to_scan, parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) != FALSE)
         {
             return prev_parent_node_addr_to_scan;
         }
@@ -1174,7 +1453,7 @@ uint16_t nodemgmt_get_next_parent_node_for_cur_category(uint16_t search_start_pa
         next_parent_node_addr_to_scan = parent_node_pt->nextParentAddress;
         
         /* Check that the provided parent node actually belongs to the current category.... */
-        if (nodemgmt_check_for_logins_with_category_in_parent_node(parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) == NODE_ADDR_NULL)
+        if (nodemgmt_parent_node_has_logins_with_category(search_start_parent_addr, parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) == FALSE)
         {
             return NODE_ADDR_NULL;
         }
@@ -1194,7 +1473,7 @@ uint16_t nodemgmt_get_next_parent_node_for_cur_category(uint16_t search_start_pa
         dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_parent_node_addr_to_scan), BASE_NODE_SIZE*nodemgmt_node_from_address(next_parent_node_addr_to_scan), sizeof(parent_read_buffer), &parent_read_buffer);
 
         /* Check for logins with desired category */
-        if (nodemgmt_check_for_logins_with_category_in_parent_node(parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) != NODE_ADDR_NULL)
+        if (nodemgmt_parent_node_has_logins_with_category(next_parent_node_addr_to_scan, parent_node_pt->nextChildAddress, nodemgmt_current_handle.currentCategoryFlags) != FALSE)
         {
             /* Check for single credential */
             if (next_parent_node_addr_to_scan == search_start_parent_addr)
@@ -1726,13 +2005,14 @@ void nodemgmt_set_category_string(uint16_t category_id, cust_char_t* string_pt)
 *   \param  startPage       Page where to start the scanning
 *   \param  startNode       Scan start node address inside the start page
 *   \return the number of nodes found
+*   \note   Uses the free slots bitmap, which is built the first time free nodes are looked for after login
 */
 uint16_t nodemgmt_find_free_nodes(uint16_t nbParentNodes, uint16_t* parentNodeArray, uint16_t nbChildtNodes, uint16_t* childNodeArray, uint16_t startPage, uint16_t startNode)
 {
     uint16_t prevFreeAddressFound = NODE_ADDR_NULL;
     uint16_t nbParentNodesFound = 0;
     uint16_t nbChildNodesFound = 0;
-    uint16_t nodeFlags;
+    BOOL slot_free;
     uint16_t pageItr;
     uint16_t nodeItr;
     
@@ -1741,6 +2021,12 @@ uint16_t nodemgmt_find_free_nodes(uint16_t nbParentNodes, uint16_t* parentNodeAr
         return 0;
 #endif
 
+    // Free slots bitmap isn't built at login, as most sessions do not create nodes
+    if (nodemgmt_free_slots_bitmap_valid == FALSE)
+    {
+        nodemgmt_build_free_slots_bitmap();
+    }
+
     // Check the start page
     if (startPage < PAGE_PER_SECTOR)
     {
@@ -1753,11 +2039,21 @@ uint16_t nodemgmt_find_free_nodes(uint16_t nbParentNodes, uint16_t* parentNodeAr
         // for each possible parent node in the page (changes per flash chip)
         for(nodeItr = startNode; nodeItr < BYTES_PER_PAGE/BASE_NODE_SIZE; nodeItr++)
         {
-            // read node flags (2 bytes - fixed size)
-            dbflash_read_data_from_flash(&dbflash_descriptor, pageItr, BASE_NODE_SIZE*nodeItr, sizeof(nodeFlags), &nodeFlags);
+            uint16_t slot_index = nodemgmt_free_slot_index(pageItr, nodeItr);
+            
+            // Skip 8 used slots at once
+            if (((slot_index & 0x07) == 0) && (nodemgmt_free_slots_bitmap[slot_index >> 3] == 0))
+            {
+                pageItr += (8 / (BYTES_PER_PAGE/BASE_NODE_SIZE)) - 1;
+                prevFreeAddressFound = NODE_ADDR_NULL;
+                break;
+            }
+            
+            // use the bitmap to know if the slot is free
+            slot_free = ((nodemgmt_free_slots_bitmap[slot_index >> 3] & (1 << (slot_index & 0x07))) != 0) ? TRUE : FALSE;
             
             // If this slot is OK
-            if(validBitFromFlags(nodeFlags) == NODEMGMT_VBIT_INVALID)
+            if (slot_free != FALSE)
             {
                 // fill parent nodes first (only one block)
                 if (nbParentNodesFound != nbParentNodes)
@@ -1802,6 +2098,94 @@ uint16_t nodemgmt_find_free_nodes(uint16_t nbParentNodes, uint16_t* parentNodeAr
     return nbChildNodesFound+nbParentNodesFound;
 }
 
+/*! \fn     nodemgmt_build_free_slots_bitmap(void)
+*   \brief  Read the flags of all node slots to build the free slots bitmap
+*   \note   Bitmap is then kept up to date by the node write & delete functions
+*/
+void nodemgmt_build_free_slots_bitmap(void)
+{
+    uint16_t nodeFlags;
+    
+    _Static_assert(NODEMGMT_FREE_SLOTS_BITMAP_SIZE <= MAP_BYTES, "Free slots bitmap is bigger than the node usage map");
+    _Static_assert((NODEMGMT_FREE_SLOTS_NB_SLOTS % 8) == 0, "Free slots bitmap doesn't end on a byte boundary");
+    
+    for (uint16_t pageItr = PAGE_PER_SECTOR; pageItr < PAGE_COUNT; pageItr++)
+    {
+        for (uint16_t nodeItr = 0; nodeItr < BYTES_PER_PAGE/BASE_NODE_SIZE; nodeItr++)
+        {
+            dbflash_read_data_from_flash(&dbflash_descriptor, pageItr, BASE_NODE_SIZE*nodeItr, sizeof(nodeFlags), &nodeFlags);
+            nodemgmt_free_slot_update(constructAddress(pageItr, nodeItr), nodeFlags);
+        }
+    }
+    
+    nodemgmt_free_slots_bitmap_valid = TRUE;
+}
+
+/*! \fn     nodemgmt_build_parent_categories_map(void)
+*   \brief  Walk through all the credential parents of the current user and their children to build the parent categories map
+*   \note   Map is then kept up to date by the node create functions, and is left in fallback mode if a linked list looks corrupted
+*/
+void nodemgmt_build_parent_categories_map(void)
+{
+    uint32_t nb_nodes_scanned = 0;
+    uint16_t child_read_buffer[4];
+    uint16_t parent_read_buffer[4];
+    uint16_t next_parent_addr;
+    uint16_t next_child_addr;
+    
+    /* Sanity check for this hack */
+    _Static_assert(NODEMGMT_NB_MAX_CATEGORIES-1 <= 4, "Category flags do not fit in a nibble");
+    _Static_assert(0 == offsetof(child_cred_node_t, flags), "Incorrect buffer for flags & addr read");
+    _Static_assert(4 == offsetof(child_cred_node_t, nextChildAddress), "Incorrect buffer for flags & addr read");
+    _Static_assert(4 == offsetof(parent_cred_node_t, nextParentAddress), "Incorrect buffer for flags & addr read");
+    _Static_assert(6 == offsetof(parent_cred_node_t, nextChildAddress), "Incorrect buffer for flags & addr read");
+    
+    /* Hack to read flags & prev / next address */
+    parent_cred_node_t* parent_node_pt = (parent_cred_node_t*)parent_read_buffer;
+    child_cred_node_t* child_node_pt = (child_cred_node_t*)child_read_buffer;
+    
+    /* Start from an empty map */
+    memset(nodemgmt_parent_categories_map, 0, sizeof(nodemgmt_parent_categories_map));
+    nodemgmt_parent_categories_state = SERVICE_INDEX_UP_TO_DATE;
+    
+    /* Browse through all credential parent linked lists */
+    for (uint16_t i = 0; i < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes); i++)
+    {
+        next_parent_addr = nodemgmt_current_handle.firstCredParentNodes[i];
+        
+        while (next_parent_addr != NODE_ADDR_NULL)
+        {
+            /* Do not lock on invalid DB contents or looping linked lists, let the child walks deal with it */
+            if ((nodemgmt_check_address_validity(next_parent_addr) != RETURN_OK) || (nb_nodes_scanned++ > NODEMGMT_FREE_SLOTS_NB_SLOTS))
+            {
+                nodemgmt_parent_categories_state = SERVICE_INDEX_FALLBACK;
+                return;
+            }
+            
+            /* Read flags and addresses */
+            dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_parent_addr), BASE_NODE_SIZE*nodemgmt_node_from_address(next_parent_addr), sizeof(parent_read_buffer), &parent_read_buffer);
+            next_child_addr = parent_node_pt->nextChildAddress;
+            
+            /* Go through its children */
+            while (next_child_addr != NODE_ADDR_NULL)
+            {
+                if ((nodemgmt_check_address_validity(next_child_addr) != RETURN_OK) || (nb_nodes_scanned++ > NODEMGMT_FREE_SLOTS_NB_SLOTS))
+                {
+                    nodemgmt_parent_categories_state = SERVICE_INDEX_FALLBACK;
+                    return;
+                }
+                
+                /* Read flags and addresses */
+                dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_child_addr), BASE_NODE_SIZE*nodemgmt_node_from_address(next_child_addr), sizeof(child_read_buffer), &child_read_buffer);
+                nodemgmt_parent_categories_add(next_parent_addr, categoryFromFlags(child_node_pt->flags));
+                next_child_addr = child_node_pt->nextChildAddress;
+            }
+            
+            next_parent_addr = parent_node_pt->nextParentAddress;
+        }
+    }
+}
+
 /*! \fn     nodemgmt_trigger_db_ext_changed_actions(void)
 *   \brief  Function called to perform actions needed when db was externally changed
 */
@@ -1809,17 +2193,33 @@ void nodemgmt_trigger_db_ext_changed_actions(void)
 {
     // Scan last parent nodes
     nodemgmt_scan_for_last_parent_nodes();
+    
+    // Rebuild service name index & parent categories map
+    nodemgmt_service_index_build();
+    nodemgmt_build_parent_categories_map();
+    
+    // First letter index will be rebuilt when needed
+    nodemgmt_fletter_index_invalidate();
 }
 
 /*! \fn     nodemgmt_scan_node_usage(void)
 *   \brief  Scan memory to find empty slots
+*   \note   Parent and child slots are looked for separately: both may point to the same free slot, as memory is scanned again after each node creation
 */
 void nodemgmt_scan_node_usage(void)
 {
-    // Find one free node. If we don't find it, set the next to the null addr, we start looking from the just taken node
-    if (nodemgmt_find_free_nodes(1, &nodemgmt_current_handle.nextParentFreeNode, 1, &nodemgmt_current_handle.nextChildFreeNode, nodemgmt_page_from_address(nodemgmt_current_handle.nextParentFreeNode), nodemgmt_node_from_address(nodemgmt_current_handle.nextParentFreeNode)) != 2)
+    uint16_t start_page = nodemgmt_page_from_address(nodemgmt_current_handle.nextParentFreeNode);
+    uint16_t start_node = nodemgmt_node_from_address(nodemgmt_current_handle.nextParentFreeNode);
+    
+    // Find one free parent node, we start looking from the just taken node then from the start of the memory for slots freed behind it
+    if ((nodemgmt_find_free_nodes(1, &nodemgmt_current_handle.nextParentFreeNode, 0, NULL, start_page, start_node) == 0) && (nodemgmt_find_free_nodes(1, &nodemgmt_current_handle.nextParentFreeNode, 0, NULL, 0, 0) == 0))
     {
         nodemgmt_current_handle.nextParentFreeNode = NODE_ADDR_NULL;
+    }
+    
+    // Same for the child node, so that the last free slots can still take a child when there is no room for a parent as well
+    if ((nodemgmt_find_free_nodes(0, NULL, 1, &nodemgmt_current_handle.nextChildFreeNode, start_page, start_node) == 0) && (nodemgmt_find_free_nodes(0, NULL, 1, &nodemgmt_current_handle.nextChildFreeNode, 0, 0) == 0))
+    {
         nodemgmt_current_handle.nextChildFreeNode = NODE_ADDR_NULL;
     }
 }
@@ -1960,6 +2360,415 @@ void nodemgmt_scan_for_last_parent_nodes(void)
     }
 }
 
+/*! \fn     nodemgmt_service_index_get_key(cust_char_t* service, BOOL cred_type, uint16_t type_id)
+ *  \brief  Compute the service index key for a given service name & type
+ *  \param  service     Service name
+ *  \param  cred_type   TRUE for a credential service, FALSE for a data service
+ *  \param  type_id     Credential / data type ID
+ *  \return The type key in the MSBs and the service name hash in the LSBs
+ */
+static uint16_t nodemgmt_service_index_get_key(cust_char_t* service, BOOL cred_type, uint16_t type_id)
+{
+    uint32_t hash = 2166136261UL;
+    
+    /* Type keys must fit in the bits left by the hash */
+    _Static_assert((MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstDataParentNodes)) <= (1 << (16 - NODEMGMT_SERVICE_INDEX_TYPE_BITSHIFT)), "Too many credential / data types for the service index key");
+    
+    /* FNV-1a, over the characters a cleaned parent node service field can hold */
+    for (uint16_t i = 0; (i < SERVICE_NAME_MAX_LEN-1) && (service[i] != 0); i++)
+    {
+        hash ^= service[i];
+        hash *= 16777619UL;
+    }
+    
+    /* Data types are stored after credential types */
+    if (cred_type == FALSE)
+    {
+        type_id += MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes);
+    }
+    
+    return (uint16_t)(type_id << NODEMGMT_SERVICE_INDEX_TYPE_BITSHIFT) | (uint16_t)((hash ^ (hash >> 16)) & NODEMGMT_SERVICE_INDEX_HASH_MASK);
+}
+
+/*! \fn     nodemgmt_service_index_insert(uint16_t key, uint16_t parent_addr)
+ *  \brief  Insert a parent address in the service index
+ *  \param  key             Service index key
+ *  \param  parent_addr     Parent node address
+ *  \return RETURN_NOK if the index is too full to take it
+ */
+static RET_TYPE nodemgmt_service_index_insert(uint16_t key, uint16_t parent_addr)
+{
+    uint16_t slot = key % NODEMGMT_SERVICE_INDEX_NB_ENTRIES;
+    
+    /* Keep enough empty slots for probing to stay short */
+    if (nodemgmt_service_index_nb_used_slots >= NODEMGMT_SERVICE_INDEX_MAX_FILL)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Linear probing */
+    while (nodemgmt_service_index[slot].parent_addr != NODE_ADDR_NULL)
+    {
+        slot = (slot + 1) % NODEMGMT_SERVICE_INDEX_NB_ENTRIES;
+    }
+    
+    /* Store entry */
+    nodemgmt_service_index[slot].type_and_hash = key;
+    nodemgmt_service_index[slot].parent_addr = parent_addr;
+    nodemgmt_service_index_nb_used_slots++;
+    return RETURN_OK;
+}
+
+/*! \fn     nodemgmt_service_index_invalidate(void)
+ *  \brief  Flag the service index for rebuild, to be called when the DB is externally modified
+ *  \note   The first letter index and parent categories map are flagged for rebuild as well
+ */
+void nodemgmt_service_index_invalidate(void)
+{
+    nodemgmt_parent_categories_state = SERVICE_INDEX_NEEDS_REBUILD;
+    nodemgmt_service_index_state = SERVICE_INDEX_NEEDS_REBUILD;
+    nodemgmt_fletter_index_invalidate();
+}
+
+/*! \fn     nodemgmt_service_index_build(void)
+ *  \brief  Walk through all the parent nodes of the current user to build the service index
+ *  \note   Index is left in fallback mode if a linked list looks corrupted
+ *  \note   If it can't hold all services, it holds the first ones of the (sorted) parent lists and stores where each first character run of the other ones starts
+ */
+void nodemgmt_service_index_build(void)
+{
+    uint16_t nb_parents_browsed = 0;
+    uint16_t next_parent_addr;
+    parent_node_t temp_pnode;
+    BOOL cred_type;
+    uint16_t type_id;
+    
+    /* Start from an empty index */
+    memset(nodemgmt_service_index, 0, sizeof(nodemgmt_service_index));
+    nodemgmt_service_index_state = SERVICE_INDEX_UP_TO_DATE;
+    nodemgmt_service_index_nb_used_slots = 0;
+    nodemgmt_service_index_nb_runs = 0;
+    
+    /* Browse through all credential & data parent linked lists */
+    for (uint16_t i = 0; i < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstDataParentNodes); i++)
+    {
+        if (i < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes))
+        {
+            type_id = i;
+            cred_type = TRUE;
+            next_parent_addr = nodemgmt_current_handle.firstCredParentNodes[type_id];
+        }
+        else
+        {
+            type_id = i - MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes);
+            cred_type = FALSE;
+            next_parent_addr = nodemgmt_current_handle.firstDataParentNodes[type_id];
+        }
+        
+        while (next_parent_addr != NODE_ADDR_NULL)
+        {
+            /* Do not lock on invalid DB contents or looping linked lists, let the linear searches deal with it */
+            if ((nodemgmt_check_address_validity(next_parent_addr) != RETURN_OK) || (nb_parents_browsed++ >= NODEMGMT_FREE_SLOTS_NB_SLOTS))
+            {
+                nodemgmt_service_index_state = SERVICE_INDEX_FALLBACK;
+                return;
+            }
+            
+            /* Read parent node */
+            nodemgmt_read_parent_node_data_block_from_flash(next_parent_addr, &temp_pnode);
+            if (nodemgmt_check_user_perm_from_flags(temp_pnode.cred_parent.flags) != RETURN_OK)
+            {
+                nodemgmt_service_index_state = SERVICE_INDEX_FALLBACK;
+                return;
+            }
+            
+            /* Add it to the index, then once it is full store where the runs of services sharing the same first character start */
+            if ((nodemgmt_service_index_nb_runs != 0) || (nodemgmt_service_index_insert(nodemgmt_service_index_get_key(temp_pnode.cred_parent.service, cred_type, type_id), next_parent_addr) != RETURN_OK))
+            {
+                if ((nodemgmt_service_index_nb_runs == 0) || (nodemgmt_service_index_runs[nodemgmt_service_index_nb_runs-1].type_key != i) || (nodemgmt_service_index_runs[nodemgmt_service_index_nb_runs-1].fchar < temp_pnode.cred_parent.service[0]))
+                {
+                    /* New run, the last one spans until the end of its linked list */
+                    if (nodemgmt_service_index_nb_runs == NODEMGMT_SERVICE_INDEX_NB_RUNS)
+                    {
+                        return;
+                    }
+                    nodemgmt_service_index_runs[nodemgmt_service_index_nb_runs].type_key = i;
+                    nodemgmt_service_index_runs[nodemgmt_service_index_nb_runs].fchar = temp_pnode.cred_parent.service[0];
+                    nodemgmt_service_index_runs[nodemgmt_service_index_nb_runs].parent_addr = next_parent_addr;
+                    nodemgmt_service_index_nb_runs++;
+                }
+                else if (nodemgmt_service_index_runs[nodemgmt_service_index_nb_runs-1].fchar > temp_pnode.cred_parent.service[0])
+                {
+                    /* Linked list isn't sorted */
+                    nodemgmt_service_index_state = SERVICE_INDEX_FALLBACK;
+                    return;
+                }
+            }
+            next_parent_addr = temp_pnode.cred_parent.nextParentAddress;
+        }
+    }
+}
+
+/*! \fn     nodemgmt_service_index_search(cust_char_t* name, BOOL cred_type, uint16_t type_id, uint16_t* parent_addr)
+ *  \brief  Use the service index to find a service matching a given name
+ *  \param  name            Name of the service
+ *  \param  cred_type       TRUE for a credential service, FALSE for a data service
+ *  \param  type_id         Credential / data type ID
+ *  \param  parent_addr     Where to store the parent address, NODE_ADDR_NULL if the service doesn't exist
+ *  \return RETURN_OK if the index could be used, RETURN_NOK if the parent linked list should be walked instead
+ *  \note   Only costs one flash read per index entry sharing the same key, usually one
+ *  \note   When returning RETURN_NOK, parent_addr is where the walk can start (run of a service a full index can't hold) or NODE_ADDR_NULL for the list start
+ */
+RET_TYPE nodemgmt_service_index_search(cust_char_t* name, BOOL cred_type, uint16_t type_id, uint16_t* parent_addr)
+{
+    parent_node_t temp_pnode;
+    
+    /* Walk from the list start by default */
+    *parent_addr = NODE_ADDR_NULL;
+    
+    /* Boundary checks */
+    if (((cred_type != FALSE) && (type_id >= MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes))) || ((cred_type == FALSE) && (type_id >= MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstDataParentNodes))))
+    {
+        return RETURN_NOK;
+    }
+    
+    /* DB was externally modified since last build */
+    if (nodemgmt_service_index_state == SERVICE_INDEX_NEEDS_REBUILD)
+    {
+        nodemgmt_service_index_build();
+    }
+    
+    /* Index can't be used */
+    if (nodemgmt_service_index_state != SERVICE_INDEX_UP_TO_DATE)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Go through the slots until an empty one is found */
+    uint16_t key = nodemgmt_service_index_get_key(name, cred_type, type_id);
+    uint16_t slot = key % NODEMGMT_SERVICE_INDEX_NB_ENTRIES;
+    while (nodemgmt_service_index[slot].parent_addr != NODE_ADDR_NULL)
+    {
+        if (nodemgmt_service_index[slot].type_and_hash == key)
+        {
+            /* Same key, check the actual service name */
+            nodemgmt_read_parent_node(nodemgmt_service_index[slot].parent_addr, &temp_pnode, TRUE);
+            if (utils_custchar_strncmp(name, temp_pnode.cred_parent.service, ARRAY_SIZE(temp_pnode.cred_parent.service)) == 0)
+            {
+                *parent_addr = nodemgmt_service_index[slot].parent_addr;
+                return RETURN_OK;
+            }
+        }
+        
+        slot = (slot + 1) % NODEMGMT_SERVICE_INDEX_NB_ENTRIES;
+    }
+    
+    /* Index was full: look for the run the service would be in */
+    if (nodemgmt_service_index_nb_runs != 0)
+    {
+        uint16_t type_key = (cred_type != FALSE)? type_id : type_id + MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes);
+        BOOL type_key_found = FALSE;
+        
+        /* Runs are sorted by type key then first character */
+        for (uint16_t i = 0; i < nodemgmt_service_index_nb_runs; i++)
+        {
+            if (nodemgmt_service_index_runs[i].type_key == type_key)
+            {
+                type_key_found = TRUE;
+                if (nodemgmt_service_index_runs[i].fchar <= name[0])
+                {
+                    *parent_addr = nodemgmt_service_index_runs[i].parent_addr;
+                }
+            }
+        }
+        
+        /* Found the run that may contain the service */
+        if (*parent_addr != NODE_ADDR_NULL)
+        {
+            return RETURN_NOK;
+        }
+        
+        /* Runs ran out before this type: walk the complete list */
+        if ((type_key_found == FALSE) && (type_key > nodemgmt_service_index_runs[nodemgmt_service_index_nb_runs-1].type_key))
+        {
+            return RETURN_NOK;
+        }
+    }
+    
+    /* Service doesn't exist */
+    *parent_addr = NODE_ADDR_NULL;
+    return RETURN_OK;
+}
+
+/*! \fn     nodemgmt_fletter_index_invalidate(void)
+ *  \brief  Flag the first letter index for rebuild, to be called when a parent may have changed category membership
+ */
+void nodemgmt_fletter_index_invalidate(void)
+{
+    nodemgmt_fletter_index_state = SERVICE_INDEX_NEEDS_REBUILD;
+}
+
+/*! \fn     nodemgmt_fletter_index_build(uint16_t credential_type_id)
+ *  \brief  Walk through the parent nodes of a given credential type to build the first letter index for the current category
+ *  \param  credential_type_id  Credential type ID
+ *  \note   Index is left in fallback mode if there are too many different first letters or if the linked list looks corrupted
+ */
+void nodemgmt_fletter_index_build(uint16_t credential_type_id)
+{
+    uint16_t next_parent_addr = NODE_ADDR_NULL;
+    uint16_t parent_read_buffer[5];
+    uint32_t nb_parents_scanned = 0;
+    
+    /* Sanity check for this hack */
+    _Static_assert(0 == offsetof(parent_cred_node_t, flags), "Incorrect buffer for flags & addr read");
+    _Static_assert(4 == offsetof(parent_cred_node_t, nextParentAddress), "Incorrect buffer for flags & addr read");
+    _Static_assert(6 == offsetof(parent_cred_node_t, nextChildAddress), "Incorrect buffer for flags & addr read");
+    _Static_assert(8 == offsetof(parent_cred_node_t, service), "Incorrect buffer for flags & addr read");
+    _Static_assert(sizeof(parent_read_buffer) == offsetof(parent_cred_node_t, service) + sizeof(cust_char_t), "Incorrect buffer for flags & addr read");
+    
+    /* Hack to read flags, prev / next address and first service char */
+    parent_cred_node_t* parent_node_pt = (parent_cred_node_t*)parent_read_buffer;
+    
+    /* Start from an empty index */
+    nodemgmt_fletter_index_category_flags = nodemgmt_current_handle.currentCategoryFlags;
+    nodemgmt_fletter_index_cred_type_id = credential_type_id;
+    nodemgmt_fletter_index_state = SERVICE_INDEX_UP_TO_DATE;
+    nodemgmt_fletter_index_nb_entries = 0;
+    
+    /* Boundary checks */
+    if (credential_type_id >= MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes))
+    {
+        nodemgmt_fletter_index_state = SERVICE_INDEX_FALLBACK;
+        return;
+    }
+    
+    /* Browse through the parent linked list */
+    next_parent_addr = nodemgmt_current_handle.firstCredParentNodes[credential_type_id];
+    while (next_parent_addr != NODE_ADDR_NULL)
+    {
+        /* Do not lock on invalid DB contents or looping linked lists, let the linear searches deal with it */
+        if ((nodemgmt_check_address_validity(next_parent_addr) != RETURN_OK) || (nb_parents_scanned++ > NODEMGMT_FREE_SLOTS_NB_SLOTS))
+        {
+            nodemgmt_fletter_index_state = SERVICE_INDEX_FALLBACK;
+            return;
+        }
+        
+        /* Read flags, addresses and first char */
+        dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_parent_addr), BASE_NODE_SIZE*nodemgmt_node_from_address(next_parent_addr), sizeof(parent_read_buffer), &parent_read_buffer);
+        if (nodemgmt_check_user_perm_from_flags(parent_node_pt->flags) != RETURN_OK)
+        {
+            nodemgmt_fletter_index_state = SERVICE_INDEX_FALLBACK;
+            return;
+        }
+        
+        /* Only services with logins in the current category are listed */
+        if (nodemgmt_parent_node_has_logins_with_category(next_parent_addr, parent_node_pt->nextChildAddress, nodemgmt_fletter_index_category_flags) != FALSE)
+        {
+            /* Services are sorted: a first char can only start a new run */
+            if ((nodemgmt_fletter_index_nb_entries == 0) || (parent_node_pt->service[0] > nodemgmt_fletter_index[nodemgmt_fletter_index_nb_entries-1].fchar))
+            {
+                if (nodemgmt_fletter_index_nb_entries >= ARRAY_SIZE(nodemgmt_fletter_index))
+                {
+                    nodemgmt_fletter_index_state = SERVICE_INDEX_FALLBACK;
+                    return;
+                }
+                
+                /* New run */
+                nodemgmt_fletter_index[nodemgmt_fletter_index_nb_entries].fchar = parent_node_pt->service[0];
+                nodemgmt_fletter_index[nodemgmt_fletter_index_nb_entries].parent_addr = next_parent_addr;
+                nodemgmt_fletter_index_nb_entries++;
+            }
+            else if (parent_node_pt->service[0] < nodemgmt_fletter_index[nodemgmt_fletter_index_nb_entries-1].fchar)
+            {
+                nodemgmt_fletter_index_state = SERVICE_INDEX_FALLBACK;
+                return;
+            }
+        }
+        
+        next_parent_addr = parent_node_pt->nextParentAddress;
+    }
+}
+
+/*! \fn     nodemgmt_fletter_index_get_jump(uint16_t credential_type_id, cust_char_t cur_char, BOOL next_letter, cust_char_t* char_array, uint16_t* parent_addr)
+ *  \brief  Use the first letter index to find the services having the previous / next first letters in the current category
+ *  \param  credential_type_id  Credential type ID
+ *  \param  cur_char            The current first char
+ *  \param  next_letter         TRUE to jump to the next letter, FALSE to jump to the previous one
+ *  \param  char_array          An array for 2 chars: the 2 previous letters or the 2 next letters, in alphabetical order
+ *  \param  parent_addr         Where to store the first parent address for the letter jumped to, NODE_ADDR_NULL if there's only one letter
+ *  \return RETURN_OK if the index could be used, RETURN_NOK if the parent linked list should be walked instead
+ *  \note   When only 2 letters exist, the last char of the array is the current one
+ */
+RET_TYPE nodemgmt_fletter_index_get_jump(uint16_t credential_type_id, cust_char_t cur_char, BOOL next_letter, cust_char_t* char_array, uint16_t* parent_addr)
+{
+    int16_t nb_entries = (int16_t)nodemgmt_fletter_index_nb_entries;
+    int16_t lower_index = 0;
+    int16_t upper_index = nb_entries-1;
+    int16_t cur_index = -1;
+    
+    /* Category or credential type changed since last build, or DB changed */
+    if ((nodemgmt_fletter_index_state == SERVICE_INDEX_NEEDS_REBUILD) || (nodemgmt_fletter_index_category_flags != nodemgmt_current_handle.currentCategoryFlags) || (nodemgmt_fletter_index_cred_type_id != credential_type_id))
+    {
+        nodemgmt_fletter_index_build(credential_type_id);
+        nb_entries = (int16_t)nodemgmt_fletter_index_nb_entries;
+        upper_index = nb_entries-1;
+    }
+    
+    /* Index can't be used */
+    if (nodemgmt_fletter_index_state != SERVICE_INDEX_UP_TO_DATE)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Binary search for the current char */
+    while (lower_index <= upper_index)
+    {
+        int16_t middle_index = (lower_index + upper_index) / 2;
+        
+        if (nodemgmt_fletter_index[middle_index].fchar == cur_char)
+        {
+            cur_index = middle_index;
+            break;
+        }
+        else if (nodemgmt_fletter_index[middle_index].fchar < cur_char)
+        {
+            lower_index = middle_index + 1;
+        }
+        else
+        {
+            upper_index = middle_index - 1;
+        }
+    }
+    
+    /* Current char isn't known: let the linear search deal with it */
+    if (cur_index < 0)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Only one letter */
+    if (nb_entries < 2)
+    {
+        *parent_addr = NODE_ADDR_NULL;
+        return RETURN_OK;
+    }
+    
+    /* Runs wrap over, as the services list does */
+    if (next_letter != FALSE)
+    {
+        char_array[0] = nodemgmt_fletter_index[(cur_index + 1) % nb_entries].fchar;
+        char_array[1] = nodemgmt_fletter_index[(cur_index + 2) % nb_entries].fchar;
+        *parent_addr = nodemgmt_fletter_index[(cur_index + 1) % nb_entries].parent_addr;
+    }
+    else
+    {
+        char_array[1] = nodemgmt_fletter_index[(cur_index + nb_entries - 1) % nb_entries].fchar;
+        char_array[0] = nodemgmt_fletter_index[(cur_index + nb_entries - 2) % nb_entries].fchar;
+        *parent_addr = nodemgmt_fletter_index[(cur_index + nb_entries - 1) % nb_entries].parent_addr;
+    }
+    return RETURN_OK;
+}
+
 /*! \fn     nodemgmt_get_user_language_for_user_id(uint16_t userIdNum)
  *  \brief  Get the user language for a given user id
  *  \return The user language id
@@ -2037,8 +2846,17 @@ void nodemgmt_init_context(uint16_t userIdNum, uint16_t* userSecFlags, uint16_t*
     // Scan for last parent nodes
     nodemgmt_scan_for_last_parent_nodes();
     
-    // scan for next free parent and child nodes from the start of the memory
-    nodemgmt_scan_node_usage();
+    // Build service name index & parent categories map
+    nodemgmt_service_index_build();
+    nodemgmt_build_parent_categories_map();
+    
+    // Build first letter index for the service selection screen
+    nodemgmt_fletter_index_build(NODEMGMT_STANDARD_CRED_TYPE_ID);
+    
+    // free slots bitmap and next free parent and child nodes are only looked for when a first node is created, from the start of the memory (not from where the previous user left off)
+    nodemgmt_free_slots_bitmap_valid = FALSE;
+    nodemgmt_current_handle.nextParentFreeNode = NODE_ADDR_NULL;
+    nodemgmt_current_handle.nextChildFreeNode = NODE_ADDR_NULL;
     
     // Check if the number of known languages/layouts is different from the one we currently have, and reset the language if so
     if ((nodemgmt_get_user_nb_known_languages() != custom_fs_get_number_of_languages()) || (nodemgmt_get_user_nb_known_keyboard_layouts() != custom_fs_get_number_of_keyb_layouts()))
@@ -2105,6 +2923,9 @@ void nodemgmt_delete_current_user_from_flash(void)
     // Delete user profile memory
     nodemgmt_format_user_profile(nodemgmt_current_handle.currentUserId, 0, 0, 0, 0);
     
+    // Services are about to disappear
+    nodemgmt_service_index_invalidate();
+    
     // Then browse through all the credentials to delete them
     for (uint16_t i = 0; i < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstDataParentNodes); i++)
     {
@@ -2152,6 +2973,8 @@ void nodemgmt_delete_current_user_from_flash(void)
                 // Delete child data block
                 dbflash_write_data_pattern_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_child_addr), BASE_NODE_SIZE * nodemgmt_node_from_address(next_child_addr), BASE_NODE_SIZE, 0xFF);
                 dbflash_write_data_pattern_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(nodemgmt_get_incremented_address(next_child_addr)), BASE_NODE_SIZE * nodemgmt_node_from_address(nodemgmt_get_incremented_address(next_child_addr)), BASE_NODE_SIZE, 0xFF);
+                nodemgmt_free_slot_update(next_child_addr, 0xFFFF);
+                nodemgmt_free_slot_update(nodemgmt_get_incremented_address(next_child_addr), 0xFFFF);
                 
                 // Set correct next address
                 next_child_addr = temp_address;
@@ -2162,6 +2985,7 @@ void nodemgmt_delete_current_user_from_flash(void)
             
             // Delete parent data block
             dbflash_write_data_pattern_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_parent_addr), BASE_NODE_SIZE * nodemgmt_node_from_address(next_parent_addr), BASE_NODE_SIZE, 0xFF);
+            nodemgmt_free_slot_update(next_parent_addr, 0xFFFF);
             
             // Set correct next address
             next_parent_addr = temp_address;
@@ -2290,6 +3114,12 @@ void nodemgmt_update_child_data_node_with_next_address(uint16_t child_address, u
  */
 RET_TYPE nodemgmt_store_data_node(child_data_node_t* node, uint16_t* storedAddress)
 {
+    // First node created since login: look for free nodes
+    if (nodemgmt_free_slots_bitmap_valid == FALSE)
+    {
+        nodemgmt_scan_node_usage();
+    }
+    
     // Store address where we're going to store the node
     uint16_t freeNodeAddress = nodemgmt_current_handle.nextChildFreeNode;    
     
@@ -2365,6 +3195,12 @@ RET_TYPE nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type,
     // Set newLastNodeAddress invalid by default
     *newLastNodeAddress = NODE_ADDR_NULL;
     
+    // First node created since login: look for free nodes
+    if (nodemgmt_free_slots_bitmap_valid == FALSE)
+    {
+        nodemgmt_scan_node_usage();
+    }
+    
     // Select correct free address based on node type
     if (node_type == NODE_TYPE_CHILD)
     {
@@ -2614,6 +3450,21 @@ RET_TYPE nodemgmt_create_parent_node(parent_node_t* p, service_type_te type, uin
         }
     }
     
+    // If the return is ok, add the new service to the index. A full index only holds the first services of the lists: rebuild it
+    if ((temprettype == RETURN_OK) && (nodemgmt_service_index_state == SERVICE_INDEX_UP_TO_DATE))
+    {
+        if (nodemgmt_service_index_insert(nodemgmt_service_index_get_key(p->cred_parent.service, (type == SERVICE_CRED_TYPE) ? TRUE : FALSE, typeId), *storedAddress) != RETURN_OK)
+        {
+            nodemgmt_service_index_state = SERVICE_INDEX_NEEDS_REBUILD;
+        }
+    }
+    
+    // New parent doesn't have any child yet
+    if ((temprettype == RETURN_OK) && (nodemgmt_parent_categories_state == SERVICE_INDEX_UP_TO_DATE))
+    {
+        nodemgmt_parent_categories_clear(*storedAddress);
+    }
+    
     return temprettype;
 }
 
@@ -2649,5 +3500,15 @@ RET_TYPE nodemgmt_create_child_node(uint16_t pAddr, child_cred_node_t* c, uint16
         nodemgmt_write_parent_node_data_block_to_flash(pAddr, &nodemgmt_current_handle.temp_parent_node);
     }
     
+    // Parent may have just joined the current category
+    if (temprettype == RETURN_OK)
+    {
+        if (nodemgmt_parent_categories_state == SERVICE_INDEX_UP_TO_DATE)
+        {
+            nodemgmt_parent_categories_add(pAddr, nodemgmt_current_handle.currentCategoryFlags);
+        }
+        nodemgmt_fletter_index_invalidate();
+    }
+    
     return temprettype;
 }  
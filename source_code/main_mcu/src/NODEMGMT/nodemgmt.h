@@ -30,6 +30,7 @@
 #include "dbflash.h"
 
 /* Typedefs */
+typedef enum    {SERVICE_INDEX_NEEDS_REBUILD = 0, SERVICE_INDEX_UP_TO_DATE = 1, SERVICE_INDEX_FALLBACK = 2} service_index_state_te;
 typedef enum    {NODE_TYPE_PARENT = 0, NODE_TYPE_CHILD = 1, NODE_TYPE_PARENT_DATA = 2, NODE_TYPE_DATA = 3, NODE_TYPE_NULL = 4 /* Not a valid flag combination */} node_type_te;
     
 /* Old gen defines */
@@ -72,6 +73,23 @@ typedef enum    {NODE_TYPE_PARENT = 0, NODE_TYPE_CHILD = 1, NODE_TYPE_PARENT_DAT
 #define NODEMGMT_CAT_MASK                           0x000F
 #define NODEMGMT_CAT_BITSHIFT                       0
 
+/* Free node slots bitmap: one bit per base node slot after the reserved first sector */
+#define NODEMGMT_FREE_SLOTS_NB_SLOTS                ((PAGE_COUNT - PAGE_PER_SECTOR) * (BYTES_PER_PAGE / BASE_NODE_SIZE))
+#define NODEMGMT_FREE_SLOTS_BITMAP_SIZE             ((NODEMGMT_FREE_SLOTS_NB_SLOTS + 7) / 8)
+
+/* Service name index */
+#define NODEMGMT_SERVICE_INDEX_NB_ENTRIES           512
+#define NODEMGMT_SERVICE_INDEX_MAX_FILL             ((NODEMGMT_SERVICE_INDEX_NB_ENTRIES*3)/4)
+#define NODEMGMT_SERVICE_INDEX_HASH_MASK            0x07FF
+#define NODEMGMT_SERVICE_INDEX_TYPE_BITSHIFT        11
+#define NODEMGMT_SERVICE_INDEX_NB_RUNS              48
+
+/* Parent categories map: one nibble per node slot, ORed category flags of the children below a credential parent */
+#define NODEMGMT_PARENT_CATS_MAP_SIZE               ((NODEMGMT_FREE_SLOTS_NB_SLOTS + 1) / 2)
+
+/* First letter index */
+#define NODEMGMT_FLETTER_INDEX_NB_ENTRIES           64
+
 /* User security settings flags */
 #define USER_SEC_FLG_LOGIN_CONF             0x01
 #define USER_SEC_FLG_PIN_FOR_MMM            0x02
@@ -318,6 +336,28 @@ typedef struct
     cust_char_t category_strings[4][33];
 } nodemgmt_user_category_strings_t;
 
+// Service name index entry
+typedef struct
+{
+    uint16_t type_and_hash;                 // Credential / data type key (5 bits) followed by the service name hash (11 bits)
+    uint16_t parent_addr;                   // Parent node address, NODE_ADDR_NULL for an empty slot
+} nodemgmt_service_index_entry_t;
+
+// Service name index run: first parent of a run of services sharing the same first character, for the services the index can't hold
+typedef struct
+{
+    uint16_t type_key;                      // Credential / data type key, as in the service index key
+    cust_char_t fchar;                      // First character of the services in this run
+    uint16_t parent_addr;                   // Address of the first parent node of the run
+} nodemgmt_service_index_run_t;
+
+// First letter index entry
+typedef struct
+{
+    cust_char_t fchar;                      // First character of the services in this run
+    uint16_t parent_addr;                   // Address of the first parent node starting with fchar
+} nodemgmt_fletter_index_entry_t;
+
 // Node management handle
 typedef struct
 {
@@ -407,21 +447,26 @@ void nodemgmt_get_prev_favorite_and_category_index(int16_t category_index, int16
 void nodemgmt_get_next_favorite_and_category_index(int16_t category_index, int16_t favorite_index, int16_t* new_cat_index, int16_t* new_fav_index, BOOL navigate_across_categories);
 RET_TYPE nodemgmt_get_bluetooth_bonding_information_for_mac_addr(uint8_t address_resolv_type, uint8_t* mac_address, nodemgmt_bluetooth_bonding_information_t* bonding_information);
 uint16_t nodemgmt_find_free_nodes(uint16_t nbParentNodes, uint16_t* parentNodeArray, uint16_t nbChildtNodes, uint16_t* childNodeArray, uint16_t startPage, uint16_t startNode);
+RET_TYPE nodemgmt_fletter_index_get_jump(uint16_t credential_type_id, cust_char_t cur_char, BOOL next_letter, cust_char_t* char_array, uint16_t* parent_addr);
 void nodemgmt_read_webauthn_child_node_except_display_name(uint16_t address, child_webauthn_node_t* child_node, BOOL update_date_and_increment_preinc_count);
 void nodemgmt_init_context(uint16_t userIdNum, uint16_t* userSecFlags, uint16_t* userLanguage, uint16_t* userLayout, uint16_t* userBLELayout);
 RET_TYPE nodemgmt_get_bluetooth_bonding_information_for_irk(uint8_t* irk_key, nodemgmt_bluetooth_bonding_information_t* bonding_information);
 void nodemgmt_format_user_profile(uint16_t uid, uint16_t secPreferences, uint16_t languageId, uint16_t keyboardId, uint16_t bleKeyboardId);
 void nodemgmt_read_webauthn_child_node(uint16_t address, child_webauthn_node_t* child_node, BOOL update_date_and_increment_preinc_count);
+uint16_t nodemgmt_read_node_data_block_without_trailing_zeros(uint16_t address, BOOL child_node, uint8_t* buffer, uint16_t buffer_size);
 uint16_t nodemgmt_get_data_parent_next_child_address_ctr_and_prev_gen_flag(uint16_t parent_address, uint8_t* ctr, BOOL* prev_gen_flag);
 void nodemgmt_update_data_parent_ctr_and_first_child_address(uint16_t parent_address, uint8_t* ctr_val, uint16_t first_child_address);
 int32_t nodemgmt_get_next_non_null_favorite_before_index(uint16_t favId, uint16_t category_id, BOOL navigate_across_categories);
+void nodemgmt_write_node_data_block_with_trailing_zeros(uint16_t address, BOOL child_node, uint8_t* data, uint16_t data_length);
 int32_t nodemgmt_get_next_non_null_favorite_after_index(uint16_t favId, uint16_t category_id, BOOL navigate_across_categories);
 uint16_t nodemgmt_get_encrypted_data_from_data_node(uint16_t data_child_address, uint8_t* buffer, uint16_t* nb_bytes_written);
+BOOL nodemgmt_parent_node_has_logins_with_category(uint16_t parent_addr, uint16_t first_child_addr, uint16_t category_flags);
 uint16_t nodemgmt_get_prev_parent_node_for_cur_category(uint16_t search_start_parent_addr, uint16_t credential_type_id);
 uint16_t nodemgmt_get_next_parent_node_for_cur_category(uint16_t search_start_parent_addr, uint16_t credential_type_id);
 RET_TYPE nodemgmt_create_parent_node(parent_node_t* p, service_type_te type, uint16_t* storedAddress, uint16_t typeId);
 RET_TYPE nodemgmt_store_bluetooth_bonding_information(nodemgmt_bluetooth_bonding_information_t* bonding_information);
 uint16_t nodemgmt_check_for_logins_with_category_in_parent_node(uint16_t start_child_addr, uint16_t category_flags);
+RET_TYPE nodemgmt_service_index_search(cust_char_t* name, BOOL cred_type, uint16_t type_id, uint16_t* parent_addr);
 void nodemgmt_read_favorite(uint16_t categoryId, uint16_t favId, uint16_t* parentAddress, uint16_t* childAddress);
 void nodemgmt_read_favorite_for_current_category(uint16_t favId, uint16_t* parentAddress, uint16_t* childAddress);
 void nodemgmt_write_child_node_block_to_flash(uint16_t address, child_node_t* child_node, BOOL write_category);
@@ -430,12 +475,14 @@ void nodemgmt_get_bluetooth_bonding_info_starting_offset(uint16_t uid, uint16_t
 void nodemgmt_get_user_category_names_starting_offset(uint16_t uid, uint16_t *page, uint16_t *pageOffset);
 void nodemgmt_get_bluetooth_bonding_information_irks(uint16_t* nb_keys, uint8_t* aggregated_keys_buffer);
 void nodemgmt_update_child_data_node_with_next_address(uint16_t child_address, uint16_t next_address);
+void nodemgmt_read_cred_child_node_header_and_login(uint16_t address, child_cred_node_t* child_node);
 void nodemgmt_get_user_profile_starting_offset(uint16_t uid, uint16_t *page, uint16_t *pageOffset);
 RET_TYPE nodemgmt_create_child_node(uint16_t pAddr, child_cred_node_t* c, uint16_t* storedAddress);
 void nodemgmt_read_parent_node_data_block_from_flash(uint16_t address, parent_node_t* parent_node);
 void nodemgmt_write_parent_node_data_block_to_flash(uint16_t address, parent_node_t* parent_node);
 void nodemgmt_read_child_node_data_block_from_flash(uint16_t address, child_node_t* child_node);
 void nodemgmt_read_cred_child_node_except_pwd(uint16_t address, child_cred_node_t* child_node);
+void nodemgmt_read_cred_child_node_header(uint16_t address, child_cred_node_t* child_node);
 void nodemgmt_read_parent_node(uint16_t address, parent_node_t* parent_node, BOOL data_clean);
 void nodemgmt_set_cred_start_address(uint16_t parentAddress, uint16_t credential_type_id);
 uint16_t nodemgmt_get_prev_child_node_for_cur_category(uint16_t search_start_child_addr);
@@ -459,6 +506,7 @@ void nodemgmt_check_address_validity_and_lock(uint16_t node_addr);
 void nodemgmt_check_user_perm_from_flags_and_lock(uint16_t flags);
 uint16_t nodemgmt_get_start_addresses(uint16_t* addresses_array);
 uint16_t nodemgmt_get_starting_data_parent_addr(uint16_t typeId);
+void nodemgmt_fletter_index_build(uint16_t credential_type_id);
 void nodemgmt_delete_all_bluetooth_bonding_information(void);
 RET_TYPE nodemgmt_check_address_validity(uint16_t node_addr);
 RET_TYPE nodemgmt_check_user_perm_from_flags(uint16_t flags);
@@ -478,17 +526,22 @@ uint16_t nodemgmt_get_current_category_flags(void);
 void nodemgmt_store_user_layout(uint16_t layoutId);
 void nodemgmt_trigger_db_ext_changed_actions(void);
 uint16_t nodemgmt_get_user_sec_preferences(void);
+void nodemgmt_build_parent_categories_map(void);
 uint32_t nodemgmt_get_cred_change_number(void);
 uint32_t nodemgmt_get_data_change_number(void);
 void nodemgmt_scan_for_last_parent_nodes(void);
 void nodemgmt_set_current_date(uint16_t date);
 uint16_t nodemgmt_get_current_category(void);
+void nodemgmt_service_index_invalidate(void);
+void nodemgmt_fletter_index_invalidate(void);
 uint16_t nodemgmt_get_user_ble_layout(void);
+void nodemgmt_build_free_slots_bitmap(void);
 uint16_t nodemgmt_get_user_language(void);
 void nodemgmt_read_profile_ctr(void* buf);
 void nodemgmt_set_profile_ctr(void* buf);
 uint16_t nodemgmt_get_current_date(void);
 uint16_t nodemgmt_get_user_layout(void);
+void nodemgmt_service_index_build(void);
 void nodemgmt_scan_node_usage(void);
 
 #endif /* NODEMGMT_H_ */
@@ -25,6 +25,7 @@
 #include "custom_bitstream.h"
 #include "driver_sercom.h"
 #include "driver_timer.h"
+#include "flash_stats.h"
 #include "custom_fs.h"
 #include "sh1122.h"
 #include "dma.h"
@@ -35,6 +36,116 @@
 static void emu_oled_flush(void) {}
 #endif
 
+#ifdef OLED_INTERNAL_FRAME_BUFFER
+/*! \fn     sh1122_window_add(sh1122_window_t* window, int16_t x, int16_t y, int16_t width, int16_t height)
+*   \brief  Grow a window so that it includes a given area, clipped to the screen
+*   \param  window      Pointer to the window
+*   \param  x           Area X
+*   \param  y           Area Y
+*   \param  width       Area width
+*   \param  height      Area height
+*/
+static void sh1122_window_add(sh1122_window_t* window, int16_t x, int16_t y, int16_t width, int16_t height)
+{
+    int16_t x_end = x + width;
+    int16_t y_end = y + height;
+    
+    /* Clip to screen */
+    if (x < 0)
+    {
+        x = 0;
+    }
+    if (y < 0)
+    {
+        y = 0;
+    }
+    if (x_end > SH1122_OLED_WIDTH)
+    {
+        x_end = SH1122_OLED_WIDTH;
+    }
+    if (y_end > SH1122_OLED_HEIGHT)
+    {
+        y_end = SH1122_OLED_HEIGHT;
+    }
+    if ((x >= x_end) || (y >= y_end))
+    {
+        return;
+    }
+    
+    /* Empty window: take the area as is */
+    if (window->x_start >= window->x_end)
+    {
+        window->x_start = x;
+        window->x_end = x_end;
+        window->y_start = y;
+        window->y_end = y_end;
+        return;
+    }
+    
+    if (x < window->x_start)
+    {
+        window->x_start = x;
+    }
+    if (x_end > window->x_end)
+    {
+        window->x_end = x_end;
+    }
+    if (y < window->y_start)
+    {
+        window->y_start = y;
+    }
+    if (y_end > window->y_end)
+    {
+        window->y_end = y_end;
+    }
+}
+
+/*! \fn     sh1122_window_union(sh1122_window_t* window, sh1122_window_t* other_window)
+*   \brief  Grow a window so that it includes another one
+*   \param  window          Pointer to the window
+*   \param  other_window    Pointer to the window to include
+*/
+static void sh1122_window_union(sh1122_window_t* window, sh1122_window_t* other_window)
+{
+    if (other_window->x_start < other_window->x_end)
+    {
+        sh1122_window_add(window, other_window->x_start, other_window->y_start, other_window->x_end - other_window->x_start, other_window->y_end - other_window->y_start);
+    }
+}
+#endif
+
+/*! \fn     sh1122_mark_frame_buffer_write(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height)
+*   \brief  Register a frame buffer write, to be sent at the next flush
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Area X
+*   \param  y                   Area Y
+*   \param  width               Area width
+*   \param  height              Area height
+*/
+static void sh1122_mark_frame_buffer_write(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height)
+{
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    sh1122_window_add(&oled_descriptor->fb_dirty_window, x, y, width, height);
+    sh1122_window_add(&oled_descriptor->fb_content_window, x, y, width, height);
+    #endif
+}
+
+/*! \fn     sh1122_mark_display_write(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height)
+*   \brief  Register a direct display RAM write, which the next flush will have to overwrite
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Area X
+*   \param  y                   Area Y
+*   \param  width               Area width
+*   \param  height              Area height
+*/
+static void sh1122_mark_display_write(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, int16_t width, int16_t height)
+{
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    sh1122_window_add(&oled_descriptor->fb_dirty_window, x, y, width, height);
+    sh1122_window_add(&oled_descriptor->displayed_window, x, y, width, height);
+    #endif
+}
+
 /* SH1122 initialization sequence */
 static const uint8_t sh1122_init_sequence[] = 
 {
@@ -480,6 +591,19 @@ void sh1122_fill_screen(sh1122_descriptor_t* oled_descriptor, uint16_t color)
     }   
     sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
     sh1122_stop_data_sending(oled_descriptor);
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    if (fill_color == 0)
+    {
+        /* Nothing lit on the display: only the frame buffer contents need to be sent */
+        oled_descriptor->displayed_window.x_end = 0;
+        oled_descriptor->fb_dirty_window = oled_descriptor->fb_content_window;
+    }
+    else
+    #endif
+    {
+        sh1122_mark_display_write(oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT);
+    }
 }
 
 /*! \fn     sh1122_clear_current_screen(sh1122_descriptor_t* oled_descriptor)
@@ -512,6 +636,19 @@ void sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor)
 {
     sh1122_check_for_flush_and_terminate(oled_descriptor);
     memset((void*)oled_descriptor->frame_buffer, 0x00, sizeof(oled_descriptor->frame_buffer));
+    
+    /* Only what is lit on the display needs to be cleared at the next flush */
+    sh1122_window_union(&oled_descriptor->fb_dirty_window, &oled_descriptor->displayed_window);
+    oled_descriptor->fb_content_window.x_end = 0;
+}
+
+/*! \fn     sh1122_set_frame_buffer_dirty(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Mark the complete frame buffer as modified, to be called after writing it directly
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_set_frame_buffer_dirty(sh1122_descriptor_t* oled_descriptor)
+{
+    sh1122_mark_frame_buffer_write(oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT);
 }
 
 /*! \fn     sh1122_clear_y_frame_buffer(sh1122_descriptor_t* oled_descriptor)
@@ -529,6 +666,7 @@ void sh1122_clear_y_frame_buffer(sh1122_descriptor_t* oled_descriptor, uint16_t
     
     sh1122_check_for_flush_and_terminate(oled_descriptor);
     memset((void*)&oled_descriptor->frame_buffer[ystart][0], 0x00, (yend-ystart)*SH1122_OLED_WIDTH/2);
+    sh1122_window_add(&oled_descriptor->fb_dirty_window, 0, ystart, SH1122_OLED_WIDTH, yend-ystart);
 }
 
 /*! \fn     sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor)
@@ -611,6 +749,9 @@ void sh1122_flush_frame_buffer_y_window(sh1122_descriptor_t* oled_descriptor, ui
         yend = SH1122_OLED_HEIGHT;
     }
     
+    /* The frame buffer content of these lines is now displayed */
+    sh1122_window_add(&oled_descriptor->displayed_window, 0, ystart, SH1122_OLED_WIDTH, yend-ystart);
+    
     /* Set pixel write window */
     sh1122_set_row_address(oled_descriptor, ystart);
     sh1122_set_column_address(oled_descriptor, 0);
@@ -642,26 +783,46 @@ void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
     sh1122_check_for_flush_and_terminate(oled_descriptor);
     
     if (oled_descriptor->loaded_transition == OLED_TRANS_NONE)
-    {        
-        /* Set pixel write window */
-        sh1122_set_row_address(oled_descriptor, 0);
-        sh1122_set_column_address(oled_descriptor, 0);
+    {
+        sh1122_window_t* dirty_window = &oled_descriptor->fb_dirty_window;
         
-        /* Start filling the SSD1322 RAM */
-        sh1122_start_data_sending(oled_descriptor);
+        /* Columns are addressed by pairs of pixels */
+        uint16_t x_start = dirty_window->x_start & ~0x01;
+        uint16_t x_end = (dirty_window->x_end + 1) & ~0x01;
         
-        /* Send buffer! */
-        #ifdef OLED_DMA_TRANSFER        
-            dma_oled_init_transfer(oled_descriptor->sercom_pt, (void*)&oled_descriptor->frame_buffer[0][0], sizeof(oled_descriptor->frame_buffer), oled_descriptor->dma_trigger_id);
-            oled_descriptor->frame_buffer_flush_in_progress = TRUE;
-        #else
-            for (uint32_t y = 0; y < SH1122_OLED_HEIGHT; y++) 
+        if (dirty_window->x_start >= dirty_window->x_end)
+        {
+            /* Nothing changed since the last flush */
+        }
+        else if ((x_end - x_start) > SH1122_DIRTY_WINDOW_MAX_PARTIAL_WIDTH)
+        {
+            /* Wide window: send complete lines in a single transfer */
+            sh1122_flush_frame_buffer_y_window(oled_descriptor, dirty_window->y_start, dirty_window->y_end);
+        }
+        else
+        {
+            /* Narrow window: only send the dirty columns of each line */
+            for (uint16_t y = dirty_window->y_start; y < dirty_window->y_end; y++)
             {
-                for (uint32_t x = 0; x < SH1122_OLED_WIDTH/2; x++) {
+                /* Set pixel write window */
+                sh1122_set_row_address(oled_descriptor, y);
+                sh1122_set_column_address(oled_descriptor, x_start/2);
+                
+                /* Start filling the SSD1322 RAM */
+                sh1122_start_data_sending(oled_descriptor);
+                
+                for (uint16_t x = x_start/2; x < x_end/2; x++)
+                {
                     sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, oled_descriptor->frame_buffer[y][x]);
                 }
+                
+                /* Wait for spi buffer to be sent */
+                sercom_spi_wait_for_transmit_complete(oled_descriptor->sercom_pt);
+                
+                /* Stop sending data */
+                sh1122_stop_data_sending(oled_descriptor);
             }
-        #endif
+        }
     }
     else if (oled_descriptor->loaded_transition == OLED_LEFT_RIGHT_TRANS)
     {
@@ -796,6 +957,10 @@ void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
     
     /* Reset transition */
     oled_descriptor->loaded_transition = OLED_TRANS_NONE;
+    
+    /* Display RAM now matches the frame buffer */
+    oled_descriptor->displayed_window = oled_descriptor->fb_content_window;
+    oled_descriptor->fb_dirty_window.x_end = 0;
     emu_oled_flush();
 }
 #endif
@@ -807,8 +972,10 @@ void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
 void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor)
 {
     oled_descriptor->currentFontAddress = CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR;
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_FONTS);
     custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_font_header, oled_descriptor->currentFontAddress, sizeof(oled_descriptor->current_font_header));
     custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_unicode_inters, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header), sizeof(oled_descriptor->current_unicode_inters));
+    FLASH_STATS_CATEGORY_EXIT();
 }
 
 /*! \fn     sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor, uint16_t font_id)
@@ -819,9 +986,12 @@ void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor)
 */
 RET_TYPE sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor, uint16_t font_id)
 {
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_FONTS);
+    
     if (custom_fs_get_file_address(font_id, &oled_descriptor->currentFontAddress, CUSTOM_FS_FONTS_TYPE) != RETURN_OK)
     {
         oled_descriptor->currentFontAddress = 0;
+        FLASH_STATS_CATEGORY_EXIT();
         return RETURN_NOK;
     }
     else
@@ -842,6 +1012,7 @@ RET_TYPE sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor, uint16_t
             oled_descriptor->question_mark_support_described = TRUE;
         }
 
+        FLASH_STATS_CATEGORY_EXIT();
         return RETURN_OK;
     }    
 }
@@ -917,6 +1088,8 @@ void sh1122_init_display(sh1122_descriptor_t* oled_descriptor, BOOL leave_intern
         #ifdef OLED_INTERNAL_FRAME_BUFFER
         memset((void*)oled_descriptor->frame_buffer, 0x00, sizeof(oled_descriptor->frame_buffer));
         oled_descriptor->frame_buffer_flush_in_progress = FALSE;
+        oled_descriptor->fb_content_window.x_end = 0;
+        oled_descriptor->fb_dirty_window.x_end = 0;
         #endif
     }
     else
@@ -964,6 +1137,7 @@ void sh1122_draw_vertical_line(sh1122_descriptor_t* oled_descriptor, int16_t x,
     #ifdef OLED_INTERNAL_FRAME_BUFFER
     if (write_to_buffer != FALSE)
     {
+        sh1122_mark_frame_buffer_write(oled_descriptor, x, ystart, 1, yend-ystart+1);
         for (int16_t y=ystart; y<=yend; y++)
         {
             uint8_t pixels = color << 4;
@@ -981,6 +1155,7 @@ void sh1122_draw_vertical_line(sh1122_descriptor_t* oled_descriptor, int16_t x,
     else
     {
     #endif
+    sh1122_mark_display_write(oled_descriptor, x, ystart, 1, yend-ystart+1);
     for (int16_t y=ystart; y<=yend; y++)
     {
         uint8_t pixels = color << 4;
@@ -1047,6 +1222,16 @@ void sh1122_display_horizontal_pixel_line(sh1122_descriptor_t* oled_descriptor,
         /* Previous pixels in case we are shifted */
         uint8_t prev_pixels = 0x00;
         
+        /* Negative x may wrap around the screen: mark the complete line */
+        if (x < 0)
+        {
+            sh1122_mark_frame_buffer_write(oled_descriptor, 0, y, SH1122_OLED_WIDTH, 1);
+        }
+        else
+        {
+            sh1122_mark_frame_buffer_write(oled_descriptor, x, y, width, 1);
+        }
+        
         /* Boolean to mention if pixel to be written is the first one in the buffer */
         BOOL pixel_shift = FALSE;
         
@@ -1198,6 +1383,8 @@ void sh1122_display_horizontal_pixel_line(sh1122_descriptor_t* oled_descriptor,
     else
 #endif
     {
+        sh1122_mark_display_write(oled_descriptor, x, y, width, 1);
+        
         /* Set pixel write window */
         sh1122_set_row_address(oled_descriptor, y);
         sh1122_set_column_address(oled_descriptor, x/2);
@@ -1238,6 +1425,8 @@ void sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
     #ifdef OLED_INTERNAL_FRAME_BUFFER
     if (write_to_buffer != FALSE)
     {
+        /* Odd x writes start at the next pixels pair */
+        sh1122_mark_frame_buffer_write(oled_descriptor, x, y, width+2, height);
         for (uint16_t yind = 0; yind < height; yind++)
         {
             uint16_t xind = 0;
@@ -1271,6 +1460,8 @@ void sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
     else
     {
         #endif
+        /* Full bytes are sent to the display: one extra pixel may get cleared */
+        sh1122_mark_display_write(oled_descriptor, x, y, width+1, height);
         for (uint16_t yind=0; yind < height; yind++)
         {
             uint16_t xind = 0;
@@ -1359,6 +1550,7 @@ void sh1122_draw_full_screen_image_from_bitstream(sh1122_descriptor_t* oled_desc
     /* Wait for a possible ongoing previous flush */
     sh1122_check_for_flush_and_terminate(oled_descriptor);
     #endif
+    sh1122_mark_display_write(oled_descriptor, 0, 0, SH1122_OLED_WIDTH, SH1122_OLED_HEIGHT);
 
     /* Set pixel write window */
     sh1122_set_row_address(oled_descriptor, 0);
@@ -1502,6 +1694,16 @@ void sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int1
         /* Number of pixels to send per line */
         uint16_t nb_pixels_to_send = bitstream->width;
 
+        /* Negative X may wrap around the screen: mark the complete lines */
+        if (x < 0)
+        {
+            sh1122_mark_display_write(oled_descriptor, 0, y, SH1122_OLED_WIDTH, bitstream->height);
+        }
+        else
+        {
+            sh1122_mark_display_write(oled_descriptor, x, y, bitstream->width, bitstream->height);
+        }
+
         /* Negative X */
         if (x < 0)
         {
@@ -1683,10 +1885,12 @@ RET_TYPE sh1122_display_bitmap_from_flash_at_recommended_position(sh1122_descrip
     custom_fs_address_t file_adress;
     bitstream_bitmap_t bitstream;
     bitmap_t bitmap;
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_BITMAPS);
 
     /* Fetch file address */
     if (custom_fs_get_file_address(file_id, &file_adress, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
     {
+        FLASH_STATS_CATEGORY_EXIT();
         return RETURN_NOK;
     }
 
@@ -1698,6 +1902,7 @@ RET_TYPE sh1122_display_bitmap_from_flash_at_recommended_position(sh1122_descrip
     
     /* Draw bitmap */
     sh1122_draw_image_from_bitstream(oled_descriptor, bitmap.xpos, bitmap.ypos, &bitstream, write_to_buffer);
+    FLASH_STATS_CATEGORY_EXIT();
     
     return RETURN_OK;    
 }
@@ -1716,10 +1921,12 @@ RET_TYPE sh1122_display_bitmap_from_flash(sh1122_descriptor_t* oled_descriptor,
     custom_fs_address_t file_adress;
     bitstream_bitmap_t bitstream;
     bitmap_t bitmap;
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_BITMAPS);
 
     /* Fetch file address */
     if (custom_fs_get_file_address(file_id, &file_adress, CUSTOM_FS_BITMAP_TYPE) != RETURN_OK)
     {
+        FLASH_STATS_CATEGORY_EXIT();
         return RETURN_NOK;
     }    
 
@@ -1731,6 +1938,7 @@ RET_TYPE sh1122_display_bitmap_from_flash(sh1122_descriptor_t* oled_descriptor,
     
     /* Draw bitmap */
     sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bitstream, write_to_buffer);
+    FLASH_STATS_CATEGORY_EXIT();
     
     return RETURN_OK;  
 } 
@@ -1754,123 +1962,44 @@ uint16_t sh1122_get_string_width(sh1122_descriptor_t* oled_descriptor, const cus
     return width;    
 }
 
-/*! \fn     sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, char ch, uint16_t* glyph_height)
-*   \brief  Return the width of the specified character in the current font
+/*! \fn     sh1122_invalidate_glyph_cache(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Empty the glyph cache, to be called when the graphics bundle changes
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  ch                  Character
-*   \param  glyph_height        Where to store the glyph height (added bonus)
-*   \return width of the glyph
 */
-uint16_t sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, uint16_t* glyph_height)
+void sh1122_invalidate_glyph_cache(sh1122_descriptor_t* oled_descriptor)
 {
-    uint16_t glyph_desc_pt_offset = 0;
-    uint16_t interval_start = 0;
-    font_glyph_t glyph;
-    uint16_t gind;
-    
-    /* Set default value */
-    *glyph_height = 0;
-    
-    /* Check that a font was actually chosen */
-    if (oled_descriptor->currentFontAddress != 0)
-    {
-        /* Check that support for this char is described */
-        BOOL char_support_described = FALSE;
-        for (uint16_t i=0; i < sizeof(oled_descriptor->current_unicode_inters)/sizeof(oled_descriptor->current_unicode_inters[0]); i++)
-        {
-            /* Check if char is within this interval */
-            if ((oled_descriptor->current_unicode_inters[i].interval_start != 0xFFFF) && (oled_descriptor->current_unicode_inters[i].interval_start <= ch) && (oled_descriptor->current_unicode_inters[i].interval_end >= ch))
-            {
-                interval_start = oled_descriptor->current_unicode_inters[i].interval_start;
-                char_support_described = TRUE;
-                break;
-            }
-            
-            /* Add offset to descriptor */
-            glyph_desc_pt_offset += oled_descriptor->current_unicode_inters[i].interval_end - oled_descriptor->current_unicode_inters[i].interval_start + 1;
-        }
-        
-        /* Support not described, check if we could switch with ? */
-        if (char_support_described == FALSE)
-        {
-            if (oled_descriptor->question_mark_support_described != FALSE)
-            {
-                interval_start = oled_descriptor->current_unicode_inters[0].interval_start;
-                glyph_desc_pt_offset = 0;
-                ch = '?';
-            } 
-            else
-            {
-                return 0;
-            }
-        }
-        
-        /* Convert character to glyph index */
-        custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-
-        /* Check that we know this glyph */
-        if(gind == 0xFFFF)
-        {
-            // If we don't know this character, try again with '?'
-            if (oled_descriptor->question_mark_support_described == FALSE)
-            {
-                return 0;
-            }
-            else
-            {
-                ch = '?';
-            }            
-            custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-            
-            // If we still don't know it, return 0
-            if (gind == 0xFFFF)
-            {
-                return 0;
-            }
-        }
-
-        // Read the beginning of the glyph
-        custom_fs_read_from_flash((uint8_t*)&glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(glyph), sizeof(glyph));
-
-        if (glyph.glyph_data_offset == 0xFFFFFFFF)
-        {
-            // If there's no glyph data, it is the space!
-            return glyph.xrect + 1;
-        }
-        else
-        {
-            *glyph_height = glyph.yrect + glyph.yoffset;
-            return glyph.xrect + glyph.xoffset + 1;
-        }
-    }
-    else
-    {
-        return 0;
-    }
+    memset(oled_descriptor->glyph_cache, 0, sizeof(oled_descriptor->glyph_cache));
 }
 
- /*! \fn     sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, char ch, BOOL write_to_buffer)
- *   \brief  Draw a character glyph on the screen at x,y.
- *   \param  oled_descriptor    Pointer to a sh1122 descriptor struct
- *   \param  x                  x position to start glyph
- *   \param  y                  y position to start glyph
- *   \param  ch                 Character to draw
- *   \param  write_to_buffer    Set to true to write to internal buffer
- *   \return width of the glyph
- */
-uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, cust_char_t ch, BOOL write_to_buffer)
+/*! \fn     sh1122_get_glyph(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, font_glyph_t* glyph)
+*   \brief  Get the glyph header of a given character in the current font
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ch                  Character
+*   \param  glyph               Where to store the glyph header ('?' glyph if the character isn't supported)
+*   \return RETURN_OK if a glyph was found
+*   \note   Glyph headers are cached as they take two flash reads to fetch. Entries are tagged with their font address
+*           so that they survive font switches: the address bits are mixed in the index to spread fonts over the cache
+*/
+static RET_TYPE sh1122_get_glyph(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, font_glyph_t* glyph)
 {
+    custom_fs_address_t font_address = oled_descriptor->currentFontAddress;
+    sh1122_glyph_cache_entry_t* cache_entry_pt = &oled_descriptor->glyph_cache[(ch ^ (font_address >> 3) ^ (font_address >> 9)) & (SH1122_GLYPH_CACHE_NB_ENTRIES-1)];
     uint16_t glyph_desc_pt_offset = 0;  // Offset to the pointer of the glyph descriptor
     uint16_t interval_start = 0;        // Unicode code of the first char of the current unicode support interval
-    bitstream_bitmap_t bs;              // Character bitstream
-    uint8_t glyph_width;                // Glyph width
-    font_glyph_t glyph;                 // Glyph header
+    cust_char_t requested_ch = ch;      // Character we were asked for
     uint16_t gind;                      // Glyph index
-
+    
     /* Check for selected font */
     if (oled_descriptor->currentFontAddress == 0)
     {
-        return 0;
+        return RETURN_NOK;
+    }
+    
+    /* Cache hit */
+    if ((ch != 0) && (cache_entry_pt->ch == ch) && (cache_entry_pt->font_address == font_address))
+    {
+        *glyph = cache_entry_pt->glyph;
+        return RETURN_OK;
     }
     
     /* Check that support for this char is described */
@@ -1900,11 +2029,12 @@ uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
         }
         else
         {
-            return 0;
+            return RETURN_NOK;
         }
     }
     
     /* Convert character to glyph index */
+    FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_FONTS);
     custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
 
     /* Check that we know this glyph */
@@ -1913,7 +2043,8 @@ uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
         // If we don't know this character, try again with '?'
         if (oled_descriptor->question_mark_support_described == FALSE)
         {
-            return 0;
+            FLASH_STATS_CATEGORY_EXIT();
+            return RETURN_NOK;
         }
         else
         {
@@ -1924,12 +2055,74 @@ uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
         // If we still don't know it, return 0
         if (gind == 0xFFFF)
         {
-            return 0;
+            FLASH_STATS_CATEGORY_EXIT();
+            return RETURN_NOK;
         }
     }
     
-    /* Read glyph data */
-    custom_fs_read_from_flash((uint8_t*)&glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(glyph), sizeof(glyph));
+    /* Read glyph header */
+    custom_fs_read_from_flash((uint8_t*)glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(*glyph), sizeof(*glyph));
+    FLASH_STATS_CATEGORY_EXIT();
+    
+    /* Store it in the cache */
+    cache_entry_pt->font_address = font_address;
+    cache_entry_pt->ch = requested_ch;
+    cache_entry_pt->glyph = *glyph;
+    return RETURN_OK;
+}
+
+/*! \fn     sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, char ch, uint16_t* glyph_height)
+*   \brief  Return the width of the specified character in the current font
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ch                  Character
+*   \param  glyph_height        Where to store the glyph height (added bonus)
+*   \return width of the glyph
+*/
+uint16_t sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, uint16_t* glyph_height)
+{
+    font_glyph_t glyph;
+    
+    /* Set default value */
+    *glyph_height = 0;
+    
+    /* Fetch glyph header */
+    if (sh1122_get_glyph(oled_descriptor, ch, &glyph) != RETURN_OK)
+    {
+        return 0;
+    }
+
+    if (glyph.glyph_data_offset == 0xFFFFFFFF)
+    {
+        // If there's no glyph data, it is the space!
+        return glyph.xrect + 1;
+    }
+    else
+    {
+        *glyph_height = glyph.yrect + glyph.yoffset;
+        return glyph.xrect + glyph.xoffset + 1;
+    }
+}
+
+ /*! \fn     sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, char ch, BOOL write_to_buffer)
+ *   \brief  Draw a character glyph on the screen at x,y.
+ *   \param  oled_descriptor    Pointer to a sh1122 descriptor struct
+ *   \param  x                  x position to start glyph
+ *   \param  y                  y position to start glyph
+ *   \param  ch                 Character to draw
+ *   \param  write_to_buffer    Set to true to write to internal buffer
+ *   \return width of the glyph
+ */
+uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, cust_char_t ch, BOOL write_to_buffer)
+{
+    bitstream_bitmap_t bs;              // Character bitstream
+    uint8_t glyph_width;                // Glyph width
+    font_glyph_t glyph;                 // Glyph header
+
+    /* Fetch glyph header */
+    if (sh1122_get_glyph(oled_descriptor, ch, &glyph) != RETURN_OK)
+    {
+        return 0;
+    }
 
     if (glyph.glyph_data_offset == 0xFFFFFFFF)
     {
@@ -1945,11 +2138,13 @@ uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
         y += glyph.yoffset;
         
         /* Compute glyph data address */
-        custom_fs_address_t gaddr = oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + (oled_descriptor->current_font_header.chr_count)*sizeof(glyph) + glyph.glyph_data_offset;
+        custom_fs_address_t gaddr = oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(uint16_t) + (oled_descriptor->current_font_header.chr_count)*sizeof(glyph) + glyph.glyph_data_offset;
         
         // Initialize bitstream & draw the character
+        FLASH_STATS_CATEGORY_ENTER(FLASH_STATS_CAT_FONTS);
         bitstream_glyph_bitmap_init(&bs, &oled_descriptor->current_font_header, &glyph, gaddr, TRUE);
         sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bs, write_to_buffer);
+        FLASH_STATS_CATEGORY_EXIT();
     }
     
     return (uint8_t)(glyph_width + glyph.xoffset) + 1;
@@ -63,6 +63,12 @@
 #define SH1122_OLED_HEIGHT          64
 #define SH1122_OLED_BPP             4
 
+/* Glyph cache defines */
+#define SH1122_GLYPH_CACHE_NB_ENTRIES   64      // Must be a power of 2
+
+/* Dirty window flush defines: wider windows are flushed as complete lines in a single transfer */
+#define SH1122_DIRTY_WINDOW_MAX_PARTIAL_WIDTH   (SH1122_OLED_WIDTH/2)
+
 /* Transition defines */
 #define SH1122_TRANSITION_PIXEL     0x03
 
@@ -86,6 +92,21 @@ typedef struct
     uint8_t pixels;
 } gddram_px_t;
 
+typedef struct
+{
+    cust_char_t ch;                                     // Requested character, 0 if entry is empty
+    font_glyph_t glyph;                                 // Glyph header for that character
+    custom_fs_address_t font_address;                   // Address of the font the glyph belongs to
+} sh1122_glyph_cache_entry_t;
+
+typedef struct
+{
+    uint16_t x_start;                                   // First X
+    uint16_t x_end;                                     // Last X (exclusive), window empty if <= x_start
+    uint16_t y_start;                                   // First Y
+    uint16_t y_end;                                     // Last Y (exclusive)
+} sh1122_window_t;
+
 typedef struct
 {
     Sercom* sercom_pt;
@@ -98,6 +119,7 @@ typedef struct
     custom_fs_address_t currentFontAddress;             // Current font address
     font_header_t current_font_header;                  // Current font header
     unicode_interval_desc_t current_unicode_inters[15]; // Current unicode interval descriptors
+    sh1122_glyph_cache_entry_t glyph_cache[SH1122_GLYPH_CACHE_NB_ENTRIES];  // Direct mapped cache of glyph headers, shared by all fonts
     BOOL question_mark_support_described;               // If this font describes '?' support
     BOOL screen_wrapping_allowed;                       // If we are allowing screen wrapping
     BOOL carriage_return_allowed;                       // If we are allowing \r
@@ -119,6 +141,9 @@ typedef struct
     #ifdef OLED_INTERNAL_FRAME_BUFFER
     uint8_t frame_buffer[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH/(8/SH1122_OLED_BPP)];
     BOOL frame_buffer_flush_in_progress;
+    sh1122_window_t fb_dirty_window;                    // Area where the display RAM may differ from the frame buffer
+    sh1122_window_t fb_content_window;                  // Area where the frame buffer may have lit pixels
+    sh1122_window_t displayed_window;                   // Area where the display RAM may have lit pixels
     #endif
 } sh1122_descriptor_t;
 
@@ -170,6 +195,7 @@ void sh1122_prevent_partial_text_x_draw(sh1122_descriptor_t* oled_descriptor);
 uint8_t sh1122_get_current_font_height(sh1122_descriptor_t* oled_descriptor);
 void sh1122_allow_partial_text_y_draw(sh1122_descriptor_t* oled_descriptor);
 void sh1122_allow_partial_text_x_draw(sh1122_descriptor_t* oled_descriptor);
+void sh1122_invalidate_glyph_cache(sh1122_descriptor_t* oled_descriptor);
 void sh1122_clear_current_screen(sh1122_descriptor_t* oled_descriptor);
 void sh1122_reset_lim_display_y(sh1122_descriptor_t* oled_descriptor);
 void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor);
@@ -190,6 +216,7 @@ void sh1122_flush_frame_buffer_window(sh1122_descriptor_t* oled_descriptor, uint
 void sh1122_flush_frame_buffer_y_window(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend);
 void sh1122_clear_y_frame_buffer(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend);
 void sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor);
+void sh1122_set_frame_buffer_dirty(sh1122_descriptor_t* oled_descriptor);
 void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor);
 void sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor);
 #endif
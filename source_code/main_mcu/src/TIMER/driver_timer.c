@@ -50,6 +50,9 @@ volatile uint16_t timer_inactivity_30mins_tick_remain = 0;
 volatile BOOL timer_systick_expired = TRUE;
 /* System tick */
 volatile uint32_t sysTick;
+/* Earliest deadline of the armed timers, only valid when timer_next_deadline_armed is set */
+volatile uint32_t timer_next_deadline = 0;
+volatile BOOL timer_next_deadline_armed = FALSE;
 /* timestamp set at the last "set date" message */
 uint32_t timer_last_set_timestamp = 0;
 /* Fine adjustment for our time base */
@@ -350,36 +353,101 @@ void driver_timer_set_rtc_timestamp(uint16_t year, uint16_t month, uint16_t day,
 #endif
 }
 
-/*!	\fn		timer_ms_tick(void)
-*	\brief	Function called by interrupt every ms
+/*!	\fn		timer_is_deadline_reached(uint32_t deadline)
+*	\brief	Know if a deadline was reached
+*   \param  deadline    The deadline, in system ticks
+*   \return TRUE if reached
+*   \note   Deadlines must be less than 2^31ms in the future
 */
-void timer_ms_tick(void)
+static inline BOOL timer_is_deadline_reached(uint32_t deadline)
 {
-    uint32_t i;
-    sysTick++;
-    
-    // Loop through the timers
-    for (i = 0; i < TOTAL_NUMBER_OF_TIMERS; i++)
+    if ((int32_t)(sysTick - deadline) >= 0)
+    {
+        return TRUE;
+    }
+    else
     {
-        if (context_timers[i].timer_val != 0)
+        return FALSE;
+    }
+}
+
+/*!	\fn		timer_update_entry_deadline(volatile timerEntry_t* entry)
+*	\brief	Expire a timer if its deadline was reached, or take its deadline into account for the next deadline
+*   \param  entry   Pointer to the timer entry
+*   \note   To be called with interrupts disabled or from the interrupt
+*/
+static void timer_update_entry_deadline(volatile timerEntry_t* entry)
+{
+    if (entry->armed != FALSE)
+    {
+        if (timer_is_deadline_reached(entry->deadline) != FALSE)
         {
-            if (context_timers[i].timer_val-- == 1)
-            {
-                context_timers[i].flag = TIMER_EXPIRED;
-            }
+            entry->flag = TIMER_EXPIRED;
+            entry->armed = FALSE;
         }
+        else if ((timer_next_deadline_armed == FALSE) || ((int32_t)(entry->deadline - timer_next_deadline) < 0))
+        {
+            timer_next_deadline = entry->deadline;
+            timer_next_deadline_armed = TRUE;
+        }
+    }
+}
+
+/*!	\fn		timer_expire_deadlines(void)
+*	\brief	Expire all the timers whose deadline was reached and compute the next deadline
+*   \note   To be called with interrupts disabled or from the interrupt
+*/
+static void timer_expire_deadlines(void)
+{
+    timer_next_deadline_armed = FALSE;
+    
+    for (uint16_t i = 0; i < TOTAL_NUMBER_OF_TIMERS; i++)
+    {
+        timer_update_entry_deadline(&context_timers[i]);
     }
     
-    // Loop through the allocated timers
-    for (i = 0; i < NUMBER_OF_ALLOCATABLE_TIMERS; i++)
+    for (uint16_t i = 0; i < NUMBER_OF_ALLOCATABLE_TIMERS; i++)
     {
-        if (context_allocatable_timers[i].timer_val != 0)
-        {
-            if (context_allocatable_timers[i].timer_val-- == 1)
-            {
-                context_allocatable_timers[i].flag = TIMER_EXPIRED;
-            }
-        }
+        timer_update_entry_deadline(&context_allocatable_timers[i].timer);
+    }
+}
+
+/*!	\fn		timer_arm_entry(volatile timerEntry_t* entry, uint32_t val)
+*	\brief	Arm a timer entry
+*   \param  entry   Pointer to the timer entry
+*   \param  val     Delay in ms
+*/
+static void timer_arm_entry(volatile timerEntry_t* entry, uint32_t val)
+{
+    cpu_irq_enter_critical();
+    
+    if (val == 0)
+    {
+        entry->flag = TIMER_EXPIRED;
+        entry->armed = FALSE;
+    }
+    else
+    {
+        entry->deadline = sysTick + val;
+        entry->flag = TIMER_RUNNING;
+        entry->armed = TRUE;
+        timer_update_entry_deadline(entry);
+    }
+    
+    cpu_irq_leave_critical();
+}
+
+/*!	\fn		timer_ms_tick(void)
+*	\brief	Function called by interrupt every ms
+*   \note   Timers are only looked at when the earliest deadline is reached
+*/
+void timer_ms_tick(void)
+{
+    sysTick++;
+    
+    if ((timer_next_deadline_armed != FALSE) && (timer_is_deadline_reached(timer_next_deadline) != FALSE))
+    {
+        timer_expire_deadlines();
     }
     
     #ifdef EMULATOR_BUILD
@@ -459,6 +527,32 @@ uint32_t timer_get_systick(void)
     return sysTick;
 }
 
+/*!	\fn		timer_get_timestamp_us(void)
+*	\brief	Get a microsecond timestamp, to measure short durations
+*   \return The system time in us since boot (wraps around every 71 minutes)
+*   \note   Must not be called with interrupts disabled
+*/
+uint32_t timer_get_timestamp_us(void)
+{
+#ifndef EMULATOR_BUILD
+    uint32_t systick_val;
+    uint32_t count_val;
+    
+    /* TCC0 counts up to 48000 every ms: read it and retry if the ms tick incremented in the meantime */
+    do 
+    {
+        systick_val = sysTick;
+        TCC0->CTRLBSET.reg = TCC_CTRLBSET_CMD_READSYNC;
+        while(TCC0->SYNCBUSY.reg & (TCC_SYNCBUSY_CTRLB | TCC_SYNCBUSY_COUNT));
+        count_val = TCC0->COUNT.reg;
+    } while (systick_val != sysTick);
+    
+    return systick_val*1000 + count_val/48;
+#else
+    return emu_get_timestamp_us();
+#endif
+}
+
 /*!	\fn		timer_has_timer_expired(timer_id_te uid, BOOL clear)
 *	\brief	Know if a timer expired and clear the flag if so
 *   \param  uid     Unique ID
@@ -478,6 +572,9 @@ timer_flag_te timer_has_timer_expired(timer_id_te uid, BOOL clear)
     }
     else
     {
+        #ifdef EMULATOR_BUILD
+        emu_timer_polled(uid);
+        #endif
         return TIMER_RUNNING;
     }
 }
@@ -497,16 +594,19 @@ timer_flag_te timer_has_allocated_timer_expired(uint16_t uid, BOOL clear)
     }
     
     // Compare & write is done in one cycle
-    if (context_allocatable_timers[uid].flag == TIMER_EXPIRED)
+    if (context_allocatable_timers[uid].timer.flag == TIMER_EXPIRED)
     {
         if (clear == TRUE)
         {
-            context_allocatable_timers[uid].flag = TIMER_RUNNING;
+            context_allocatable_timers[uid].timer.flag = TIMER_RUNNING;
         }
         return TIMER_EXPIRED;
     }
     else
     {
+        #ifdef EMULATOR_BUILD
+        emu_timer_polled(TOTAL_NUMBER_OF_TIMERS + uid);
+        #endif
         return TIMER_RUNNING;
     }
 }
@@ -524,23 +624,7 @@ void timer_rearm_allocated_timer(uint16_t uid, uint32_t val)
         main_reboot();
     }
     
-    // Compare is done in one cycle
-    if (context_allocatable_timers[uid].timer_val != val)
-    {
-        cpu_irq_enter_critical();
-        
-        context_allocatable_timers[uid].timer_val = val;
-        if (val == 0)
-        {
-            context_allocatable_timers[uid].flag = TIMER_EXPIRED;
-        }
-        else
-        {
-            context_allocatable_timers[uid].flag = TIMER_RUNNING;
-        }
-        
-        cpu_irq_leave_critical();
-    }
+    timer_arm_entry(&context_allocatable_timers[uid].timer, val);
 }
 
 /*! \fn     timer_get_and_start_timer(uint32_t val)
@@ -557,23 +641,7 @@ uint16_t timer_get_and_start_timer(uint32_t val)
         /* Check for allocation */
         if (context_allocatable_timers[i].allocated == FALSE)
         {
-            // Compare is done in one cycle
-            if (context_allocatable_timers[i].timer_val != val)
-            {
-                cpu_irq_enter_critical();
-                
-                context_allocatable_timers[i].timer_val = val;
-                if (val == 0)
-                {
-                    context_allocatable_timers[i].flag = TIMER_EXPIRED;
-                }
-                else
-                {
-                    context_allocatable_timers[i].flag = TIMER_RUNNING;
-                }
-                
-                cpu_irq_leave_critical();
-            }
+            timer_arm_entry(&context_allocatable_timers[i].timer, val);
             
             /* Set allocated flag, return uid */
             context_allocatable_timers[i].allocated = TRUE;
@@ -609,33 +677,26 @@ void timer_deallocate_timer(uint16_t timer_id)
 */
 void timer_start_timer(timer_id_te uid, uint32_t val)
 {    
-    // Compare is done in one cycle
-    if (context_timers[uid].timer_val != val)
-    {
-        cpu_irq_enter_critical();
-        
-        context_timers[uid].timer_val = val;
-        if (val == 0)
-        {
-            context_timers[uid].flag = TIMER_EXPIRED;
-        }
-        else
-        {
-            context_timers[uid].flag = TIMER_RUNNING;
-        }
-        
-        cpu_irq_leave_critical();
-    }
+    timer_arm_entry(&context_timers[uid], val);
 }
 
 /*!	\fn		timer_get_timer_val(timer_id_te uid)
 *	\brief	Get current timer val
 *   \param  uid     Unique ID
-*   \return the timer val
+*   \return the number of ms before the timer expires, 0 if not running
 */
 uint32_t timer_get_timer_val(timer_id_te uid)
 {
-    return context_timers[uid].timer_val;
+    uint32_t deadline = context_timers[uid].deadline;
+    
+    if ((context_timers[uid].armed != FALSE) && (timer_is_deadline_reached(deadline) == FALSE))
+    {
+        return deadline - sysTick;
+    }
+    else
+    {
+        return 0;
+    }
 }
 
 /*!	\fn		timer_delay_ms(uint32_t ms)
@@ -31,14 +31,14 @@
 /* Structs */
 typedef struct
 {
-    uint32_t timer_val;
+    uint32_t deadline;
     uint32_t flag;
+    BOOL armed;
 } timerEntry_t;
 
 typedef struct
 {
-    uint32_t timer_val;
-    uint32_t flag;
+    timerEntry_t timer;
     BOOL allocated;
 } allocatedTimerEntry_t;
 
@@ -61,10 +61,10 @@ typedef enum {TIMER_EXPIRED = 0, TIMER_RUNNING = 1} timer_flag_te;
     
 /* Macros */
 #ifdef EMULATOR_BUILD
-#include <unistd.h>
-#define DELAYUS(us)                 usleep(us)
-#define DELAYMS(ms)                 usleep((ms)*1000)
-#define DELAYMS_8M(ms)              usleep((ms)*1000)
+#include "emulator.h"
+#define DELAYUS(us)                 emu_delay_us(us)
+#define DELAYMS(ms)                 emu_delay_us((ms)*1000)
+#define DELAYMS_8M(ms)              emu_delay_us((ms)*1000)
 #else
 #define CYCLES_IN_DLYTICKS_FUNC     8
 #define US_TO_DLYTICKS(us)          (uint32_t)((CPU_SPEED_HF / 1000000UL) * us / CYCLES_IN_DLYTICKS_FUNC)
@@ -100,6 +100,7 @@ uint16_t timer_get_and_start_timer(uint32_t val);
 void timer_deallocate_timer(uint16_t timer_id);
 uint32_t timer_get_timer_val(timer_id_te uid);
 BOOL timer_get_mcu_systick(uint32_t* value);
+uint32_t timer_get_timestamp_us(void);
 void timer_initialize_timebase(void);
 uint32_t timer_get_systick(void);
 void timer_delay_ms(uint32_t ms);
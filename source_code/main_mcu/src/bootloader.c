@@ -46,6 +46,17 @@ bl_section_last_row_t* bl_last_row_ptr = (bl_section_last_row_t*)(FLASH_ADDR + A
 #define BUNDLE_RX_TEMP_BUFFER_SIZE  8192                                        // Size of receive buffer
 uint16_t bundle_data_b1[BUNDLE_RX_TEMP_BUFFER_SIZE/2];                          // First buffer for bundle data
 uint16_t bundle_data_b2[BUNDLE_RX_TEMP_BUFFER_SIZE/2];                          // Second buffer for bundle data
+#ifdef BOOTLOADER_STAGE_TIMINGS
+/* Update stages, for timing measurements */
+#define BL_STAGE_DATAFLASH          0                                           // Waiting for dataflash data
+#define BL_STAGE_CBCMAC             1                                           // Computing CBCMAC
+#define BL_STAGE_NVM                2                                           // Programming internal flash, including waits
+#define BL_STAGE_OTHER              3                                           // Checks, screen updates...
+#define BL_NB_STAGES                4
+uint32_t bootloader_stage_cycles[2][BL_NB_STAGES];                              // Cycles spent in each stage for both passes: read them with a debugger or on screen
+uint32_t bootloader_stage_last_systick;                                         // SysTick value at the last stage switch
+uint16_t bootloader_current_stage = BL_STAGE_OTHER;                             // Current stage
+#endif
 
 /**
  * \brief Function to start the application.
@@ -87,6 +98,25 @@ static void brick_main_mcu(void)
     }
 }
 
+#ifdef BOOTLOADER_STAGE_TIMINGS
+/*! \fn     bootloader_switch_timed_stage(uint16_t nb_pass, uint16_t stage)
+*   \brief  Add the cycles spent since the last call to the current stage, then switch stage
+*   \param  nb_pass Current pass
+*   \param  stage   New stage
+*   \note   SysTick is a 24 bits counter wrapping every 349ms at 48MHz: calls should be more frequent
+*/
+static void bootloader_switch_timed_stage(uint16_t nb_pass, uint16_t stage)
+{
+    uint32_t systick_val = SysTick->VAL & 0x00FFFFFF;
+    bootloader_stage_cycles[nb_pass][bootloader_current_stage] += (bootloader_stage_last_systick - systick_val) & 0x00FFFFFF;
+    bootloader_stage_last_systick = systick_val;
+    bootloader_current_stage = stage;
+}
+#define BOOTLOADER_TIMED_STAGE(nb_pass, stage)  bootloader_switch_timed_stage(nb_pass, stage)
+#else
+#define BOOTLOADER_TIMED_STAGE(nb_pass, stage)
+#endif
+
 #if defined(PLAT_V7_SETUP)
 /*! \fn     brick_main_mcu_disp_error_switch_off(BOOL disp_error)
 *   \brief  Brick the main mcu, display an error message and switch off
@@ -150,6 +180,26 @@ static void perform_end_of_flash_operations(custom_file_flash_header_t* buffered
         }
     }
 }
+
+#ifdef BOOTLOADER_STAGE_TIMINGS
+/*! \fn     display_flashing_stage_timings(void)
+*   \brief  Debug hook: display the time spent in each stage of the flashing pass, in ms
+*/
+static void display_flashing_stage_timings(void)
+{
+    cust_char_t timings_string[] = u"DF 00000 MAC 00000 NVM 00000";
+    uint16_t digits_positions[] = {3, 13, 23};
+    
+    /* utils_itoa adds a terminating 0 we replace by the original space */
+    for (uint16_t i = 0; i < ARRAY_SIZE(digits_positions); i++)
+    {
+        utils_itoa(bootloader_stage_cycles[1][i]/48000, 5, &timings_string[digits_positions[i]], 6);
+        timings_string[digits_positions[i]+5] = (i == ARRAY_SIZE(digits_positions)-1)? 0 : ' ';
+    }
+    sh1122_erase_screen_and_put_top_left_emergency_string(&plat_oled_descriptor, timings_string);
+    DELAYMS(5000);
+}
+#endif
 #endif
 
 /*! \fn     main(void)
@@ -277,6 +327,14 @@ int main(void)
     /* Automatic flash write, disable caching */
     NVMCTRL->CTRLB.bit.MANW = 0;
     NVMCTRL->CTRLB.bit.CACHEDIS = 1;
+    
+    #ifdef BOOTLOADER_STAGE_TIMINGS
+    /* Free running SysTick, no interrupt */
+    SysTick->LOAD = 0x00FFFFFF;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+    bootloader_stage_last_systick = SysTick->VAL & 0x00FFFFFF;
+    #endif
 
     /* Two passes: one to check the signature, one to flash and check previously stored signature for fw file */
     for (uint16_t nb_pass = 0; nb_pass < 2; nb_pass++)
@@ -334,7 +392,9 @@ int main(void)
             }
 
             /* Wait for received DMA transfer */
+            BOOTLOADER_TIMED_STAGE(nb_pass, BL_STAGE_DATAFLASH);
             while(dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+            BOOTLOADER_TIMED_STAGE(nb_pass, BL_STAGE_OTHER);
 
             /* Arm next DMA transfer */
             if (available_data_buffer == bundle_data_b1)
@@ -348,7 +408,9 @@ int main(void)
 
             #if defined(PLAT_V7_SETUP)
             /* CBCMAC the crap out of it */
+            BOOTLOADER_TIMED_STAGE(nb_pass, BL_STAGE_CBCMAC);
             br_aes_ct_ctrcbc_mac(&bootloader_signing_aes_context, cur_cbc_mac, received_data_buffer, nb_bytes_to_read);
+            BOOTLOADER_TIMED_STAGE(nb_pass, BL_STAGE_OTHER);
             
             /* End of flash cbcmac */
             if ((nb_pass == 0) && ((current_data_flash_addr + nb_bytes_to_read) == W25Q16_FLASH_SIZE))
@@ -424,11 +486,15 @@ int main(void)
                 #endif
                 
                  /* Keep in mind we are 16 bytes aligned here */
+                 BOOTLOADER_TIMED_STAGE(nb_pass, BL_STAGE_NVM);
                  for (uint32_t i = valid_fw_data_offset/2; i < nb_bytes_to_read/2; i++)
                  {
                      /* Erase row? */
                      if (address_in_mcu_memory % NVMCTRL_ROW_SIZE == 0)
                      {
+                         /* Account time once per row, a full buffer takes longer than a SysTick wrap */
+                         BOOTLOADER_TIMED_STAGE(nb_pass, BL_STAGE_NVM);
+                         
                          /* Erase complete row, composed of 4 pages */
                          while ((NVMCTRL->INTFLAG.reg & NVMCTRL_INTFLAG_READY) == 0);
                          NVMCTRL->ADDR.reg  = address_in_mcu_memory/2;
@@ -468,6 +534,7 @@ int main(void)
                          break;
                      }
                  }
+                 BOOTLOADER_TIMED_STAGE(nb_pass, BL_STAGE_OTHER);
             }
 
             /* Increment scan address */
@@ -495,6 +562,9 @@ int main(void)
     /* Switch off OLED */
     if (is_usb_power_present_at_boot != FALSE)
     {
+        #ifdef BOOTLOADER_STAGE_TIMINGS
+        display_flashing_stage_timings();
+        #endif
         sh1122_oled_off(&plat_oled_descriptor);
         platform_io_power_down_oled();
     }
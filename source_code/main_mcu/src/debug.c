@@ -397,8 +397,9 @@ void debug_always_bluetooth_enable_and_click_to_send_cred(void)
             /* Check for reindex bundle message */
             if (comms_aux_mcu_routine(MSG_RESTRICT_ALLBUT_BUNDLE) == HID_REINDEX_BUNDLE_RCVD)
             {
-                /* Try to init our file system */
+                /* Try to init our file system, cached glyphs may belong to the previous bundle */
                 custom_fs_init();
+                sh1122_invalidate_glyph_cache(&plat_oled_descriptor);
                 bundle_uploaded = TRUE;
             }
         }
@@ -586,6 +587,7 @@ void debug_battery_recondition(void)
                     }
                 }
             }
+            sh1122_set_frame_buffer_dirty(&plat_oled_descriptor);
             sh1122_flush_frame_buffer(&plat_oled_descriptor);
         #else
             for (uint16_t i = GUI_ANIMATION_FFRAME_ID; i < GUI_ANIMATION_NBFRAMES; i++)
@@ -361,8 +361,9 @@ void main_platform_init(void)
             /* Check for reindex bundle message */
             if (msg_received == HID_REINDEX_BUNDLE_RCVD)
             {
-                /* Try to init our file system */
+                /* Try to init our file system, cached glyphs may belong to the previous bundle */
                 custom_fs_init_return = custom_fs_init();
+                sh1122_invalidate_glyph_cache(&plat_oled_descriptor);
                 if (custom_fs_init_return == RETURN_OK)
                 {
                     break;
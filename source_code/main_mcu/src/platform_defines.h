@@ -228,6 +228,15 @@
     #undef DEVELOPER_FEATURES_ENABLED
 #endif
 
+/* Database host benchmark built for a bigger flash chip, to go past what the 8M one can store (see Makefile.bench) */
+#if defined(EMULATOR_BUILD) && defined(EMULATOR_DBFLASH_CHIP_16M)
+    #undef DBFLASH_CHIP_8M
+    #define DBFLASH_CHIP_16M
+#elif defined(EMULATOR_BUILD) && defined(EMULATOR_DBFLASH_CHIP_32M)
+    #undef DBFLASH_CHIP_8M
+    #define DBFLASH_CHIP_32M
+#endif
+
 /* Developer features */
 #ifdef DEVELOPER_FEATURES_ENABLED
     #define DEV_SKIP_INTRO_ANIM
@@ -358,6 +367,10 @@ typedef struct
 //#define NO_SECURITY_BIT_CHECK
 /* Debug printf through USB */
 //#define DEBUG_USB_PRINTF_ENABLED
+/* Bootloader: measure time spent in each firmware update stage, displayed when USB powered */
+//#define BOOTLOADER_STAGE_TIMINGS
+/* Count external flash accesses per caller category, reported by a debug command (adds a timestamp read to each access) */
+//#define FLASH_STATS_ENABLED
 /* Allow import / export of the provisioned aes key & flag */
 #define AES_PROVISIONED_KEY_IMPORT_EXPORT_ALLOWED
 
@@ -1054,4 +1067,8 @@ typedef struct
     #undef OLED_DMA_TRANSFER
 #endif
 
+#if defined(BOOTLOADER) || !defined(DEBUG_USB_COMMANDS_ENABLED)
+    #undef FLASH_STATS_ENABLED
+#endif
+
 #endif /* PLATFORM_DEFINES_H_ */
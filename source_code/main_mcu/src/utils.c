@@ -603,3 +603,25 @@ uint8_t utils_side_channel_safe_memcmp(uint8_t* dataA, uint8_t* dataB, uint32_t
 
     return return_value;
 }
+
+/*! \fn     utils_crc32_update(uint32_t crc, uint8_t* data, uint32_t length)
+*   \brief  Update a CRC32 (zlib compatible) with a given buffer
+*   \param  crc     Previous CRC32 value, 0 to start a new computation
+*   \param  data    Buffer
+*   \param  length  Buffer length
+*   \return Updated CRC32
+*   \note   Nibble-wise table to keep the flash footprint small. To be used when the DMA CRC engine can't be
+*/
+uint32_t utils_crc32_update(uint32_t crc, uint8_t* data, uint32_t length)
+{
+    static const uint32_t crc32_nibble_table[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+                                                    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+    
+    crc = ~crc;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc = crc32_nibble_table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = crc32_nibble_table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}